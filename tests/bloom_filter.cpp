@@ -0,0 +1,141 @@
+#include "common.hpp"
+
+struct bfdel {
+    using pointer = VscBloomFilter *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_bloom_filter_free(p);
+    }
+};
+using bfptr = std::unique_ptr<VscBloomFilter, bfdel>;
+
+TEST_CASE("bloom filter", "[bloom_filter]")
+{
+    const size_t n = 10000;
+    bfptr        bf(vsc_bloom_filter_alloc(n, 10));
+    REQUIRE(bf);
+
+    CHECK(vsc_bloom_filter_bits(bf.get()) >= n * 10);
+    CHECK(vsc_bloom_filter_bits(bf.get()) % 256 == 0);
+    CHECK(vsc_bloom_filter_alloc(n, 0) == nullptr);
+
+    for(size_t i = 0; i < n; ++i)
+        vsc_bloom_filter_insert(bf.get(), &i, sizeof(i));
+
+    /* No false negatives. */
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(vsc_bloom_filter_contains(bf.get(), &i, sizeof(i)));
+
+    size_t false_positives = 0;
+    for(size_t i = n; i < n * 11; ++i)
+        false_positives += vsc_bloom_filter_contains(bf.get(), &i, sizeof(i));
+
+    /* ~1% at 10 bits per key, leave some slack. */
+    CHECK(false_positives < n * 10 / 50);
+
+    vsc_bloom_filter_clear(bf.get());
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(!vsc_bloom_filter_contains(bf.get(), &i, sizeof(i)));
+}
+
+TEST_CASE("bloom filter serialise", "[bloom_filter]")
+{
+    bfptr bf(vsc_bloom_filter_alloc(1000, 16));
+    REQUIRE(bf);
+
+    for(size_t i = 0; i < 1000; ++i)
+        vsc_bloom_filter_insert_hash(bf.get(), i * 7919);
+
+    vsc::stdio_ptr f(tmpfile());
+    REQUIRE(f);
+    REQUIRE(vsc_bloom_filter_write(bf.get(), f.get()) == 0);
+    rewind(f.get());
+
+    void  *data = nullptr;
+    size_t size = 0;
+    REQUIRE(vsc_freadall(&data, &size, f.get()) == 0);
+    vsc::vsc_ptr<void> _data(data);
+
+    VscBloomFilter *_bf2 = nullptr;
+    REQUIRE(vsc_bloom_filter_load(&_bf2, data, size) == 0);
+    bfptr bf2(_bf2);
+
+    CHECK(vsc_bloom_filter_bits(bf2.get()) == vsc_bloom_filter_bits(bf.get()));
+    for(size_t i = 0; i < 100000; ++i)
+        REQUIRE(vsc_bloom_filter_contains_hash(bf2.get(), i) == vsc_bloom_filter_contains_hash(bf.get(), i));
+
+    /* Truncated or corrupt. */
+    VscBloomFilter *bad = nullptr;
+    CHECK(vsc_bloom_filter_load(&bad, data, size - 1) == VSC_ERROR(EINVAL));
+    CHECK(vsc_bloom_filter_load(&bad, data, 16) == VSC_ERROR(EINVAL));
+    static_cast<uint8_t *>(data)[0] = 'X';
+    CHECK(vsc_bloom_filter_load(&bad, data, size) == VSC_ERROR(EINVAL));
+}
+
+TEST_CASE("hashmap bloom filter", "[bloom_filter]")
+{
+    hmptr hm(vsc_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    bfptr bf(vsc_bloom_filter_alloc(2000, 10));
+    REQUIRE(hm);
+    REQUIRE(bf);
+
+    /* Keys already in the map are added when attaching. */
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), make_key(i), make_key(i)) == 0);
+
+    REQUIRE(vsc_hashmap_attach_bloom_filter(hm.get(), bf.get()) == 0);
+    CHECK(vsc_hashmap_attach_bloom_filter(hm.get(), bf.get()) == VSC_ERROR(EBUSY));
+
+    for(uintptr_t i = 1001; i <= 2000; ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), make_key(i), make_key(i)) == 0);
+
+    for(uintptr_t i = 1; i <= 2000; ++i) {
+        REQUIRE(vsc_bloom_filter_contains_hash(bf.get(), ptr_hashproc(make_key(i))));
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == make_key(i));
+    }
+
+    for(uintptr_t i = 2001; i <= 4000; ++i)
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == nullptr);
+
+    void       *values[3];
+    const void *keys[3] = {make_key(1), make_key(5000), make_key(2000)};
+    CHECK(vsc_hashmap_find_batch(hm.get(), keys, 3, values) == 2);
+    CHECK(values[0] == make_key(1));
+    CHECK(values[1] == nullptr);
+    CHECK(values[2] == make_key(2000));
+
+    /* Clones don't take the filter with them. */
+    hmptr clone(vsc_hashmap_clone(hm.get()));
+    REQUIRE(clone);
+    REQUIRE(vsc_hashmap_insert(clone.get(), make_key(9999), nullptr) == 0);
+    CHECK(vsc_hashmap_find(hm.get(), make_key(9999)) == nullptr);
+
+    REQUIRE(vsc_hashmap_clear(hm.get()) == 0);
+    CHECK(!vsc_bloom_filter_contains_hash(bf.get(), ptr_hashproc(make_key(1))));
+
+    vsc_hashmap_detach_filter(hm.get());
+    REQUIRE(vsc_hashmap_insert(hm.get(), make_key(1), make_key(1)) == 0);
+    CHECK(!vsc_bloom_filter_contains_hash(bf.get(), ptr_hashproc(make_key(1))));
+    CHECK(vsc_hashmap_find(hm.get(), make_key(1)) == make_key(1));
+}
+
+TEST_CASE("hashmap bloom filter identity hash", "[bloom_filter]")
+{
+    /* Heap-like pointers, hashed to themselves. Only the middle bits vary. */
+    const size_t n   = 100000;
+    auto         key = [](uintptr_t i) { return make_key(0x55d4a8c3e000 + i * 48); };
+    hmptr        hm(vsc_hashmap_alloc(vsc_hashmap_default_hash, ptr_compareproc));
+    bfptr        bf(vsc_bloom_filter_alloc(n, 10));
+    REQUIRE(hm);
+    REQUIRE(bf);
+    REQUIRE(vsc_hashmap_attach_bloom_filter(hm.get(), bf.get()) == 0);
+
+    for(uintptr_t i = 0; i < n; ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), key(i), nullptr) == 0);
+
+    size_t false_positives = 0;
+    for(uintptr_t i = n; i < n * 2; ++i)
+        false_positives += vsc_bloom_filter_contains_hash(bf.get(), vsc_hashmap_default_hash(key(i)));
+
+    CHECK(false_positives < n / 50);
+}
@@ -0,0 +1,297 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "common.hpp"
+
+struct ccdel {
+    using pointer = VscClockCache *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_clock_cache_free(p);
+    }
+};
+using ccptr = std::unique_ptr<VscClockCache, ccdel>;
+
+static void evictproc(const void *key, void *value, void *user)
+{
+    (void)key;
+    (void)value;
+    static_cast<std::atomic<size_t> *>(user)->fetch_add(1);
+}
+
+TEST_CASE("clock cache", "[clock_cache]")
+{
+    std::atomic<size_t> evicted{0};
+    VscClockCacheStats  stats;
+
+    CHECK(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 0, 1, 0, nullptr, nullptr) == nullptr);
+    CHECK(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 10, 3, 0, nullptr, nullptr) == nullptr);
+
+    ccptr cache(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 4, 1, 0, evictproc, &evicted));
+    REQUIRE(cache);
+    CHECK(vsc_clock_cache_capacity(cache.get()) == 4);
+
+    for(uintptr_t i = 1; i <= 4; ++i)
+        CHECK(vsc_clock_cache_put(cache.get(), make_key(i), make_key(i * 10), 0) == 0);
+
+    /* Reference everything but 3, so it's the one to go. */
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(1)) == make_key(10));
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(2)) == make_key(20));
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(4)) == make_key(40));
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(50), 0) == 0);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(3)) == nullptr);
+    CHECK(vsc_clock_cache_size(cache.get()) == 4);
+    CHECK(evicted == 1);
+
+    /* Replacing calls the eviction proc, but isn't an eviction. */
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(51), 0) == 0);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(5)) == make_key(51));
+    CHECK(evicted == 2);
+
+    /* Re-putting the exact same entry doesn't, the cache still owns it. */
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(51), 0) == 0);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(5)) == make_key(51));
+    CHECK(evicted == 2);
+
+    CHECK(vsc_clock_cache_remove(cache.get(), make_key(5)) == make_key(51));
+    CHECK(vsc_clock_cache_remove(cache.get(), make_key(5)) == nullptr);
+    CHECK(evicted == 2);
+
+    vsc_clock_cache_stats(cache.get(), &stats);
+    CHECK(stats.hits == 5);
+    CHECK(stats.misses == 1);
+    CHECK(stats.insertions == 5);
+    CHECK(stats.evictions == 1);
+    CHECK(stats.expirations == 0);
+    CHECK(stats.rejections == 0);
+
+    vsc_clock_cache_clear(cache.get());
+    CHECK(vsc_clock_cache_size(cache.get()) == 0);
+    CHECK(evicted == 5);
+}
+
+TEST_CASE("clock cache ttl", "[clock_cache]")
+{
+    VscClockCacheStats stats;
+
+    ccptr cache(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 4, 1, 0, nullptr, nullptr));
+    REQUIRE(cache);
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(1), make_key(1), 1) == 0);
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(2), make_key(2), 0) == 0);
+
+    vsc_counter_t start = vsc_counter_ns();
+    while(vsc_counter_ns() - start < 10)
+        ;
+
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(1)) == nullptr);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(2)) == make_key(2));
+    CHECK(vsc_clock_cache_size(cache.get()) == 1);
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(3), make_key(3), 0) == 0);
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(4), make_key(4), 0) == 0);
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(5), 1) == 0);
+
+    /* Everything else is referenced, so the hand stops at the expired entry. */
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(3)) == make_key(3));
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(4)) == make_key(4));
+
+    start = vsc_counter_ns();
+    while(vsc_counter_ns() - start < 10)
+        ;
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(6), make_key(6), 0) == 0);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(5)) == nullptr);
+    for(uintptr_t i : {2, 3, 4, 6})
+        CHECK(vsc_clock_cache_get(cache.get(), make_key(i)) == make_key(i));
+
+    vsc_clock_cache_stats(cache.get(), &stats);
+    CHECK(stats.expirations == 2);
+    CHECK(stats.evictions == 0);
+}
+
+TEST_CASE("clock cache doorkeeper", "[clock_cache]")
+{
+    VscClockCacheStats stats;
+
+    ccptr cache(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 4, 1, VSC_CLOCK_CACHE_DOORKEEPER, nullptr, nullptr));
+    REQUIRE(cache);
+
+    /* Not full, so everything's admitted. */
+    for(uintptr_t i = 1; i <= 4; ++i)
+        CHECK(vsc_clock_cache_put(cache.get(), make_key(i), make_key(i), 0) == 0);
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(5), 0) == 1);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(5)) == nullptr);
+    CHECK(vsc_clock_cache_size(cache.get()) == 4);
+
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(5), 0) == 0);
+    CHECK(vsc_clock_cache_get(cache.get(), make_key(5)) == make_key(5));
+
+    /* Replacing never needs admission. */
+    CHECK(vsc_clock_cache_put(cache.get(), make_key(5), make_key(6), 0) == 0);
+
+    vsc_clock_cache_stats(cache.get(), &stats);
+    CHECK(stats.rejections == 1);
+    CHECK(stats.evictions == 1);
+}
+
+TEST_CASE("clock cache threaded", "[clock_cache]")
+{
+    const size_t        num_threads = 8;
+    const uintptr_t     per_thread  = 10000;
+    std::atomic<size_t> evicted{0};
+    VscClockCacheStats  stats;
+
+    ccptr cache(vsc_clock_cache_alloc(ptr_hashproc, ptr_compareproc, 4096, 0, 0, evictproc, &evicted));
+    REQUIRE(cache);
+
+    /* Overlapping key ranges, so there's plenty of hits, misses and evictions. */
+    std::vector<std::thread> threads;
+    std::vector<size_t>      failures(num_threads, 0);
+    for(size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&cache, &failures, t, per_thread]() {
+            VscClockCache *c = cache.get();
+
+            for(uintptr_t i = 0; i < per_thread; ++i) {
+                uintptr_t k = 1 + (i * 7 + t * 1000) % 8192;
+                void     *v = vsc_clock_cache_get(c, make_key(k));
+
+                if(v == nullptr) {
+                    if(vsc_clock_cache_put(c, make_key(k), make_key(k), 0) != 0)
+                        ++failures[t];
+                } else if(v != make_key(k)) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+
+    for(std::thread& t : threads)
+        t.join();
+
+    for(size_t t = 0; t < num_threads; ++t)
+        CHECK(failures[t] == 0);
+
+    vsc_clock_cache_stats(cache.get(), &stats);
+    CHECK(stats.hits + stats.misses == num_threads * per_thread);
+    /*
+     * Threads racing on the same miss will replace each other's entries,
+     * but with the same key and value, so nothing's handed back.
+     */
+    CHECK(stats.insertions <= stats.misses);
+    CHECK(stats.insertions - stats.evictions == vsc_clock_cache_size(cache.get()));
+    CHECK(vsc_clock_cache_size(cache.get()) <= vsc_clock_cache_capacity(cache.get()));
+
+    /* Evicted entries may not have been handed back yet. Clearing waits for them too. */
+    size_t size = vsc_clock_cache_size(cache.get());
+    vsc_clock_cache_clear(cache.get());
+    CHECK(evicted == stats.evictions + size);
+}
+
+using evicted_pairs = std::vector<std::pair<const void *, void *>>;
+
+static void evictpairproc(const void *key, void *value, void *user)
+{
+    static_cast<evicted_pairs *>(user)->emplace_back(key, value);
+}
+
+static vsc_hash_t string_hashproc(const void *key)
+{
+    return vsc_hash_string(static_cast<const char *>(key));
+}
+
+static int string_compareproc(const void *a, const void *b)
+{
+    return strcmp(static_cast<const char *>(a), static_cast<const char *>(b)) == 0;
+}
+
+static void string_evictproc(const void *key, void *value, void *user)
+{
+    /* The key and value are the same allocation. */
+    (void)key;
+    free(value);
+    static_cast<std::atomic<size_t> *>(user)->fetch_add(1);
+}
+
+TEST_CASE("clock cache threaded owned keys", "[clock_cache]")
+{
+    /*
+     * Lookups compare against keys without the lock, while other threads
+     * evict and free them. The sanitisers will catch it if that's unsafe.
+     */
+    const size_t        num_threads = 8;
+    const size_t        per_thread  = 20000;
+    std::atomic<size_t> evicted{0};
+    std::atomic<size_t> inserted{0};
+
+    ccptr cache(vsc_clock_cache_alloc(string_hashproc, string_compareproc, 32, 1, 0, string_evictproc, &evicted));
+    REQUIRE(cache);
+
+    std::vector<std::thread> threads;
+    std::vector<size_t>      failures(num_threads, 0);
+    for(size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&cache, &failures, &inserted, t, per_thread]() {
+            VscClockCache *c = cache.get();
+            char           buf[32];
+
+            for(size_t i = 0; i < per_thread; ++i) {
+                snprintf(buf, sizeof(buf), "key%zu", (i * 13 + t * 101) % 64);
+
+                /* Don't touch the value, it may be evicted as soon as we have it. */
+                if(vsc_clock_cache_get(c, buf) != nullptr)
+                    continue;
+
+                char *k = strdup(buf);
+                if(vsc_clock_cache_put(c, k, k, 0) != 0) {
+                    ++failures[t];
+                    free(k);
+                    continue;
+                }
+
+                ++inserted;
+            }
+        });
+    }
+
+    for(std::thread& t : threads)
+        t.join();
+
+    for(size_t t = 0; t < num_threads; ++t)
+        CHECK(failures[t] == 0);
+
+    /* Every key the cache took is handed back exactly once. */
+    size_t size = vsc_clock_cache_size(cache.get());
+    cache.reset();
+    CHECK(evicted == inserted);
+    CHECK(size <= 32);
+}
+
+TEST_CASE("clock cache replace", "[clock_cache]")
+{
+    static char   k1[] = "key", k2[] = "key";
+    evicted_pairs evicted;
+    ccptr         cache(vsc_clock_cache_alloc(string_hashproc, string_compareproc, 4, 1, 0, evictpairproc, &evicted));
+    REQUIRE(cache);
+
+    REQUIRE(vsc_clock_cache_put(cache.get(), k1, make_key(10), 0) == 0);
+
+    /* Only the value changed, so only it is handed back. */
+    REQUIRE(vsc_clock_cache_put(cache.get(), k1, make_key(11), 0) == 0);
+    CHECK(evicted == evicted_pairs{{nullptr, make_key(10)}});
+
+    /* Only the key pointer changed, so only it is handed back. */
+    evicted.clear();
+    REQUIRE(vsc_clock_cache_put(cache.get(), k2, make_key(11), 0) == 0);
+    CHECK(evicted == evicted_pairs{{k1, nullptr}});
+
+    /* Both. */
+    evicted.clear();
+    REQUIRE(vsc_clock_cache_put(cache.get(), k1, make_key(12), 0) == 0);
+    CHECK(evicted == evicted_pairs{{k2, make_key(11)}});
+
+    evicted.clear();
+    vsc_clock_cache_clear(cache.get());
+    CHECK(evicted == evicted_pairs{{k1, make_key(12)}});
+}
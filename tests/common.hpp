@@ -102,4 +102,32 @@ private:
     std::stack<void *, std::vector<void *>> allocations;
 };
 
+struct hmdel {
+    using pointer = VscHashMap *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_hashmap_free(p);
+    }
+};
+using hmptr = std::unique_ptr<VscHashMap, hmdel>;
+
+/*
+ * Helpers for containers keyed on plain integers cast to pointers.
+ */
+inline vsc_hash_t ptr_hashproc(const void *key)
+{
+    uintptr_t k = reinterpret_cast<uintptr_t>(key);
+    return vsc_hash(&k, sizeof(k));
+}
+
+inline int ptr_compareproc(const void *a, const void *b)
+{
+    return a == b;
+}
+
+inline void *make_key(uintptr_t k)
+{
+    return reinterpret_cast<void *>(k);
+}
+
 #endif /* COMMON_HPP */
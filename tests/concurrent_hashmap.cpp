@@ -0,0 +1,148 @@
+#include <thread>
+#include <vector>
+#include "common.hpp"
+
+struct chmdel {
+    using pointer = VscConcurrentHashMap *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_concurrent_hashmap_free(p);
+    }
+};
+using chmptr = std::unique_ptr<VscConcurrentHashMap, chmdel>;
+
+TEST_CASE("concurrent hashmap", "[concurrent_hashmap]")
+{
+    CHECK(vsc_concurrent_hashmap_alloc(ptr_hashproc, ptr_compareproc, 3) == nullptr);
+
+    chmptr chm(vsc_concurrent_hashmap_alloc(ptr_hashproc, ptr_compareproc, 0));
+    REQUIRE(chm);
+    CHECK(vsc_concurrent_hashmap_shard_count(chm.get()) == VSC_CONCURRENT_HASHMAP_DEFAULT_SHARDS);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_concurrent_hashmap_insert(chm.get(), make_key(i), make_key(i * 2)) == 0);
+
+    CHECK(vsc_concurrent_hashmap_size(chm.get()) == 1000);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        CHECK(vsc_concurrent_hashmap_find(chm.get(), make_key(i)) == make_key(i * 2));
+
+    CHECK(vsc_concurrent_hashmap_find(chm.get(), make_key(1001)) == nullptr);
+    CHECK(vsc_concurrent_hashmap_update(chm.get(), make_key(1001), nullptr) == 1);
+    CHECK(vsc_concurrent_hashmap_update(chm.get(), make_key(1), make_key(3)) == 0);
+    CHECK(vsc_concurrent_hashmap_find(chm.get(), make_key(1)) == make_key(3));
+
+    size_t count = 0;
+    int    r     = vsc_concurrent_hashmap_enumerate(
+        chm.get(),
+        [](const void *, void *, vsc_hash_t, void *user) {
+            ++*reinterpret_cast<size_t *>(user);
+            return 0;
+        },
+        &count);
+    CHECK(r == 0);
+    CHECK(count == 1000);
+
+    void *v = vsc_concurrent_hashmap_remove(chm.get(), make_key(1));
+    CHECK(v == make_key(3));
+    CHECK(vsc_concurrent_hashmap_size(chm.get()) == 999);
+
+    vsc_concurrent_hashmap_clear(chm.get());
+    CHECK(vsc_concurrent_hashmap_size(chm.get()) == 0);
+}
+
+TEST_CASE("concurrent hashmap single shard", "[concurrent_hashmap]")
+{
+    chmptr chm(vsc_concurrent_hashmap_alloc(ptr_hashproc, ptr_compareproc, 1));
+    REQUIRE(chm);
+
+    for(uintptr_t i = 1; i <= 100; ++i)
+        REQUIRE(vsc_concurrent_hashmap_insert(chm.get(), make_key(i), make_key(i)) == 0);
+
+    for(uintptr_t i = 1; i <= 100; ++i)
+        CHECK(vsc_concurrent_hashmap_find(chm.get(), make_key(i)) == make_key(i));
+}
+
+TEST_CASE("concurrent hashmap identity hash", "[concurrent_hashmap]")
+{
+    /*
+     * Small integers under the identity hash have no high bits set.
+     * Unmixed, they'd all land in shard 0, which the inner map then
+     * enumerates in ascending order. Spread across shards, each shard
+     * restarts the sequence.
+     */
+    chmptr chm(vsc_concurrent_hashmap_alloc(vsc_hashmap_default_hash, vsc_hashmap_default_compare, 16));
+    REQUIRE(chm);
+
+    for(uintptr_t i = 1; i <= 1024; ++i)
+        REQUIRE(vsc_concurrent_hashmap_insert(chm.get(), make_key(i), make_key(i)) == 0);
+
+    std::vector<uintptr_t> keys;
+    REQUIRE(vsc_concurrent_hashmap_enumerate(
+                chm.get(),
+                [](const void *key, void *, vsc_hash_t, void *user) {
+                    static_cast<std::vector<uintptr_t> *>(user)->push_back(reinterpret_cast<uintptr_t>(key));
+                    return 0;
+                },
+                &keys) == 0);
+    REQUIRE(keys.size() == 1024);
+
+    size_t runs = 1;
+    for(size_t i = 1; i < keys.size(); ++i)
+        runs += keys[i] < keys[i - 1];
+
+    CHECK(runs >= 16);
+
+    for(uintptr_t i = 1; i <= 1024; ++i)
+        CHECK(vsc_concurrent_hashmap_find(chm.get(), make_key(i)) == make_key(i));
+}
+
+TEST_CASE("concurrent hashmap threads", "[concurrent_hashmap]")
+{
+    constexpr size_t    num_threads = 8;
+    constexpr uintptr_t per_thread  = 5000;
+
+    chmptr chm(vsc_concurrent_hashmap_alloc(ptr_hashproc, ptr_compareproc, 8));
+    REQUIRE(chm);
+
+    /* Each thread owns a disjoint key range; insert, verify, then remove half. */
+    std::vector<std::thread> threads;
+    std::vector<size_t>      failures(num_threads, 0);
+    for(size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&chm, &failures, t]() {
+            VscConcurrentHashMap *m    = chm.get();
+            uintptr_t             base = 1 + t * per_thread;
+
+            for(uintptr_t i = base; i < base + per_thread; ++i) {
+                if(vsc_concurrent_hashmap_insert(m, make_key(i), make_key(i)) != 0)
+                    ++failures[t];
+            }
+
+            for(uintptr_t i = base; i < base + per_thread; ++i) {
+                if(vsc_concurrent_hashmap_find(m, make_key(i)) != make_key(i))
+                    ++failures[t];
+            }
+
+            for(uintptr_t i = base; i < base + per_thread; i += 2) {
+                if(vsc_concurrent_hashmap_remove(m, make_key(i)) != make_key(i))
+                    ++failures[t];
+            }
+        });
+    }
+
+    for(std::thread& t : threads)
+        t.join();
+
+    for(size_t t = 0; t < num_threads; ++t)
+        CHECK(failures[t] == 0);
+
+    CHECK(vsc_concurrent_hashmap_size(chm.get()) == num_threads * per_thread / 2);
+
+    for(uintptr_t i = 1; i <= num_threads * per_thread; ++i) {
+        void *v = vsc_concurrent_hashmap_find(chm.get(), make_key(i));
+        if(i % 2 == 1)
+            REQUIRE(v == nullptr);
+        else
+            REQUIRE(v == make_key(i));
+    }
+}
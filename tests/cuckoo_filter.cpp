@@ -0,0 +1,193 @@
+#include "common.hpp"
+
+struct cfdel {
+    using pointer = VscCuckooFilter *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_cuckoo_filter_free(p);
+    }
+};
+using cfptr = std::unique_ptr<VscCuckooFilter, cfdel>;
+
+TEST_CASE("cuckoo filter", "[cuckoo_filter]")
+{
+    const size_t n = 10000;
+    cfptr        cf(vsc_cuckoo_filter_alloc(n));
+    REQUIRE(cf);
+
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(vsc_cuckoo_filter_insert(cf.get(), &i, sizeof(i)) == 0);
+
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == n);
+
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(vsc_cuckoo_filter_contains(cf.get(), &i, sizeof(i)));
+
+    size_t false_positives = 0;
+    for(size_t i = n; i < n * 11; ++i)
+        false_positives += vsc_cuckoo_filter_contains(cf.get(), &i, sizeof(i));
+
+    CHECK(false_positives < n * 10 / 1000);
+
+    /* Remove the even ones. */
+    for(size_t i = 0; i < n; i += 2)
+        REQUIRE(vsc_cuckoo_filter_remove(cf.get(), &i, sizeof(i)) == 0);
+
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == n / 2);
+
+    for(size_t i = 1; i < n; i += 2)
+        REQUIRE(vsc_cuckoo_filter_contains(cf.get(), &i, sizeof(i)));
+
+    size_t remaining = 0;
+    for(size_t i = 0; i < n; i += 2)
+        remaining += vsc_cuckoo_filter_contains(cf.get(), &i, sizeof(i));
+
+    CHECK(remaining < n / 2 / 100);
+
+    vsc_cuckoo_filter_clear(cf.get());
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == 0);
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(!vsc_cuckoo_filter_contains(cf.get(), &i, sizeof(i)));
+}
+
+TEST_CASE("cuckoo filter full", "[cuckoo_filter]")
+{
+    cfptr cf(vsc_cuckoo_filter_alloc(64));
+    REQUIRE(cf);
+
+    size_t n = 0;
+    while(vsc_cuckoo_filter_insert_hash(cf.get(), n * 0x9e3779b97f4a7c15ull) == 0)
+        ++n;
+
+    /* The last insertion that succeeded is held aside. */
+    CHECK(vsc_cuckoo_filter_full(cf.get()));
+    CHECK(n >= 64);
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == n);
+
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE(vsc_cuckoo_filter_contains_hash(cf.get(), i * 0x9e3779b97f4a7c15ull));
+
+    /* Removing anything makes room. */
+    REQUIRE(vsc_cuckoo_filter_remove_hash(cf.get(), 0) == 0);
+    CHECK(!vsc_cuckoo_filter_full(cf.get()));
+
+    for(size_t i = 1; i < n; ++i)
+        REQUIRE(vsc_cuckoo_filter_contains_hash(cf.get(), i * 0x9e3779b97f4a7c15ull));
+}
+
+TEST_CASE("cuckoo filter serialise", "[cuckoo_filter]")
+{
+    cfptr cf(vsc_cuckoo_filter_alloc(1000));
+    REQUIRE(cf);
+
+    for(size_t i = 0; i < 1000; ++i)
+        REQUIRE(vsc_cuckoo_filter_insert_hash(cf.get(), vsc_hash(&i, sizeof(i))) == 0);
+
+    vsc::stdio_ptr f(tmpfile());
+    REQUIRE(f);
+    REQUIRE(vsc_cuckoo_filter_write(cf.get(), f.get()) == 0);
+    rewind(f.get());
+
+    void  *data = nullptr;
+    size_t size = 0;
+    REQUIRE(vsc_freadall(&data, &size, f.get()) == 0);
+    vsc::vsc_ptr<void> _data(data);
+
+    VscCuckooFilter *_cf2 = nullptr;
+    REQUIRE(vsc_cuckoo_filter_load(&_cf2, data, size) == 0);
+    cfptr cf2(_cf2);
+
+    CHECK(vsc_cuckoo_filter_size(cf2.get()) == 1000);
+    for(size_t i = 0; i < 100000; ++i) {
+        vsc_hash_t h = vsc_hash(&i, sizeof(i));
+        REQUIRE(vsc_cuckoo_filter_contains_hash(cf2.get(), h) == vsc_cuckoo_filter_contains_hash(cf.get(), h));
+    }
+
+    VscCuckooFilter *bad = nullptr;
+    CHECK(vsc_cuckoo_filter_load(&bad, data, size - 1) == VSC_ERROR(EINVAL));
+    CHECK(vsc_cuckoo_filter_load(&bad, data, 16) == VSC_ERROR(EINVAL));
+}
+
+TEST_CASE("hashmap cuckoo filter", "[cuckoo_filter]")
+{
+    hmptr hm(vsc_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(hm);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), make_key(i), make_key(i)) == 0);
+
+    /* Too small, nothing is left behind. */
+    cfptr small(vsc_cuckoo_filter_alloc(100));
+    REQUIRE(small);
+    CHECK(vsc_hashmap_attach_cuckoo_filter(hm.get(), small.get()) == VSC_ERROR(ENOSPC));
+    CHECK(vsc_cuckoo_filter_size(small.get()) == 0);
+    CHECK(!vsc_cuckoo_filter_full(small.get()));
+
+    cfptr cf(vsc_cuckoo_filter_alloc(2000));
+    REQUIRE(cf);
+    REQUIRE(vsc_hashmap_attach_cuckoo_filter(hm.get(), cf.get()) == 0);
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == 1000);
+
+    /* Replacing doesn't add it twice. */
+    REQUIRE(vsc_hashmap_insert(hm.get(), make_key(1), make_key(1)) == 0);
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == 1000);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == make_key(i));
+
+    for(uintptr_t i = 1001; i <= 3000; ++i)
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == nullptr);
+
+    /* Removed keys leave the filter too. */
+    for(uintptr_t i = 1; i <= 500; ++i)
+        REQUIRE(vsc_hashmap_remove(hm.get(), make_key(i)) == make_key(i));
+
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == 500);
+    for(uintptr_t i = 501; i <= 1000; ++i)
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == make_key(i));
+
+    /* Fill the filter, then the map refuses more. */
+    uintptr_t k = 10000;
+    int       r;
+    while((r = vsc_hashmap_insert(hm.get(), make_key(k), make_key(k))) == 0)
+        ++k;
+
+    CHECK(r == VSC_ERROR(ENOSPC));
+    CHECK(vsc_hashmap_find(hm.get(), make_key(k)) == nullptr);
+    CHECK(vsc_hashmap_size(hm.get()) == vsc_cuckoo_filter_size(cf.get()));
+
+    for(uintptr_t i = 10000; i < k; ++i)
+        REQUIRE(vsc_hashmap_find(hm.get(), make_key(i)) == make_key(i));
+
+    /* Replacing a value still works, the filter doesn't change. */
+    REQUIRE(vsc_cuckoo_filter_full(cf.get()));
+    REQUIRE(vsc_hashmap_insert(hm.get(), make_key(501), make_key(1)) == 0);
+    CHECK(vsc_hashmap_find(hm.get(), make_key(501)) == make_key(1));
+    CHECK(vsc_hashmap_size(hm.get()) == vsc_cuckoo_filter_size(cf.get()));
+
+    REQUIRE(vsc_hashmap_remove(hm.get(), make_key(10000)) == make_key(10000));
+    REQUIRE(vsc_hashmap_insert(hm.get(), make_key(k), make_key(k)) == 0);
+}
+
+TEST_CASE("hashmap cuckoo filter identity hash", "[cuckoo_filter]")
+{
+    /* Heap-like pointers, hashed to themselves. Only the middle bits vary. */
+    const size_t n   = 100000;
+    auto         key = [](uintptr_t i) { return make_key(0x55d4a8c3e000 + i * 48); };
+    hmptr        hm(vsc_hashmap_alloc(vsc_hashmap_default_hash, ptr_compareproc));
+    cfptr        cf(vsc_cuckoo_filter_alloc(n));
+    REQUIRE(hm);
+    REQUIRE(cf);
+    REQUIRE(vsc_hashmap_attach_cuckoo_filter(hm.get(), cf.get()) == 0);
+
+    for(uintptr_t i = 0; i < n; ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), key(i), nullptr) == 0);
+
+    CHECK(vsc_cuckoo_filter_size(cf.get()) == n);
+
+    size_t false_positives = 0;
+    for(uintptr_t i = n; i < n * 2; ++i)
+        false_positives += vsc_cuckoo_filter_contains_hash(cf.get(), vsc_hashmap_default_hash(key(i)));
+
+    CHECK(false_positives < n / 100);
+}
@@ -2,6 +2,8 @@
 #include <vscpplib.hpp>
 #include <memory>
 #include <array>
+#include <vector>
+#include <thread>
 #include "catch.hpp"
 
 const static char crcinput[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
@@ -56,6 +58,223 @@ TEST_CASE("crc32c", "[hash]")
     CHECK(vsc_crc32c(iscsi_read, sizeof(iscsi_read)) == 0xd9963a56);
 }
 
+/* Bit-at-a-time reference, for checking the accelerated kernels. */
+static uint32_t crc_reference(const void *data, size_t size, uint32_t poly)
+{
+    const uint8_t *p   = reinterpret_cast<const uint8_t *>(data);
+    uint32_t       crc = ~0U;
+
+    while(size--) {
+        crc ^= *p++;
+        for(int i = 0; i < 8; ++i)
+            crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+    }
+
+    return crc ^ ~0U;
+}
+
+TEST_CASE("crc32 kernels", "[hash]")
+{
+    std::array<uint8_t, 4096 + 16> data;
+    uint64_t                       state = 0x9e3779b97f4a7c15;
+
+    for(uint8_t& b : data) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        b = (uint8_t)state;
+    }
+
+    /* Every size up to a few fold blocks, at every alignment. */
+    for(size_t off = 0; off < 16; ++off) {
+        for(size_t size = 0; size <= 300; ++size) {
+            REQUIRE(vsc_crc32(data.data() + off, size) == crc_reference(data.data() + off, size, 0xEDB88320));
+            REQUIRE(vsc_crc32c(data.data() + off, size) == crc_reference(data.data() + off, size, 0x82F63B78));
+        }
+    }
+
+    for(size_t size : {1023, 1024, 1025, 4096}) {
+        CHECK(vsc_crc32(data.data() + 3, size) == crc_reference(data.data() + 3, size, 0xEDB88320));
+        CHECK(vsc_crc32c(data.data() + 3, size) == crc_reference(data.data() + 3, size, 0x82F63B78));
+    }
+}
+
+TEST_CASE("crc32 update/combine", "[hash]")
+{
+    std::array<uint8_t, 1000> data;
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 7 + (i >> 3));
+
+    CHECK(vsc_crc32_update(0, crcinput, sizeof(crcinput)) == 0xcbf43926);
+    CHECK(vsc_crc32c_update(0, crcinput, sizeof(crcinput)) == 0xe3069283);
+    CHECK(vsc_crc32_update(0xcbf43926, nullptr, 0) == 0xcbf43926);
+
+    for(size_t split : {0, 1, 4, 63, 64, 65, 500, 999, 1000}) {
+        uint32_t crc32  = vsc_crc32(data.data(), data.size());
+        uint32_t crc32c = vsc_crc32c(data.data(), data.size());
+
+        uint32_t a = vsc_crc32(data.data(), split);
+        uint32_t b = vsc_crc32(data.data() + split, data.size() - split);
+        CHECK(vsc_crc32_update(a, data.data() + split, data.size() - split) == crc32);
+        CHECK(vsc_crc32_combine(a, b, data.size() - split) == crc32);
+
+        a = vsc_crc32c(data.data(), split);
+        b = vsc_crc32c(data.data() + split, data.size() - split);
+        CHECK(vsc_crc32c_update(a, data.data() + split, data.size() - split) == crc32c);
+        CHECK(vsc_crc32c_combine(a, b, data.size() - split) == crc32c);
+    }
+}
+
+TEST_CASE("crc32 parallel", "[hash]")
+{
+    std::vector<uint8_t> data((VSC_CRC_PARALLEL_MIN_CHUNK_SIZE * 5) + 123);
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i ^ (i >> 11));
+
+    uint32_t crc32  = vsc_crc32(data.data(), data.size());
+    uint32_t crc32c = vsc_crc32c(data.data(), data.size());
+
+    VscParallelForProc threaded = [](void (*task)(size_t, void *), void *arg, size_t count, void *user) {
+        std::vector<std::thread> threads;
+
+        *reinterpret_cast<size_t *>(user) = count;
+
+        for(size_t i = 0; i < count; ++i)
+            threads.emplace_back(task, i, arg);
+
+        for(std::thread& t : threads)
+            t.join();
+    };
+
+    for(size_t n : {0, 1, 2, 3, 4, 6, 1000}) {
+        size_t count = 0;
+
+        CHECK(vsc_crc32_parallel(data.data(), data.size(), n, nullptr, nullptr) == crc32);
+        CHECK(vsc_crc32c_parallel(data.data(), data.size(), n, nullptr, nullptr) == crc32c);
+        CHECK(vsc_crc32_parallel(data.data(), data.size(), n, threaded, &count) == crc32);
+        CHECK(vsc_crc32c_parallel(data.data(), data.size(), n, threaded, &count) == crc32c);
+
+        /* Pieces are never smaller than the minimum. */
+        CHECK(count <= 6);
+    }
+
+    CHECK(vsc_crc32_parallel(nullptr, 0, 4, nullptr, nullptr) == 0);
+    CHECK(vsc_crc32_parallel(data.data(), 100, 4, nullptr, nullptr) == vsc_crc32(data.data(), 100));
+}
+
+struct crcdel {
+    void operator()(VscCrc *crc) noexcept
+    {
+        vsc_crc_free(crc);
+    }
+};
+using crcptr = std::unique_ptr<VscCrc, crcdel>;
+
+/* Bit-at-a-time reference, straight from the Rocksoft model. */
+static uint64_t crc_model_reference(const VscCrcModel *m, const uint8_t *p, size_t size)
+{
+    uint64_t mask = ~(uint64_t)0 >> (64 - m->width);
+    uint64_t reg  = m->init & mask;
+
+    auto reflect = [](uint64_t v, unsigned int width) {
+        uint64_t r = 0;
+        for(unsigned int i = 0; i < width; ++i)
+            r |= ((v >> i) & 1) << (width - 1 - i);
+        return r;
+    };
+
+    while(size--) {
+        uint8_t b = *p++;
+
+        if(m->refin)
+            b = (uint8_t)reflect(b, 8);
+
+        for(int i = 7; i >= 0; --i) {
+            uint64_t msb = (reg >> (m->width - 1)) & 1;
+
+            reg = (reg << 1) & mask;
+            if(msb ^ ((b >> i) & 1))
+                reg ^= m->poly & mask;
+        }
+    }
+
+    if(m->refout)
+        reg = reflect(reg, m->width);
+
+    return reg ^ (m->xorout & mask);
+}
+
+TEST_CASE("crc models", "[hash]")
+{
+    /* A few odd ones from the catalogue, to cover unusual widths and refin != refout. */
+    const static VscCrcModel crc5_usb   = {5, 0x05, 0x1f, 1, 1, 0x1f, 0x19, "CRC-5/USB"};
+    const static VscCrcModel crc12_umts = {12, 0x80f, 0x000, 0, 1, 0x000, 0xdaf, "CRC-12/UMTS"};
+    const static VscCrcModel crc40_gsm  = {40, 0x0004820009, 0, 0, 0, 0xffffffffff, 0xd4164fc646, "CRC-40/GSM"};
+
+    const VscCrcModel *models[] = {
+        &vsc_crc_model_crc32,
+        &vsc_crc_model_crc32c,
+        &vsc_crc_model_crc32_bzip2,
+        &vsc_crc_model_crc16_kermit,
+        &vsc_crc_model_crc16_ibm_3740,
+        &vsc_crc_model_crc64_xz,
+        &vsc_crc_model_crc64_ecma_182,
+        &crc5_usb,
+        &crc12_umts,
+        &crc40_gsm,
+    };
+
+    std::array<uint8_t, 1024 + 16> data;
+    uint64_t                       state = 0x2545f4914f6cdd1d;
+
+    for(uint8_t& b : data) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        b = (uint8_t)state;
+    }
+
+    for(const VscCrcModel *m : models) {
+        INFO(m->name);
+
+        crcptr crc(vsc_crc_alloc(m));
+        REQUIRE(crc);
+
+        CHECK(vsc_crc_calc(crc.get(), crcinput, sizeof(crcinput)) == m->check);
+
+        for(size_t off = 0; off < 16; off += 5) {
+            for(size_t size = 0; size <= 300; ++size)
+                REQUIRE(vsc_crc_calc(crc.get(), data.data() + off, size) == crc_model_reference(m, data.data() + off, size));
+        }
+
+        CHECK(vsc_crc_calc(crc.get(), data.data(), 1024) == crc_model_reference(m, data.data(), 1024));
+
+        uint64_t st = vsc_crc_begin(crc.get());
+        for(size_t off = 0; off < 1024; off += 100)
+            st = vsc_crc_update(crc.get(), st, data.data() + off, std::min<size_t>(100, 1024 - off));
+        CHECK(vsc_crc_end(crc.get(), st) == crc_model_reference(m, data.data(), 1024));
+    }
+
+    crcptr crc32(vsc_crc_alloc(&vsc_crc_model_crc32));
+    REQUIRE(crc32);
+    CHECK(vsc_crc_calc(crc32.get(), data.data(), data.size()) == vsc_crc32(data.data(), data.size()));
+
+    VscCrcModel bad = vsc_crc_model_crc32;
+    bad.width       = 0;
+    CHECK(vsc_crc_alloc(&bad) == nullptr);
+    bad.width = 65;
+    CHECK(vsc_crc_alloc(&bad) == nullptr);
+    CHECK(vsc_crc_alloc(nullptr) == nullptr);
+
+    /* Even polynomials aren't valid CRCs. */
+    bad.width = 16;
+    bad.poly  = 0x1020;
+    bad.refin = 1;
+    CHECK(vsc_crc_alloc(&bad) == nullptr);
+}
+
 TEST_CASE("hash", "[hash]")
 {
     CHECK(vsc_hash(nullptr, 100) == VSC_INVALID_HASH);
@@ -67,3 +286,200 @@ TEST_CASE("hash", "[hash]")
         CHECK(vsc_hash_string("a") == hash);
     }
 }
+
+TEST_CASE("hash seeded", "[hash]")
+{
+    CHECK(vsc_hash_seeded(nullptr, 100, 1) == VSC_INVALID_HASH);
+    CHECK(vsc_hash_string_seeded(nullptr, 1) == VSC_INVALID_HASH);
+
+    CHECK(vsc_hash_string_seeded("a", 0) == vsc_hash_string("a"));
+    CHECK(vsc_hash_string_seeded("a", 1) == vsc_hash_string_seeded("a", 1));
+    CHECK(vsc_hash_string_seeded("a", 1) != vsc_hash_string_seeded("a", 2));
+}
+
+TEST_CASE("hash state", "[hash]")
+{
+    std::array<uint8_t, 1024> data;
+    VscHashState              state;
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 31 + 7);
+
+    vsc_hash_state_init(&state);
+    CHECK(vsc_hash_state_digest(&state) == vsc_hash(nullptr, 0));
+    CHECK(vsc_hash_state_update(&state, nullptr, 1) == VSC_ERROR(EINVAL));
+    CHECK(vsc_hash_state_update(&state, nullptr, 0) == 0);
+
+    /* Cover both the short and long input paths, and odd splits. */
+    for(size_t size : {1, 16, 17, 128, 129, 240, 241, 1000, 1024}) {
+        for(size_t step : {1, 3, 64, 100, 1024}) {
+            vsc_hash_state_init(&state);
+            for(size_t off = 0; off < size; off += step)
+                REQUIRE(vsc_hash_state_update(&state, data.data() + off, std::min(step, size - off)) == 0);
+
+            CHECK(vsc_hash_state_digest(&state) == vsc_hash(data.data(), size));
+
+            vsc_hash_state_init_seeded(&state, 0xdeadbeefcafef00d);
+            for(size_t off = 0; off < size; off += step)
+                REQUIRE(vsc_hash_state_update(&state, data.data() + off, std::min(step, size - off)) == 0);
+
+            CHECK(vsc_hash_state_digest(&state) == vsc_hash_seeded(data.data(), size, 0xdeadbeefcafef00d));
+        }
+    }
+}
+
+TEST_CASE("hash state copy", "[hash]")
+{
+    std::array<uint8_t, 512> data;
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)i;
+
+    struct {
+        VscHashState a;
+        uint64_t     pad;
+        VscHashState b;
+        VscHashState c;
+    } states;
+
+    static_assert(alignof(VscHashState) == VSC_HASH_STATE_ALIGN);
+
+    vsc_hash_state_init_seeded(&states.a, 42);
+    REQUIRE(vsc_hash_state_update(&states.a, data.data(), 300) == 0);
+
+    vsc_hash_state_copy(&states.b, &states.a);
+    CHECK(vsc_hash_state_digest(&states.b) == vsc_hash_state_digest(&states.a));
+
+    /* Plain assignment works too. */
+    states.c = states.a;
+    CHECK(vsc_hash_state_digest(&states.c) == vsc_hash_state_digest(&states.a));
+
+    REQUIRE(vsc_hash_state_update(&states.a, data.data() + 300, 212) == 0);
+    REQUIRE(vsc_hash_state_update(&states.b, data.data() + 300, 100) == 0);
+    REQUIRE(vsc_hash_state_update(&states.c, data.data() + 300, 50) == 0);
+
+    CHECK(vsc_hash_state_digest(&states.a) == vsc_hash_seeded(data.data(), 512, 42));
+    CHECK(vsc_hash_state_digest(&states.b) == vsc_hash_seeded(data.data(), 400, 42));
+    CHECK(vsc_hash_state_digest(&states.c) == vsc_hash_seeded(data.data(), 350, 42));
+
+    /* The unseeded state points at the default secret, which survives copying. */
+    vsc_hash_state_init(&states.a);
+    REQUIRE(vsc_hash_state_update(&states.a, data.data(), 300) == 0);
+    states.c = states.a;
+    REQUIRE(vsc_hash_state_update(&states.c, data.data() + 300, 212) == 0);
+    CHECK(vsc_hash_state_digest(&states.c) == vsc_hash(data.data(), 512));
+}
+
+TEST_CASE("hash state freadall", "[hash]")
+{
+    std::array<uint8_t, 10000> data;
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i ^ (i >> 8));
+
+    vsc::stdio_ptr f(tmpfile());
+    REQUIRE(f);
+    REQUIRE(fwrite(data.data(), 1, data.size(), f.get()) == data.size());
+    rewind(f.get());
+
+    VscHashState state;
+    vsc_hash_state_init(&state);
+
+    void  *ptr  = nullptr;
+    size_t size = 0;
+    int    r    = vsc_freadalla_ex(
+        &ptr, &size, f.get(),
+        [](VscFreadallState *st, void *) {
+            /* Small blocks, so it takes more than one read. */
+            st->file_size = 0;
+            st->blk_size  = 512;
+            return 0;
+        },
+        [](const VscFreadallState *st, void *user) {
+            return vsc_hash_state_update(reinterpret_cast<VscHashState *>(user), st->chunk, st->chunk_size);
+        },
+        &state, vsclib_system_allocator);
+    vsc::vsc_ptr<void> _ptr(ptr);
+
+    REQUIRE(r == 0);
+    REQUIRE(size == data.size());
+    CHECK(vsc_hash_state_digest(&state) == vsc_hash(data.data(), data.size()));
+}
+
+TEST_CASE("hash128", "[hash]")
+{
+    char       buf[VSC_HASH128_STRING_SIZE];
+    VscHash128 h, h2;
+
+    h = vsc_hash128(nullptr, 100);
+    CHECK(h.low == ~(uint64_t)0);
+    CHECK(h.high == ~(uint64_t)0);
+
+    /* Matches `xxhsum -H2 /dev/null`. */
+    h = vsc_hash128(nullptr, 0);
+    CHECK(h.high == 0x99aa06d3014798d8);
+    CHECK(h.low == 0x6001c324468d497f);
+    CHECK(std::string_view(vsc_hash128_format(buf, &h)) == "99aa06d3014798d86001c324468d497f");
+
+    CHECK(vsc_hash128_parse(&h2, "99AA06D3014798D86001C324468D497F") == 0);
+    CHECK(vsc_hash128_compare(&h, &h2) == 0);
+
+    CHECK(vsc_hash128_parse(&h2, "99aa06d3014798d86001c324468d497") == VSC_ERROR(EINVAL));
+    CHECK(vsc_hash128_parse(&h2, "99aa06d3014798d86001c324468d497f0") == VSC_ERROR(EINVAL));
+    CHECK(vsc_hash128_parse(&h2, "99aa06d3014798d86001c324468d497g") == VSC_ERROR(EINVAL));
+    CHECK(vsc_hash128_parse(&h2, "") == VSC_ERROR(EINVAL));
+
+    h  = vsc_hash128_seeded(crcinput, sizeof(crcinput), 0);
+    h2 = vsc_hash128(crcinput, sizeof(crcinput));
+    CHECK(vsc_hash128_compare(&h, &h2) == 0);
+
+    h  = vsc_hash128_seeded(crcinput, sizeof(crcinput), 1);
+    h2 = vsc_hash128_seeded(crcinput, sizeof(crcinput), 2);
+    CHECK(vsc_hash128_compare(&h, &h2) != 0);
+    CHECK(vsc_hash128_compare(&h, &h2) == -vsc_hash128_compare(&h2, &h));
+
+    /* Ordering is by the high half first. */
+    h  = {2, 1};
+    h2 = {1, 2};
+    CHECK(vsc_hash128_compare(&h, &h2) < 0);
+    CHECK(vsc_hash128_compare(&h2, &h) > 0);
+    CHECK(std::string_view(vsc_hash128_format(buf, &h)) == "00000000000000010000000000000002");
+}
+
+TEST_CASE("hash128 state", "[hash]")
+{
+    std::array<uint8_t, 1024> data;
+    VscHash128State           state, state2;
+    VscHash128                h, h2;
+
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 13 + 5);
+
+    vsc_hash128_state_init(&state);
+    CHECK(vsc_hash128_state_update(&state, nullptr, 1) == VSC_ERROR(EINVAL));
+
+    for(size_t size : {0, 1, 16, 17, 128, 129, 240, 241, 1024}) {
+        for(size_t step : {1, 7, 256}) {
+            vsc_hash128_state_init_seeded(&state, 99);
+            for(size_t off = 0; off < size; off += step)
+                REQUIRE(vsc_hash128_state_update(&state, data.data() + off, std::min(step, size - off)) == 0);
+
+            h  = vsc_hash128_state_digest(&state);
+            h2 = vsc_hash128_seeded(data.data(), size, 99);
+            CHECK(vsc_hash128_compare(&h, &h2) == 0);
+        }
+    }
+
+    vsc_hash128_state_init(&state);
+    REQUIRE(vsc_hash128_state_update(&state, data.data(), 500) == 0);
+    vsc_hash128_state_copy(&state2, &state);
+    REQUIRE(vsc_hash128_state_update(&state2, data.data() + 500, 524) == 0);
+
+    h  = vsc_hash128_state_digest(&state2);
+    h2 = vsc_hash128(data.data(), data.size());
+    CHECK(vsc_hash128_compare(&h, &h2) == 0);
+
+    h  = vsc_hash128_state_digest(&state);
+    h2 = vsc_hash128(data.data(), 500);
+    CHECK(vsc_hash128_compare(&h, &h2) == 0);
+}
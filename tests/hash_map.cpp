@@ -0,0 +1,139 @@
+#include <stdexcept>
+#include <string>
+#include "common.hpp"
+
+TEST_CASE("hash_map strings", "[hash_map]")
+{
+    vsc::hash_map<std::string, int> m;
+
+    CHECK(m.empty());
+    CHECK(m.find("a") == nullptr);
+    CHECK(!m.erase("a"));
+
+    for(int i = 0; i < 1000; ++i)
+        REQUIRE(m.insert(std::to_string(i), i) == 0);
+
+    CHECK(m.size() == 1000);
+    CHECK(VSC_IS_POT(m.bucket_count()));
+
+    for(int i = 0; i < 1000; ++i) {
+        const int *v = m.find(std::to_string(i));
+        REQUIRE(v != nullptr);
+        CHECK(*v == i);
+    }
+
+    /* Heterogeneous lookups, no std::string is constructed. */
+    std::string_view sv = "123";
+    REQUIRE(m.find(sv) != nullptr);
+    CHECK(*m.find(sv) == 123);
+    CHECK(m.contains("456"));
+    CHECK(!m.contains("1000"));
+
+    /* Replace */
+    REQUIRE(m.insert("5", -5) == 0);
+    CHECK(m.size() == 1000);
+    CHECK(*m.find("5") == -5);
+
+    CHECK(m.erase(std::string_view("5")));
+    CHECK(!m.contains("5"));
+    CHECK(m.size() == 999);
+
+    size_t count = 0;
+    m.for_each([&count](const std::string&, int&) { ++count; });
+    CHECK(count == 999);
+
+    /* Early exit. */
+    count = 0;
+    CHECK(!m.for_each([&count](const std::string&, int&) { return ++count < 10; }));
+    CHECK(count == 10);
+
+    m.clear();
+    CHECK(m.empty());
+    CHECK(m.find("1") == nullptr);
+}
+
+/* Everything collides, to exercise probing and removal. */
+struct bad_hash {
+    vsc_hash_t operator()(int k) const noexcept
+    {
+        return static_cast<vsc_hash_t>(k % 4);
+    }
+};
+
+TEST_CASE("hash_map collisions", "[hash_map]")
+{
+    vsc::hash_map<int, std::unique_ptr<int>, bad_hash> m;
+
+    for(int i = 0; i < 100; ++i)
+        REQUIRE(m.insert(i, std::make_unique<int>(i + 100)) == 0);
+
+    for(int i = 0; i < 100; i += 2)
+        REQUIRE(m.erase(i));
+
+    for(int i = 0; i < 100; ++i) {
+        std::unique_ptr<int> *v = m.find(i);
+        if(i % 2 == 0) {
+            CHECK(v == nullptr);
+        } else {
+            REQUIRE(v != nullptr);
+            CHECK(**v == i + 100);
+        }
+    }
+
+    CHECK(m.size() == 50);
+
+    vsc::hash_map<int, std::unique_ptr<int>, bad_hash> m2(std::move(m));
+    CHECK(m.size() == 0);
+    CHECK(m2.size() == 50);
+    CHECK(**m2.find(1) == 101);
+}
+
+TEST_CASE("hash_map allocator", "[hash_map]")
+{
+    TestAllocator<16384> a;
+
+    vsc::hash_map<uint64_t, uint64_t> m(a);
+    REQUIRE(m.reserve(12) == 0);
+    CHECK(m.bucket_count() == vsc::hash_map<uint64_t, uint64_t>::min_buckets);
+
+    for(uint64_t i = 0; i < 12; ++i)
+        REQUIRE(m.insert(i, i * i) == 0);
+
+    /* Much too large for the allocator. */
+    CHECK(m.reserve(100000) < 0);
+    CHECK(m.size() == 12);
+    CHECK(*m.find(11) == 121);
+}
+
+TEST_CASE("hash_map throwing value", "[hash_map]")
+{
+    struct ptr_hash {
+        vsc_hash_t operator()(const std::shared_ptr<int>& p) const noexcept
+        {
+            return vsc::hash<const int *>()(p.get());
+        }
+    };
+
+    struct value {
+        value(int v) : v(v)
+        {
+            if(v < 0)
+                throw std::invalid_argument("negative");
+        }
+
+        int v;
+    };
+
+    vsc::hash_map<std::shared_ptr<int>, value, ptr_hash> m;
+    std::shared_ptr<int>                                 key = std::make_shared<int>(1);
+
+    CHECK_THROWS_AS(m.insert(key, -1), std::invalid_argument);
+    CHECK(m.size() == 0);
+    CHECK(m.find(key) == nullptr);
+    /* The copy of the key made before the value threw must have been destroyed. */
+    CHECK(key.use_count() == 1);
+
+    REQUIRE(m.insert(key, 1) == 0);
+    CHECK(key.use_count() == 2);
+    CHECK(m.find(key)->v == 1);
+}
@@ -1,4 +1,5 @@
 #include <array>
+#include <thread>
 #include "common.hpp"
 
 #define CHECK_CSTRING(a, b)                    \
@@ -9,15 +10,6 @@
             CHECK(strcmp(a, b) == 0);          \
     } while(0)
 
-struct hmdel {
-    using pointer = VscHashMap *;
-    void operator()(pointer p) noexcept
-    {
-        vsc_hashmap_free(p);
-    }
-};
-using hmptr = std::unique_ptr<VscHashMap, hmdel>;
-
 #if 0
 static void dumpx(const VscHashMap *hm)
 {
@@ -115,10 +107,10 @@ TEST_CASE("hashmap", "[hashmap]")
     // dumpx(&hm);
     std::array<VscHashMapBucket, 8> expected = {
         {
-         {VSC_INVALID_HASH, nullptr, nullptr},
          {105567279U, (const void *)"e", (void *)"E"},
          {VSC_INVALID_HASH, nullptr, nullptr},
          {VSC_INVALID_HASH, nullptr, nullptr},
+         {VSC_INVALID_HASH, nullptr, nullptr},
          {3531649220U, (const void *)"b", (void *)"B"},
          {VSC_INVALID_HASH, nullptr, nullptr},
          {VSC_INVALID_HASH, nullptr, nullptr},
@@ -129,10 +121,20 @@ TEST_CASE("hashmap", "[hashmap]")
     REQUIRE(vsc_hashmap_capacity(hm.get()) == expected.size());
     const VscHashMapBucket *first = vsc_hashmap_first(hm.get());
     for(size_t i = 0; i < expected.size(); ++i) {
+        VscHashMapBucket bkt;
+
         CHECK(expected[i].hash == first[i].hash);
         CHECK_CSTRING((const char *)expected[i].key, (const char *)first[i].key);
         CHECK_CSTRING((const char *)expected[i].value, (const char *)first[i].value);
+
+        REQUIRE(vsc_hashmap_get_bucket(hm.get(), i, &bkt) == 0);
+        CHECK(bkt.hash == first[i].hash);
+        CHECK(bkt.key == first[i].key);
+        CHECK(bkt.value == first[i].value);
     }
+
+    /* "e" wrapped around past "c", make sure it's still reachable. */
+    CHECK_CSTRING("E", (const char *)vsc_hashmap_find(hm.get(), "e"));
 }
 
 TEST_CASE("hashmap 2", "[hashmap]")
@@ -198,3 +200,537 @@ TEST_CASE("null keys", "[hashmap]")
     REQUIRE(val != nullptr);
     REQUIRE(strcmp("NULL", val) == 0);
 }
+
+TEST_CASE("hashmap shrink", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+
+    char nkeys[1536][6];
+    for(size_t i = 0; i < 1536; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        REQUIRE(vsc_hashmap_insert(hm.get(), nkeys[i], nkeys[i]) == 0);
+    }
+
+    size_t peak = vsc_hashmap_capacity(hm.get());
+    REQUIRE(peak >= 1536);
+
+    /* Drain all but a few, the map should shrink on its own. */
+    for(size_t i = 10; i < 1536; ++i) {
+        const char *v = (const char *)vsc_hashmap_remove(hm.get(), nkeys[i]);
+        CHECK_CSTRING(nkeys[i], v);
+    }
+
+    CHECK(vsc_hashmap_size(hm.get()) == 10);
+    CHECK(vsc_hashmap_capacity(hm.get()) < peak);
+    CHECK(vsc_hashmap_capacity(hm.get()) >= 10);
+
+    for(size_t i = 0; i < 10; ++i)
+        CHECK_CSTRING(nkeys[i], (const char *)vsc_hashmap_find(hm.get(), nkeys[i]));
+
+    for(size_t i = 10; i < 1536; ++i)
+        CHECK(vsc_hashmap_find(hm.get(), nkeys[i]) == nullptr);
+
+    /* Explicitly shrink to the minimum load factor, 1/2. */
+    REQUIRE(vsc_hashmap_shrink_to_fit(hm.get()) == 0);
+    CHECK(vsc_hashmap_capacity(hm.get()) == 20);
+
+    for(size_t i = 0; i < 10; ++i)
+        CHECK_CSTRING(nkeys[i], (const char *)vsc_hashmap_find(hm.get(), nkeys[i]));
+
+    for(size_t i = 0; i < 10; ++i) {
+        const char *v = (const char *)vsc_hashmap_remove(hm.get(), nkeys[i]);
+        CHECK_CSTRING(nkeys[i], v);
+    }
+
+    REQUIRE(vsc_hashmap_shrink_to_fit(hm.get()) == 0);
+    CHECK(vsc_hashmap_size(hm.get()) == 0);
+    CHECK(vsc_hashmap_capacity(hm.get()) == 0);
+}
+
+TEST_CASE("hashmap no shrink when disallowed", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+
+    REQUIRE(vsc_hashmap_resize(hm.get(), 256) == 0);
+    vsc_hashmap_set_resize_policy(hm.get(), VSC_HASHMAP_RESIZE_NONE);
+
+    CHECK(vsc_hashmap_insert(hm.get(), "a", nullptr) == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "b", nullptr) == 0);
+    vsc_hashmap_remove(hm.get(), "a");
+
+    CHECK(vsc_hashmap_capacity(hm.get()) == 256);
+}
+
+TEST_CASE("hashmap find batch", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+
+    const void *keys[100];
+    vsc_hash_t  hashes[100];
+    void       *values[100];
+    char        nkeys[100][6];
+
+    /* Nothing allocated yet, everything should miss. */
+    for(size_t i = 0; i < 100; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        keys[i]   = nkeys[i];
+        values[i] = (void *)1;
+    }
+
+    CHECK(vsc_hashmap_find_batch(hm.get(), keys, 100, values) == 0);
+    for(void *v : values)
+        CHECK(v == nullptr);
+
+    /* Insert only the even keys. */
+    for(size_t i = 0; i < 100; i += 2)
+        REQUIRE(vsc_hashmap_insert(hm.get(), nkeys[i], nkeys[i]) == 0);
+
+    CHECK(vsc_hashmap_find_batch(hm.get(), keys, 100, values) == 50);
+    for(size_t i = 0; i < 100; ++i)
+        CHECK(values[i] == vsc_hashmap_find(hm.get(), keys[i]));
+
+    for(size_t i = 0; i < 100; ++i) {
+        hashes[i] = vsc_hashmap_hash(hm.get(), keys[i]);
+        values[i] = (void *)1;
+    }
+
+    CHECK(vsc_hashmap_find_batch_with_hash(hm.get(), keys, hashes, 100, values) == 50);
+    for(size_t i = 0; i < 100; ++i)
+        CHECK(values[i] == (i % 2 == 0 ? nkeys[i] : nullptr));
+}
+
+TEST_CASE("hashmap with hash", "[hashmap]")
+{
+    /* Use a terrible hash function so everything collides. */
+    hmptr hm(vsc_hashmap_alloc([](const void *) -> vsc_hash_t { return 42; }, compareproc));
+
+    vsc_hash_t hash = vsc_hashmap_hash(hm.get(), "a");
+
+    REQUIRE(vsc_hashmap_insert_with_hash(hm.get(), "a", hash, (void *)"A") == 0);
+    REQUIRE(vsc_hashmap_insert_with_hash(hm.get(), "b", hash, (void *)"B") == 0);
+    REQUIRE(vsc_hashmap_size(hm.get()) == 2);
+
+    /* Keys must still be compared. */
+    CHECK_CSTRING("A", (const char *)vsc_hashmap_find_with_hash(hm.get(), "a", hash));
+    CHECK_CSTRING("B", (const char *)vsc_hashmap_find_with_hash(hm.get(), "b", hash));
+    CHECK(vsc_hashmap_find_with_hash(hm.get(), "c", hash) == nullptr);
+    CHECK(vsc_hashmap_find_with_hash(hm.get(), "a", VSC_INVALID_HASH) == nullptr);
+
+    CHECK(vsc_hashmap_update_with_hash(hm.get(), "b", hash, (void *)"B++") == 0);
+    CHECK(vsc_hashmap_update_with_hash(hm.get(), "c", hash, (void *)"C") == 1);
+    CHECK_CSTRING("B++", (const char *)vsc_hashmap_find(hm.get(), "b"));
+
+    const char *v = (const char *)vsc_hashmap_remove_with_hash(hm.get(), "a", hash);
+    CHECK_CSTRING("A", v);
+    CHECK(vsc_hashmap_remove_with_hash(hm.get(), "a", hash) == nullptr);
+    CHECK(vsc_hashmap_size(hm.get()) == 1);
+    CHECK_CSTRING("B++", (const char *)vsc_hashmap_find_with_hash(hm.get(), "b", hash));
+}
+
+TEST_CASE("hashmap compact layout", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+
+    REQUIRE(vsc_hashmap_layout(hm.get()) == VSC_HASHMAP_LAYOUT_BUCKETS);
+    REQUIRE(vsc_hashmap_set_layout(hm.get(), VSC_HASHMAP_LAYOUT_COMPACT) == 0);
+    REQUIRE(vsc_hashmap_layout(hm.get()) == VSC_HASHMAP_LAYOUT_COMPACT);
+
+    char nkeys[1536][6];
+    for(size_t i = 0; i < 1536; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        REQUIRE(vsc_hashmap_insert(hm.get(), nkeys[i], nkeys[i]) == 0);
+    }
+
+    /* Can't change layouts once allocated. */
+    CHECK(vsc_hashmap_set_layout(hm.get(), VSC_HASHMAP_LAYOUT_BUCKETS) == VSC_ERROR(EBUSY));
+    CHECK(vsc_hashmap_first(hm.get()) == nullptr);
+    CHECK(vsc_hashmap_size(hm.get()) == 1536);
+
+    /* Bucket-wise iteration still works, it just copies them out. */
+    size_t           nfound = 0;
+    VscHashMapBucket bkt;
+    for(size_t i = 0; i < vsc_hashmap_capacity(hm.get()); ++i) {
+        REQUIRE(vsc_hashmap_get_bucket(hm.get(), i, &bkt) == 0);
+        if(bkt.hash == VSC_INVALID_HASH) {
+            CHECK(bkt.key == nullptr);
+            continue;
+        }
+
+        CHECK(bkt.hash == hashproc(bkt.key));
+        CHECK(bkt.value == bkt.key);
+        ++nfound;
+    }
+    CHECK(nfound == 1536);
+    CHECK(vsc_hashmap_get_bucket(hm.get(), vsc_hashmap_capacity(hm.get()), &bkt) == VSC_ERROR(EINVAL));
+
+    for(const auto& c : nkeys) {
+        CHECK_CSTRING(c, (const char *)vsc_hashmap_find(hm.get(), c));
+        CHECK_CSTRING(c, (const char *)vsc_hashmap_find_by_hash(hm.get(), vsc_hashmap_hash(hm.get(), c)));
+    }
+
+    /* Enumeration must report the full hash, not the tag. */
+    size_t count = 0;
+    REQUIRE(vsc_hashmap_enumerate(
+                hm.get(),
+                [](const void *key, void *value, vsc_hash_t hash, void *user) {
+                    CHECK(key == value);
+                    CHECK(hash == hashproc(key));
+                    ++*(size_t *)user;
+                    return 0;
+                },
+                &count) == 0);
+    CHECK(count == 1536);
+
+    REQUIRE(vsc_hashmap_update(hm.get(), nkeys[0], nullptr) == 0);
+    CHECK(vsc_hashmap_find(hm.get(), nkeys[0]) == nullptr);
+
+    for(size_t i = 10; i < 1536; ++i) {
+        const char *v = (const char *)vsc_hashmap_remove(hm.get(), nkeys[i]);
+        CHECK_CSTRING(nkeys[i], v);
+    }
+
+    REQUIRE(vsc_hashmap_shrink_to_fit(hm.get()) == 0);
+    CHECK(vsc_hashmap_capacity(hm.get()) == 20);
+    for(size_t i = 1; i < 10; ++i)
+        CHECK_CSTRING(nkeys[i], (const char *)vsc_hashmap_find(hm.get(), nkeys[i]));
+
+    /* Back to buckets. */
+    vsc_hashmap_reset(hm.get());
+    vsc_hashmap_clear(hm.get());
+    CHECK(vsc_hashmap_set_layout(hm.get(), VSC_HASHMAP_LAYOUT_BUCKETS) == 0);
+}
+
+TEST_CASE("hashmap compact layout collisions", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc([](const void *) -> vsc_hash_t { return 0; }, compareproc));
+
+    REQUIRE(vsc_hashmap_set_layout(hm.get(), VSC_HASHMAP_LAYOUT_COMPACT) == 0);
+
+    CHECK(vsc_hashmap_insert(hm.get(), "a", (void *)"A") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "b", (void *)"B") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "c", (void *)"C") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "b", (void *)"B++") == 0);
+    CHECK(vsc_hashmap_size(hm.get()) == 3);
+
+    const char *v = (const char *)vsc_hashmap_remove(hm.get(), "a");
+    CHECK_CSTRING("A", v);
+    CHECK_CSTRING("B++", (const char *)vsc_hashmap_find(hm.get(), "b"));
+    CHECK_CSTRING("C", (const char *)vsc_hashmap_find(hm.get(), "c"));
+}
+
+TEST_CASE("hashmap build", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+
+    static char nkeys[10000][6];
+    const void *keys[10000];
+    void       *values[10000];
+    vsc_hash_t  hashes[10000];
+
+    for(size_t i = 0; i < 10000; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        keys[i]   = nkeys[i];
+        values[i] = nkeys[i];
+    }
+
+    REQUIRE(vsc_hashmap_build(hm.get(), keys, values, 10000) == 0);
+    CHECK(vsc_hashmap_size(hm.get()) == 10000);
+
+    /* Sized once, to the minimum load factor. */
+    CHECK(vsc_hashmap_capacity(hm.get()) == 20000);
+
+    for(const auto& c : nkeys)
+        CHECK_CSTRING(c, (const char *)vsc_hashmap_find(hm.get(), c));
+
+    /* Duplicates replace. */
+    values[0] = nullptr;
+    REQUIRE(vsc_hashmap_build(hm.get(), keys, values, 1) == 0);
+    CHECK(vsc_hashmap_size(hm.get()) == 10000);
+    CHECK(vsc_hashmap_find(hm.get(), nkeys[0]) == nullptr);
+
+    hmptr hm2(vsc_hashmap_alloc(hashproc, compareproc));
+    REQUIRE(vsc_hashmap_set_layout(hm2.get(), VSC_HASHMAP_LAYOUT_COMPACT) == 0);
+
+    for(size_t i = 0; i < 10000; ++i)
+        hashes[i] = vsc_hashmap_hash(hm2.get(), keys[i]);
+
+    REQUIRE(vsc_hashmap_build_with_hash(hm2.get(), keys, hashes, values, 10000) == 0);
+    CHECK(vsc_hashmap_size(hm2.get()) == 10000);
+    for(size_t i = 1; i < 10000; ++i)
+        CHECK_CSTRING(nkeys[i], (const char *)vsc_hashmap_find(hm2.get(), nkeys[i]));
+}
+
+TEST_CASE("hashmap build parallel", "[hashmap]")
+{
+    static char               nkeys[50000][6];
+    std::vector<const void *> keys(50000);
+    std::vector<void *>       values(50000);
+
+    for(size_t i = 0; i < 50000; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        keys[i]   = nkeys[i];
+        values[i] = nkeys[i];
+    }
+
+    VscParallelForProc threaded = [](void (*task)(size_t, void *), void *arg, size_t count, void *user) {
+        std::vector<std::thread> threads;
+
+        *reinterpret_cast<size_t *>(user) = count;
+
+        for(size_t i = 0; i < count; ++i)
+            threads.emplace_back(task, i, arg);
+
+        for(std::thread& t : threads)
+            t.join();
+    };
+
+    for(VscHashMapLayout layout : {VSC_HASHMAP_LAYOUT_BUCKETS, VSC_HASHMAP_LAYOUT_COMPACT}) {
+        hmptr  hm(vsc_hashmap_alloc(hashproc, compareproc));
+        size_t count = 0;
+
+        REQUIRE(vsc_hashmap_set_layout(hm.get(), layout) == 0);
+        REQUIRE(vsc_hashmap_build_parallel(hm.get(), keys.data(), values.data(), keys.size(), threaded, &count) == 0);
+        CHECK(count > 1);
+        CHECK(vsc_hashmap_size(hm.get()) == 50000);
+
+        for(const auto& c : nkeys)
+            REQUIRE(vsc_hashmap_find(hm.get(), c) == c);
+    }
+
+    /* Too small to split, or no proc, falls back to vsc_hashmap_build(). */
+    hmptr  hm(vsc_hashmap_alloc(hashproc, compareproc));
+    size_t count = 0;
+    REQUIRE(vsc_hashmap_build_parallel(hm.get(), keys.data(), values.data(), 100, threaded, &count) == 0);
+    CHECK(count == 0);
+    REQUIRE(vsc_hashmap_build_parallel(hm.get(), keys.data(), values.data(), keys.size(), nullptr, nullptr) == 0);
+    CHECK(vsc_hashmap_size(hm.get()) == 50000);
+}
+
+TEST_CASE("hashmap stats", "[hashmap]")
+{
+    VscHashMapStats stats;
+    hmptr hm(vsc_hashmap_alloc([](const void *) -> vsc_hash_t { return 0; }, compareproc));
+
+    REQUIRE(vsc_hashmap_stats(hm.get(), &stats) == 0);
+    CHECK(stats.size == 0);
+    CHECK(stats.num_clusters == 0);
+    CHECK(stats.num_resizes == 0);
+
+    CHECK(vsc_hashmap_insert(hm.get(), "a", (void *)"A") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "b", (void *)"B") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "c", (void *)"C") == 0);
+    CHECK(vsc_hashmap_insert(hm.get(), "d", (void *)"D") == 0);
+
+    REQUIRE(vsc_hashmap_stats(hm.get(), &stats) == 0);
+    CHECK(stats.size == 4);
+    CHECK(stats.num_buckets == vsc_hashmap_capacity(hm.get()));
+    CHECK(stats.load_factor == (double)4 / (double)stats.num_buckets);
+    CHECK(stats.max_probe_length == 3);
+    CHECK(stats.mean_probe_length == 1.5);
+    CHECK(stats.probe_histogram[0] == 1);
+    CHECK(stats.probe_histogram[1] == 1);
+    CHECK(stats.probe_histogram[2] == 1);
+    CHECK(stats.probe_histogram[3] == 1);
+    CHECK(stats.num_clusters == 1);
+    CHECK(stats.longest_cluster == 4);
+    CHECK(stats.hash_collisions == 3);
+    CHECK(stats.num_resizes >= 1);
+
+    hmptr hm2(vsc_hashmap_alloc(hashproc, compareproc));
+
+    static char nkeys[1000][6];
+    for(size_t i = 0; i < 1000; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        REQUIRE(vsc_hashmap_insert(hm2.get(), nkeys[i], nkeys[i]) == 0);
+    }
+
+    REQUIRE(vsc_hashmap_stats(hm2.get(), &stats) == 0);
+    CHECK(stats.size == 1000);
+    CHECK(stats.hash_collisions == 0);
+    CHECK(stats.num_resizes > 1);
+    CHECK(stats.num_rehashed > 0);
+    CHECK(stats.num_rehashed < stats.num_resizes * 1000);
+
+    size_t total = 0;
+    for(size_t n : stats.probe_histogram)
+        total += n;
+    CHECK(total == 1000);
+    CHECK(stats.longest_cluster >= 1);
+    CHECK(stats.longest_cluster > stats.max_probe_length);
+}
+
+TEST_CASE("hashmap seeded", "[hashmap]")
+{
+    hmptr hm(vsc_hashmap_alloc_seeded(vsc_hashmap_string_hash_seeded, compareproc));
+    hmptr hm2(vsc_hashmap_alloc_seeded(vsc_hashmap_string_hash_seeded, compareproc));
+
+    /* Every map gets its own seed. */
+    CHECK(vsc_hashmap_seed(hm.get()) != vsc_hashmap_seed(hm2.get()));
+    CHECK(vsc_hashmap_hash(hm.get(), "a") == vsc_hash_string_seeded("a", vsc_hashmap_seed(hm.get())));
+    CHECK(vsc_hashmap_hash(hm.get(), "a") != vsc_hashmap_hash(hm2.get(), "a"));
+
+    REQUIRE(vsc_hashmap_set_seed(hm2.get(), vsc_hashmap_seed(hm.get())) == 0);
+    CHECK(vsc_hashmap_hash(hm.get(), "a") == vsc_hashmap_hash(hm2.get(), "a"));
+
+    /* Unseeded maps never need one, so don't get one. */
+    hmptr plain(vsc_hashmap_alloc(hashproc, compareproc));
+    CHECK(vsc_hashmap_seed(plain.get()) == 0);
+
+    static char nkeys[1000][6];
+    for(size_t i = 0; i < 1000; ++i) {
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+        REQUIRE(vsc_hashmap_insert(hm.get(), nkeys[i], nkeys[i]) == 0);
+    }
+
+    for(const auto& c : nkeys)
+        CHECK_CSTRING(c, (const char *)vsc_hashmap_find(hm.get(), c));
+
+    CHECK(vsc_hashmap_set_seed(hm.get(), 0) == VSC_ERROR(EBUSY));
+
+    /* The plain string hash is stable between runs, the random one only within a process. */
+    CHECK(vsc_hashmap_string_hash("a") == vsc_hash_string("a"));
+    CHECK(vsc_hashmap_string_hash_random("a") == vsc_hashmap_string_hash_random("a"));
+    CHECK(vsc_hashmap_string_hash_random("a") != vsc_hashmap_string_hash("a"));
+}
+
+TEST_CASE("hashmap clone", "[hashmap]")
+{
+    static char nkeys[1000][6];
+    for(size_t i = 0; i < 1000; ++i)
+        snprintf(nkeys[i], sizeof(nkeys[i]), "%zu", i);
+
+    for(VscHashMapLayout layout : {VSC_HASHMAP_LAYOUT_BUCKETS, VSC_HASHMAP_LAYOUT_COMPACT}) {
+        hmptr hm(vsc_hashmap_alloc_seeded(vsc_hashmap_string_hash_seeded, compareproc));
+        REQUIRE(vsc_hashmap_set_layout(hm.get(), layout) == 0);
+
+        for(const auto& c : nkeys)
+            REQUIRE(vsc_hashmap_insert(hm.get(), c, (void *)c) == 0);
+
+        hmptr copy(vsc_hashmap_clone(hm.get()));
+        REQUIRE(copy != nullptr);
+        CHECK(vsc_hashmap_layout(copy.get()) == layout);
+        CHECK(vsc_hashmap_seed(copy.get()) == vsc_hashmap_seed(hm.get()));
+        CHECK(vsc_hashmap_size(copy.get()) == 1000);
+        CHECK(vsc_hashmap_capacity(copy.get()) == vsc_hashmap_capacity(hm.get()));
+
+        /* Shared clones, stacked. */
+        hmptr snap(vsc_hashmap_clone_shared(hm.get()));
+        REQUIRE(snap != nullptr);
+        hmptr snap2(vsc_hashmap_clone_shared(snap.get()));
+        REQUIRE(snap2 != nullptr);
+
+        /* Writing to the original mustn't be visible to any of the clones. */
+        CHECK(vsc_hashmap_remove(hm.get(), nkeys[0]) == nkeys[0]);
+        CHECK(vsc_hashmap_update(hm.get(), nkeys[1], nullptr) == 0);
+        REQUIRE(vsc_hashmap_insert(hm.get(), "new", nullptr) == 0);
+
+        for(VscHashMap *m : {copy.get(), snap.get(), snap2.get()}) {
+            CHECK(vsc_hashmap_size(m) == 1000);
+            CHECK(vsc_hashmap_find(m, "new") == nullptr);
+
+            for(const auto& c : nkeys)
+                CHECK_CSTRING(c, (const char *)vsc_hashmap_find(m, c));
+        }
+
+        CHECK(vsc_hashmap_size(hm.get()) == 1000);
+        CHECK(vsc_hashmap_find(hm.get(), nkeys[0]) == nullptr);
+        CHECK(vsc_hashmap_find(hm.get(), nkeys[1]) == nullptr);
+
+        /* Nor the other way around, including a resize. */
+        REQUIRE(vsc_hashmap_clear(snap.get()) == 0);
+        CHECK(vsc_hashmap_size(snap.get()) == 0);
+        REQUIRE(vsc_hashmap_resize(snap2.get(), 4096) == 0);
+        for(size_t i = 0; i < 500; ++i)
+            CHECK(vsc_hashmap_remove(snap2.get(), nkeys[i]) == nkeys[i]);
+
+        CHECK(vsc_hashmap_size(snap2.get()) == 500);
+        CHECK_CSTRING(nkeys[999], (const char *)vsc_hashmap_find(snap2.get(), nkeys[999]));
+        CHECK_CSTRING(nkeys[2], (const char *)vsc_hashmap_find(hm.get(), nkeys[2]));
+        CHECK(vsc_hashmap_size(copy.get()) == 1000);
+
+        /* Release the original first; the last clone standing gets the buckets. */
+        hmptr last(vsc_hashmap_clone_shared(copy.get()));
+        REQUIRE(last != nullptr);
+        copy.reset();
+        REQUIRE(vsc_hashmap_insert(last.get(), "new", nullptr) == 0);
+        CHECK(vsc_hashmap_size(last.get()) == 1001);
+    }
+
+    /* Clones of an empty map have nothing to share. */
+    hmptr empty(vsc_hashmap_alloc(hashproc, compareproc));
+    hmptr eclone(vsc_hashmap_clone_shared(empty.get()));
+    REQUIRE(eclone != nullptr);
+    CHECK(vsc_hashmap_capacity(eclone.get()) == 0);
+    REQUIRE(vsc_hashmap_insert(eclone.get(), "a", nullptr) == 0);
+    CHECK(vsc_hashmap_size(empty.get()) == 0);
+}
+
+static bool fail_allocs = false;
+
+static int failing_alloc(void **ptr, size_t size, size_t alignment, VscAllocFlags flags, void *user)
+{
+    (void)user;
+    if(fail_allocs && !(flags & VSC_ALLOC_NOFAIL))
+        return VSC_ERROR(ENOMEM);
+
+    return vsc_xalloc_ex(vsclib_system_allocator, ptr, size, flags, alignment);
+}
+
+static void failing_free(void *p, void *user)
+{
+    (void)user;
+    vsc_xfree(vsclib_system_allocator, p);
+}
+
+static size_t failing_size(void *p, void *user)
+{
+    (void)user;
+    return vsclib_system_allocator->size(p, vsclib_system_allocator->user);
+}
+
+TEST_CASE("hashmap shared failures", "[hashmap]")
+{
+    static const VscAllocator failing = {
+        failing_alloc, failing_free, failing_size, VSC_ALIGNOF(vsc_max_align_t), nullptr,
+    };
+
+    hmptr hm(vsc_hashmap_alloca(hashproc, compareproc, &failing));
+    REQUIRE(hm != nullptr);
+    REQUIRE(vsc_hashmap_insert(hm.get(), "a", (void *)"a") == 0);
+    REQUIRE(vsc_hashmap_insert(hm.get(), "b", (void *)"b") == 0);
+
+    hmptr snap(vsc_hashmap_clone_shared(hm.get()));
+    REQUIRE(snap != nullptr);
+
+    /* The buckets can't be copied, so nothing is removed, and we're told so. */
+    void *val = nullptr;
+    fail_allocs = true;
+    CHECK(vsc_hashmap_remove_ex(hm.get(), "a", vsc_hashmap_hash(hm.get(), "a"), &val) == VSC_ERROR(ENOMEM));
+    CHECK(vsc_hashmap_remove_ex(hm.get(), "c", vsc_hashmap_hash(hm.get(), "c"), &val) == 1);
+    CHECK(vsc_hashmap_clear(hm.get()) == VSC_ERROR(ENOMEM));
+    CHECK(vsc_hashmap_update(hm.get(), "a", nullptr) == VSC_ERROR(ENOMEM));
+    CHECK(vsc_hashmap_update(hm.get(), "c", nullptr) == 1);
+    fail_allocs = false;
+
+    CHECK(val == nullptr);
+    CHECK(vsc_hashmap_size(hm.get()) == 2);
+    CHECK(vsc_hashmap_find(hm.get(), "a") == (void *)"a");
+
+    REQUIRE(vsc_hashmap_remove_ex(hm.get(), "a", vsc_hashmap_hash(hm.get(), "a"), &val) == 0);
+    CHECK(val == (void *)"a");
+    CHECK(vsc_hashmap_find(snap.get(), "a") == (void *)"a");
+
+    /* Clearing a shared map keeps its capacity, and leaves the other alone. */
+    hmptr snap2(vsc_hashmap_clone_shared(snap.get()));
+    REQUIRE(snap2 != nullptr);
+    size_t cap = vsc_hashmap_capacity(snap.get());
+    REQUIRE(vsc_hashmap_clear(snap.get()) == 0);
+    CHECK(vsc_hashmap_size(snap.get()) == 0);
+    CHECK(vsc_hashmap_capacity(snap.get()) == cap);
+    CHECK(vsc_hashmap_find(snap.get(), "b") == nullptr);
+    CHECK(vsc_hashmap_size(snap2.get()) == 2);
+    CHECK(vsc_hashmap_find(snap2.get(), "b") == (void *)"b");
+
+    REQUIRE(vsc_hashmap_insert(snap.get(), "c", (void *)"c") == 0);
+    CHECK(vsc_hashmap_find(snap2.get(), "c") == nullptr);
+}
@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <string>
+#include "common.hpp"
+
+static vsc_hash_t hashproc(const void *key)
+{
+    return vsc_hash_string(static_cast<const char *>(key));
+}
+
+static int compareproc(const void *a, const void *b)
+{
+    return strcmp(static_cast<const char *>(a), static_cast<const char *>(b)) == 0;
+}
+
+struct snapdel {
+    using pointer = VscHashMapSnapshot *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_hashmap_snapshot_close(p);
+    }
+};
+using snapptr = std::unique_ptr<VscHashMapSnapshot, snapdel>;
+
+/* Keys are C strings, values are pointers to uint64_t's. */
+static int encodeproc(const void *key, void *value, VscHashMapSnapshotItem *item, void *)
+{
+    item->key        = key;
+    item->key_size   = strlen(static_cast<const char *>(key));
+    item->value      = value;
+    item->value_size = sizeof(uint64_t);
+    return 0;
+}
+
+static void check_snapshot(const VscHashMapSnapshot *snap, const std::vector<std::string>& keys)
+{
+    CHECK(vsc_hashmap_snapshot_size(snap) == keys.size());
+
+    for(size_t i = 0; i < keys.size(); ++i) {
+        size_t      vsize = 0;
+        const void *v     = vsc_hashmap_snapshot_find(snap, keys[i].data(), keys[i].size(), &vsize);
+        REQUIRE(v != nullptr);
+        CHECK(vsize == sizeof(uint64_t));
+        CHECK(VSC_IS_ALIGNED(v, 8));
+        CHECK(*static_cast<const uint64_t *>(v) == i * 3);
+    }
+
+    CHECK(vsc_hashmap_snapshot_find(snap, "missing", 7, nullptr) == nullptr);
+    CHECK(vsc_hashmap_snapshot_find(snap, "", 0, nullptr) == nullptr);
+}
+
+TEST_CASE("hashmap snapshot", "[hashmap_snapshot]")
+{
+    const char *path = "hashmap-snapshot-test.bin";
+
+    std::vector<std::string> keys;
+    std::vector<uint64_t>    values;
+    for(size_t i = 0; i < 500; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        values.push_back(i * 3);
+    }
+
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+    REQUIRE(hm);
+
+    for(size_t i = 0; i < keys.size(); ++i)
+        REQUIRE(vsc_hashmap_insert(hm.get(), keys[i].c_str(), &values[i]) == 0);
+
+    {
+        vsc::stdio_ptr f(fopen(path, "wb"));
+        REQUIRE(f);
+        REQUIRE(vsc_hashmap_snapshot_write(hm.get(), f.get(), encodeproc, nullptr) == 0);
+    }
+
+    SECTION("mapped")
+    {
+        VscHashMapSnapshot *_snap = nullptr;
+        REQUIRE(vsc_hashmap_snapshot_open(&_snap, path) == 0);
+        snapptr snap(_snap);
+
+        check_snapshot(snap.get(), keys);
+    }
+
+    SECTION("memory")
+    {
+        void  *data = nullptr;
+        size_t size = 0;
+        {
+            vsc::stdio_ptr f(fopen(path, "rb"));
+            REQUIRE(f);
+            REQUIRE(vsc_freadall(&data, &size, f.get()) == 0);
+        }
+        vsc::vsc_ptr<void> _data(data);
+
+        VscHashMapSnapshot *_snap = nullptr;
+        REQUIRE(vsc_hashmap_snapshot_load(&_snap, data, size) == 0);
+        snapptr snap(_snap);
+
+        check_snapshot(snap.get(), keys);
+
+        /* Truncated */
+        VscHashMapSnapshot *bad = nullptr;
+        CHECK(vsc_hashmap_snapshot_load(&bad, data, size - 1) == VSC_ERROR(EINVAL));
+        CHECK(vsc_hashmap_snapshot_load(&bad, data, 32) == VSC_ERROR(EINVAL));
+    }
+
+    remove(path);
+}
+
+TEST_CASE("hashmap snapshot empty", "[hashmap_snapshot]")
+{
+    hmptr hm(vsc_hashmap_alloc(hashproc, compareproc));
+    REQUIRE(hm);
+
+    vsc::stdio_ptr f(tmpfile());
+    REQUIRE(f);
+    REQUIRE(vsc_hashmap_snapshot_write(hm.get(), f.get(), encodeproc, nullptr) == 0);
+    rewind(f.get());
+
+    void  *data = nullptr;
+    size_t size = 0;
+    REQUIRE(vsc_freadall(&data, &size, f.get()) == 0);
+    vsc::vsc_ptr<void> _data(data);
+
+    VscHashMapSnapshot *_snap = nullptr;
+    REQUIRE(vsc_hashmap_snapshot_load(&_snap, data, size) == 0);
+    snapptr snap(_snap);
+
+    CHECK(vsc_hashmap_snapshot_size(snap.get()) == 0);
+    CHECK(vsc_hashmap_snapshot_find(snap.get(), "a", 1, nullptr) == nullptr);
+}
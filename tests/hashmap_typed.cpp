@@ -0,0 +1,93 @@
+#include "common.hpp"
+
+struct Vec3 {
+    float x, y, z;
+};
+
+#define U32_HASH(k)  vsc_hashmap_mix64(k)
+#define U32_EQ(a, b) ((a) == (b))
+VSC_HASHMAP_DECLARE(U32Vec3Map, uint32_t, Vec3, U32_HASH, U32_EQ)
+
+/* Everything collides, to exercise probing and removal. */
+#define BAD_HASH(k) ((vsc_hash_t)((k) % 4))
+VSC_HASHMAP_DECLARE(BadMap, uint32_t, uint32_t, BAD_HASH, U32_EQ)
+
+TEST_CASE("typed hashmap", "[hashmap_typed]")
+{
+    U32Vec3Map m;
+    U32Vec3Map_init(&m, nullptr);
+
+    CHECK(U32Vec3Map_find(&m, 0) == nullptr);
+    CHECK(U32Vec3Map_remove(&m, 0, nullptr) == 1);
+
+    for(uint32_t i = 0; i < 1000; ++i)
+        REQUIRE(U32Vec3Map_insert(&m, i, Vec3{(float)i, (float)i * 2, (float)i * 3}) == 0);
+
+    CHECK(U32Vec3Map_size(&m) == 1000);
+    CHECK(VSC_IS_POT(m.num_buckets));
+
+    for(uint32_t i = 0; i < 1000; ++i) {
+        const Vec3 *v = U32Vec3Map_find(&m, i);
+        REQUIRE(v != nullptr);
+        CHECK(v->x == (float)i);
+        CHECK(v->z == (float)i * 3);
+    }
+
+    /* Replace */
+    REQUIRE(U32Vec3Map_insert(&m, 5, Vec3{-1, -1, -1}) == 0);
+    CHECK(U32Vec3Map_size(&m) == 1000);
+    CHECK(U32Vec3Map_find(&m, 5)->x == -1);
+
+    Vec3 old{};
+    CHECK(U32Vec3Map_remove(&m, 5, &old) == 0);
+    CHECK(old.x == -1);
+    CHECK(U32Vec3Map_find(&m, 5) == nullptr);
+    CHECK(U32Vec3Map_size(&m) == 999);
+
+    size_t count = 0;
+    int    r     = U32Vec3Map_enumerate(
+        &m,
+        [](const uint32_t *, Vec3 *, void *user) {
+            ++*reinterpret_cast<size_t *>(user);
+            return 0;
+        },
+        &count);
+    CHECK(r == 0);
+    CHECK(count == 999);
+
+    U32Vec3Map_clear(&m);
+    CHECK(U32Vec3Map_size(&m) == 0);
+    CHECK(U32Vec3Map_find(&m, 1) == nullptr);
+
+    U32Vec3Map_reset(&m);
+    CHECK(m.slots == nullptr);
+}
+
+TEST_CASE("typed hashmap collisions", "[hashmap_typed]")
+{
+    BadMap m;
+    BadMap_init(&m, nullptr);
+
+    for(uint32_t i = 0; i < 12; ++i)
+        REQUIRE(BadMap_insert(&m, i, i + 100) == 0);
+
+    /* 12 elements fit in the minimum size. */
+    CHECK(m.num_buckets == VSC_HASHMAP_TYPED_MIN_BUCKETS);
+
+    /* Remove every other key, the rest must still be reachable. */
+    for(uint32_t i = 0; i < 12; i += 2)
+        REQUIRE(BadMap_remove(&m, i, nullptr) == 0);
+
+    for(uint32_t i = 0; i < 12; ++i) {
+        uint32_t *v = BadMap_find(&m, i);
+        if(i % 2 == 0) {
+            CHECK(v == nullptr);
+        } else {
+            REQUIRE(v != nullptr);
+            CHECK(*v == i + 100);
+        }
+    }
+
+    CHECK(BadMap_size(&m) == 6);
+    BadMap_reset(&m);
+}
@@ -0,0 +1,131 @@
+#include "common.hpp"
+
+struct hsdel {
+    using pointer = VscHashSet *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_hashset_free(p);
+    }
+};
+using hsptr = std::unique_ptr<VscHashSet, hsdel>;
+
+static hsptr make_range(uintptr_t begin, uintptr_t end)
+{
+    hsptr set(vsc_hashset_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(set);
+
+    for(uintptr_t i = begin; i < end; ++i)
+        REQUIRE(vsc_hashset_insert(set.get(), make_key(i)) == 0);
+
+    return set;
+}
+
+TEST_CASE("hashset", "[hashset]")
+{
+    hsptr set = make_range(1, 1001);
+
+    CHECK(vsc_hashset_size(set.get()) == 1000);
+
+    /* Duplicates don't count. */
+    CHECK(vsc_hashset_insert(set.get(), make_key(1)) == 0);
+    CHECK(vsc_hashset_size(set.get()) == 1000);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        CHECK(vsc_hashset_contains(set.get(), make_key(i)));
+    CHECK_FALSE(vsc_hashset_contains(set.get(), make_key(1001)));
+
+    vsc_hash_t h = vsc_hashset_hash(set.get(), make_key(5));
+    CHECK(vsc_hashset_contains_with_hash(set.get(), make_key(5), h));
+
+    for(uintptr_t i = 1; i <= 1000; i += 2)
+        CHECK(vsc_hashset_remove(set.get(), make_key(i)) == 0);
+    CHECK(vsc_hashset_remove(set.get(), make_key(1)) == 1);
+    CHECK(vsc_hashset_size(set.get()) == 500);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        CHECK(vsc_hashset_contains(set.get(), make_key(i)) == (i % 2 == 0));
+
+    size_t sum = 0;
+    CHECK(vsc_hashset_enumerate(
+              set.get(),
+              [](const void *key, vsc_hash_t hash, void *user) {
+                  CHECK(hash == ptr_hashproc(key));
+                  *static_cast<size_t *>(user) += reinterpret_cast<uintptr_t>(key);
+                  return 0;
+              },
+              &sum) == 0);
+    CHECK(sum == 500 * 501);
+
+    vsc_hashset_clear(set.get());
+    CHECK(vsc_hashset_size(set.get()) == 0);
+    CHECK_FALSE(vsc_hashset_contains(set.get(), make_key(2)));
+}
+
+TEST_CASE("hashset union", "[hashset]")
+{
+    hsptr a = make_range(0, 600);
+    hsptr b = make_range(400, 1000);
+
+    REQUIRE(vsc_hashset_union(a.get(), b.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 1000);
+    for(uintptr_t i = 0; i < 1000; ++i)
+        CHECK(vsc_hashset_contains(a.get(), make_key(i)));
+
+    /* Union with itself is a no-op. */
+    REQUIRE(vsc_hashset_union(a.get(), a.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 1000);
+
+    /* Into an empty set. */
+    hsptr c(vsc_hashset_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(vsc_hashset_union(c.get(), b.get()) == 0);
+    CHECK(vsc_hashset_size(c.get()) == 600);
+}
+
+TEST_CASE("hashset intersect", "[hashset]")
+{
+    hsptr a = make_range(0, 600);
+    hsptr b = make_range(400, 1000);
+
+    REQUIRE(vsc_hashset_intersect(a.get(), b.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 200);
+    for(uintptr_t i = 0; i < 1000; ++i)
+        CHECK(vsc_hashset_contains(a.get(), make_key(i)) == (i >= 400 && i < 600));
+
+    /* Removal and insertion still work after the rebuild. */
+    CHECK(vsc_hashset_remove(a.get(), make_key(450)) == 0);
+    CHECK(vsc_hashset_insert(a.get(), make_key(0)) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 200);
+
+    REQUIRE(vsc_hashset_intersect(a.get(), a.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 200);
+
+    hsptr empty(vsc_hashset_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(vsc_hashset_intersect(a.get(), empty.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 0);
+    CHECK(vsc_hashset_capacity(a.get()) < 64);
+}
+
+TEST_CASE("hashset difference", "[hashset]")
+{
+    hsptr a = make_range(0, 600);
+    hsptr b = make_range(400, 1000);
+
+    REQUIRE(vsc_hashset_difference(a.get(), b.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 400);
+    for(uintptr_t i = 0; i < 1000; ++i)
+        CHECK(vsc_hashset_contains(a.get(), make_key(i)) == (i < 400));
+
+    REQUIRE(vsc_hashset_difference(a.get(), a.get()) == 0);
+    CHECK(vsc_hashset_size(a.get()) == 0);
+}
+
+TEST_CASE("hashset mismatched hash", "[hashset]")
+{
+    hsptr a = make_range(0, 10);
+    hsptr b(vsc_hashset_alloc(vsc_hashmap_default_hash, ptr_compareproc));
+
+    CHECK(vsc_hashset_union(a.get(), b.get()) == VSC_ERROR(EINVAL));
+    CHECK(vsc_hashset_intersect(a.get(), b.get()) == VSC_ERROR(EINVAL));
+    CHECK(vsc_hashset_difference(a.get(), b.get()) == VSC_ERROR(EINVAL));
+    CHECK(vsc_hashset_size(a.get()) == 10);
+}
@@ -0,0 +1,149 @@
+#include <vector>
+#include <cstring>
+#include "common.hpp"
+
+struct lrudel {
+    using pointer = VscLruCache *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_lru_cache_free(p);
+    }
+};
+using lruptr = std::unique_ptr<VscLruCache, lrudel>;
+
+static void evictproc(const void *key, void *value, void *user)
+{
+    (void)value;
+    static_cast<std::vector<uintptr_t> *>(user)->push_back(reinterpret_cast<uintptr_t>(key));
+}
+
+TEST_CASE("lru cache", "[lru_cache]")
+{
+    std::vector<uintptr_t> evicted;
+    VscLruCacheStats       stats;
+
+    CHECK(vsc_lru_cache_alloc(ptr_hashproc, ptr_compareproc, 0, 0, nullptr, nullptr) == nullptr);
+
+    lruptr cache(vsc_lru_cache_alloc(ptr_hashproc, ptr_compareproc, 3, 0, evictproc, &evicted));
+    REQUIRE(cache);
+
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(1), make_key(10), 0) == 0);
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(2), make_key(20), 0) == 0);
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(3), make_key(30), 0) == 0);
+    CHECK(vsc_lru_cache_size(cache.get()) == 3);
+
+    /* 1 is now the most recent, so 2 goes first. */
+    CHECK(vsc_lru_cache_get(cache.get(), make_key(1)) == make_key(10));
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(4), make_key(40), 0) == 0);
+    CHECK(evicted == std::vector<uintptr_t>{2});
+    CHECK(vsc_lru_cache_get(cache.get(), make_key(2)) == nullptr);
+    CHECK(vsc_lru_cache_size(cache.get()) == 3);
+
+    /* Replacing calls the eviction proc on the old value, but isn't an eviction. The key is still held. */
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(3), make_key(31), 0) == 0);
+    CHECK(evicted == std::vector<uintptr_t>{2, 0});
+    CHECK(vsc_lru_cache_get(cache.get(), make_key(3)) == make_key(31));
+
+    /* Re-putting the exact same entry doesn't, the cache still owns it. */
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(3), make_key(31), 0) == 0);
+    CHECK(evicted == std::vector<uintptr_t>{2, 0});
+    CHECK(vsc_lru_cache_get(cache.get(), make_key(3)) == make_key(31));
+
+    /* Removing doesn't. */
+    CHECK(vsc_lru_cache_remove(cache.get(), make_key(4)) == make_key(40));
+    CHECK(vsc_lru_cache_remove(cache.get(), make_key(4)) == nullptr);
+    CHECK(evicted.size() == 2);
+    CHECK(vsc_lru_cache_size(cache.get()) == 2);
+
+    vsc_lru_cache_stats(cache.get(), &stats);
+    CHECK(stats.hits == 3);
+    CHECK(stats.misses == 1);
+    CHECK(stats.evictions == 1);
+
+    /* Oldest first. */
+    evicted.clear();
+    vsc_lru_cache_clear(cache.get());
+    CHECK(evicted == std::vector<uintptr_t>{1, 3});
+    CHECK(vsc_lru_cache_size(cache.get()) == 0);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_lru_cache_put(cache.get(), make_key(i), make_key(i), 0) == 0);
+
+    CHECK(vsc_lru_cache_size(cache.get()) == 3);
+    for(uintptr_t i = 998; i <= 1000; ++i)
+        CHECK(vsc_lru_cache_get(cache.get(), make_key(i)) == make_key(i));
+}
+
+using evicted_pairs = std::vector<std::pair<const void *, void *>>;
+
+static void evictpairproc(const void *key, void *value, void *user)
+{
+    static_cast<evicted_pairs *>(user)->emplace_back(key, value);
+}
+
+static int strcompareproc(const void *a, const void *b)
+{
+    return strcmp(static_cast<const char *>(a), static_cast<const char *>(b)) == 0;
+}
+
+TEST_CASE("lru cache replace", "[lru_cache]")
+{
+    static char   k1[] = "key", k2[] = "key";
+    evicted_pairs evicted;
+    lruptr        cache(vsc_lru_cache_alloc(vsc_hashmap_string_hash, strcompareproc, 4, 0, evictpairproc, &evicted));
+    REQUIRE(cache);
+
+    REQUIRE(vsc_lru_cache_put(cache.get(), k1, make_key(10), 0) == 0);
+
+    /* Only the value changed, so only it is handed back. */
+    REQUIRE(vsc_lru_cache_put(cache.get(), k1, make_key(11), 0) == 0);
+    CHECK(evicted == evicted_pairs{{nullptr, make_key(10)}});
+
+    /* Only the key pointer changed, so only it is handed back. */
+    evicted.clear();
+    REQUIRE(vsc_lru_cache_put(cache.get(), k2, make_key(11), 0) == 0);
+    CHECK(evicted == evicted_pairs{{k1, nullptr}});
+
+    /* Both. */
+    evicted.clear();
+    REQUIRE(vsc_lru_cache_put(cache.get(), k1, make_key(12), 0) == 0);
+    CHECK(evicted == evicted_pairs{{k2, make_key(11)}});
+
+    evicted.clear();
+    vsc_lru_cache_clear(cache.get());
+    CHECK(evicted == evicted_pairs{{k1, make_key(12)}});
+}
+
+TEST_CASE("lru cache cost", "[lru_cache]")
+{
+    std::vector<uintptr_t> evicted;
+    VscLruCacheStats       stats;
+
+    lruptr cache(vsc_lru_cache_alloc(ptr_hashproc, ptr_compareproc, 100, 10, evictproc, &evicted));
+    REQUIRE(cache);
+
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(1), nullptr, 11) == VSC_ERROR(ERANGE));
+    CHECK(vsc_lru_cache_size(cache.get()) == 0);
+
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(1), nullptr, 4) == 0);
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(2), nullptr, 4) == 0);
+    CHECK(vsc_lru_cache_cost(cache.get()) == 8);
+
+    /* Needs both of the others out. */
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(3), nullptr, 7) == 0);
+    CHECK(evicted == std::vector<uintptr_t>{1, 2});
+    CHECK(vsc_lru_cache_cost(cache.get()) == 7);
+
+    /*
+     * Growing an entry in place evicts others, but never itself.
+     * It's the same key and value, so nothing is handed back for it either.
+     */
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(4), nullptr, 3) == 0);
+    CHECK(vsc_lru_cache_put(cache.get(), make_key(3), nullptr, 10) == 0);
+    CHECK(evicted == std::vector<uintptr_t>{1, 2, 4});
+    CHECK(vsc_lru_cache_size(cache.get()) == 1);
+    CHECK(vsc_lru_cache_cost(cache.get()) == 10);
+
+    vsc_lru_cache_stats(cache.get(), &stats);
+    CHECK(stats.evictions == 3);
+}
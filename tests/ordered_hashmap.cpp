@@ -0,0 +1,137 @@
+#include <vector>
+#include "common.hpp"
+
+struct omdel {
+    using pointer = VscOrderedHashMap *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_ordered_hashmap_free(p);
+    }
+};
+using omptr = std::unique_ptr<VscOrderedHashMap, omdel>;
+
+static std::vector<uintptr_t> keys_of(const VscOrderedHashMap *om)
+{
+    std::vector<uintptr_t> keys;
+
+    REQUIRE(vsc_ordered_hashmap_enumerate(
+                om,
+                [](const void *key, void *value, vsc_hash_t hash, void *user) {
+                    CHECK(key == value);
+                    CHECK(hash == ptr_hashproc(key));
+                    static_cast<std::vector<uintptr_t> *>(user)->push_back(reinterpret_cast<uintptr_t>(key));
+                    return 0;
+                },
+                &keys) == 0);
+
+    return keys;
+}
+
+TEST_CASE("ordered hashmap", "[ordered_hashmap]")
+{
+    omptr om(vsc_ordered_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(om);
+
+    CHECK(vsc_ordered_hashmap_capacity(om.get()) == 0);
+    CHECK(vsc_ordered_hashmap_find(om.get(), make_key(1)) == nullptr);
+    CHECK(vsc_ordered_hashmap_remove(om.get(), make_key(1)) == nullptr);
+
+    for(uintptr_t i = 10; i > 0; --i)
+        REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(i), make_key(i)) == 0);
+
+    CHECK(vsc_ordered_hashmap_size(om.get()) == 10);
+    CHECK(keys_of(om.get()) == std::vector<uintptr_t>{10, 9, 8, 7, 6, 5, 4, 3, 2, 1});
+
+    /* Replacing keeps the position. */
+    REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(7), make_key(70)) == 0);
+    CHECK(vsc_ordered_hashmap_find(om.get(), make_key(7)) == make_key(70));
+    REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(7), make_key(7)) == 0);
+    CHECK(vsc_ordered_hashmap_size(om.get()) == 10);
+
+    /* Removing leaves the rest in order, and re-inserting goes to the back. */
+    CHECK(vsc_ordered_hashmap_remove(om.get(), make_key(8)) == make_key(8));
+    CHECK(vsc_ordered_hashmap_remove(om.get(), make_key(3)) == make_key(3));
+    CHECK(vsc_ordered_hashmap_remove(om.get(), make_key(3)) == nullptr);
+    REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(8), make_key(8)) == 0);
+    CHECK(keys_of(om.get()) == std::vector<uintptr_t>{10, 9, 7, 6, 5, 4, 2, 1, 8});
+
+    size_t                  count;
+    const VscHashMapBucket *e = vsc_ordered_hashmap_entries(om.get(), &count);
+    REQUIRE(e != nullptr);
+    CHECK(count == 11);
+    CHECK(e[2].hash == VSC_INVALID_HASH);
+    CHECK(e[7].hash == VSC_INVALID_HASH);
+    CHECK(e[10].key == make_key(8));
+
+    /* Removing from the back frees the entry straight away. */
+    CHECK(vsc_ordered_hashmap_remove(om.get(), make_key(8)) == make_key(8));
+    vsc_ordered_hashmap_entries(om.get(), &count);
+    CHECK(count == 10);
+
+    vsc_ordered_hashmap_clear(om.get());
+    CHECK(vsc_ordered_hashmap_size(om.get()) == 0);
+    CHECK(vsc_ordered_hashmap_entries(om.get(), &count) == nullptr);
+    CHECK(count == 0);
+    CHECK(vsc_ordered_hashmap_find(om.get(), make_key(10)) == nullptr);
+    CHECK(keys_of(om.get()).empty());
+}
+
+TEST_CASE("ordered hashmap growth", "[ordered_hashmap]")
+{
+    omptr om(vsc_ordered_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(om);
+
+    /* Goes through the 1, 2 and 4-byte index widths. */
+    const uintptr_t n = 100000;
+    for(uintptr_t i = 1; i <= n; ++i)
+        REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(i), make_key(i)) == 0);
+
+    CHECK(vsc_ordered_hashmap_size(om.get()) == n);
+
+    for(uintptr_t i = 1; i <= n; ++i)
+        REQUIRE(vsc_ordered_hashmap_find(om.get(), make_key(i)) == make_key(i));
+
+    /* Remove the odd keys, then fill the map until it compacts. */
+    for(uintptr_t i = 1; i <= n; i += 2)
+        REQUIRE(vsc_ordered_hashmap_remove(om.get(), make_key(i)) == make_key(i));
+
+    size_t capacity = vsc_ordered_hashmap_capacity(om.get());
+    for(uintptr_t i = n + 1; vsc_ordered_hashmap_size(om.get()) <= capacity / 2 + 1; ++i)
+        REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(i), make_key(i)) == 0);
+
+    /* Half were removed, so there was no need to grow. */
+    CHECK(vsc_ordered_hashmap_capacity(om.get()) == capacity);
+
+    std::vector<uintptr_t> keys = keys_of(om.get());
+    REQUIRE(keys.size() == vsc_ordered_hashmap_size(om.get()));
+    for(size_t i = 0; i < n / 2; ++i)
+        CHECK(keys[i] == (i + 1) * 2);
+
+    for(size_t i = n / 2; i < keys.size(); ++i)
+        CHECK(keys[i] == n + 1 + (i - n / 2));
+
+    for(uintptr_t k : keys)
+        REQUIRE(vsc_ordered_hashmap_find(om.get(), make_key(k)) == make_key(k));
+
+    for(uintptr_t i = 1; i <= n; i += 2)
+        REQUIRE(vsc_ordered_hashmap_find(om.get(), make_key(i)) == nullptr);
+}
+
+TEST_CASE("ordered hashmap reserve", "[ordered_hashmap]")
+{
+    omptr om(vsc_ordered_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(om);
+
+    REQUIRE(vsc_ordered_hashmap_reserve(om.get(), 1000) == 0);
+    size_t capacity = vsc_ordered_hashmap_capacity(om.get());
+    CHECK(capacity >= 1000);
+
+    for(uintptr_t i = 1; i <= 1000; ++i)
+        REQUIRE(vsc_ordered_hashmap_insert(om.get(), make_key(i), make_key(i)) == 0);
+
+    CHECK(vsc_ordered_hashmap_capacity(om.get()) == capacity);
+
+    vsc_ordered_hashmap_reset(om.get());
+    CHECK(vsc_ordered_hashmap_capacity(om.get()) == 0);
+    CHECK(vsc_ordered_hashmap_find(om.get(), make_key(1)) == nullptr);
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <string>
+#include "common.hpp"
+
+static void check_perfect(const uint32_t *table, const std::vector<std::string>& keys)
+{
+    std::vector<bool> seen(keys.size(), false);
+
+    REQUIRE(vsc_perfect_hash_count(table) == keys.size());
+
+    for(const std::string& k : keys) {
+        size_t i = vsc_perfect_hash_lookup(table, k.data(), k.size());
+        REQUIRE(i < keys.size());
+        CHECK(!seen[i]);
+        seen[i] = true;
+    }
+}
+
+static int build(uint32_t **table, size_t *len, const std::vector<std::string>& keys)
+{
+    std::vector<const void *> ptrs;
+    std::vector<size_t>       sizes;
+
+    for(const std::string& k : keys) {
+        ptrs.push_back(k.data());
+        sizes.push_back(k.size());
+    }
+
+    return vsc_perfect_hash_build(table, len, ptrs.data(), sizes.data(), keys.size());
+}
+
+TEST_CASE("perfect hash keywords", "[perfect_hash]")
+{
+    std::vector<std::string> keys = {
+        "auto",   "break",  "case",    "char",   "const",    "continue", "default",  "do",
+        "double", "else",   "enum",    "extern", "float",    "for",      "goto",     "if",
+        "int",    "long",   "register", "return", "short",   "signed",   "sizeof",   "static",
+        "struct", "switch", "typedef", "union",  "unsigned", "void",     "volatile", "while",
+    };
+
+    uint32_t *table = nullptr;
+    size_t    len   = 0;
+    REQUIRE(build(&table, &len, keys) == 0);
+    vsc::vsc_ptr<uint32_t> _table(table);
+
+    CHECK(len == vsc_perfect_hash_table_len(table));
+    CHECK(vsc_perfect_hash_validate(table, len) == 0);
+    CHECK(vsc_perfect_hash_validate(table, len - 1) == VSC_ERROR(EINVAL));
+    check_perfect(table, keys);
+
+    vsc::stdio_ptr f(tmpfile());
+    REQUIRE(f);
+    REQUIRE(vsc_perfect_hash_write_c(table, f.get(), "keywords") == 0);
+    rewind(f.get());
+
+    char buf[256] = {};
+    REQUIRE(fgets(buf, sizeof(buf), f.get()) != nullptr);
+    REQUIRE(fgets(buf, sizeof(buf), f.get()) != nullptr);
+    CHECK(strcmp(buf, ("static const uint32_t keywords[" + std::to_string(len) + "] = {\n").c_str()) == 0);
+}
+
+TEST_CASE("perfect hash large", "[perfect_hash]")
+{
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < 20000; ++i)
+        keys.push_back("key/" + std::to_string(i));
+
+    uint32_t *table = nullptr;
+    size_t    len   = 0;
+    REQUIRE(build(&table, &len, keys) == 0);
+    vsc::vsc_ptr<uint32_t> _table(table);
+
+    /* About a byte per key, plus the remap. */
+    CHECK(len * sizeof(uint32_t) <= keys.size() + keys.size() / 20 + 64);
+    check_perfect(table, keys);
+}
+
+TEST_CASE("perfect hash edge cases", "[perfect_hash]")
+{
+    uint32_t *table = nullptr;
+    size_t    len   = 0;
+
+    REQUIRE(build(&table, &len, {}) == 0);
+    CHECK(vsc_perfect_hash_count(table) == 0);
+    CHECK(vsc_perfect_hash_lookup(table, "x", 1) == 0);
+    vsc_free(table);
+
+    REQUIRE(build(&table, &len, {"only"}) == 0);
+    CHECK(vsc_perfect_hash_lookup(table, "only", 4) == 0);
+    vsc_free(table);
+
+    CHECK(build(&table, &len, {"a", "b", "a"}) == VSC_ERROR(EEXIST));
+}
+
+TEST_CASE("perfect hash remap", "[perfect_hash]")
+{
+    std::vector<std::string> keys;
+    for(size_t i = 0; i < 1000; ++i)
+        keys.push_back("key/" + std::to_string(i));
+
+    uint32_t *table = nullptr;
+    size_t    len   = 0;
+    REQUIRE(build(&table, &len, keys) == 0);
+    vsc::vsc_ptr<uint32_t> _table(table);
+
+    /* Header, 250 bucket seeds, and 10 remap entries. */
+    CHECK(len == 5 + 250 + 10);
+    CHECK(vsc_perfect_hash_validate(table, len) == 0);
+    check_perfect(table, keys);
+
+    /* A remap entry pointing past the keys is rejected. */
+    std::vector<uint32_t> copy(table, table + len);
+    copy[len - 1] = 1000;
+    CHECK(vsc_perfect_hash_validate(copy.data(), len) == VSC_ERROR(EINVAL));
+}
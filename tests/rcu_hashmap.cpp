@@ -0,0 +1,162 @@
+#include <atomic>
+#include <thread>
+#include "common.hpp"
+
+struct rcudel {
+    using pointer = VscRcuHashMap *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_rcu_hashmap_free(p);
+    }
+};
+using rcuptr = std::unique_ptr<VscRcuHashMap, rcudel>;
+
+TEST_CASE("rcu hashmap", "[rcu_hashmap]")
+{
+    rcuptr map(vsc_rcu_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(map);
+
+    VscRcuHashMapReader *reader = vsc_rcu_hashmap_register_reader(map.get());
+    REQUIRE(reader != nullptr);
+
+    CHECK(vsc_rcu_hashmap_find(reader, make_key(1)) == nullptr);
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 0);
+
+    for(uintptr_t i = 1; i <= 100; ++i)
+        REQUIRE(vsc_rcu_hashmap_insert(map.get(), make_key(i), make_key(i * 2)) == 0);
+
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 100);
+
+    for(uintptr_t i = 1; i <= 100; ++i)
+        CHECK(vsc_rcu_hashmap_find(reader, make_key(i)) == make_key(i * 2));
+
+    /* Replace. */
+    CHECK(vsc_rcu_hashmap_insert(map.get(), make_key(1), make_key(5)) == 0);
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 100);
+    CHECK(vsc_rcu_hashmap_find(reader, make_key(1)) == make_key(5));
+
+    CHECK(vsc_rcu_hashmap_update(map.get(), make_key(101), nullptr) == 1);
+    CHECK(vsc_rcu_hashmap_update(map.get(), make_key(2), make_key(7)) == 0);
+    CHECK(vsc_rcu_hashmap_find(reader, make_key(2)) == make_key(7));
+
+    void *v = nullptr;
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(2), &v) == 0);
+    CHECK(v == make_key(7));
+    v = nullptr;
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(2), &v) == 1);
+    CHECK(v == nullptr);
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(3), nullptr) == 0);
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 98);
+    CHECK(vsc_rcu_hashmap_find(reader, make_key(2)) == nullptr);
+
+    vsc_rcu_hashmap_clear(map.get());
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 0);
+    CHECK(vsc_rcu_hashmap_find(reader, make_key(1)) == nullptr);
+
+    vsc_rcu_hashmap_unregister_reader(reader);
+
+    /* Readers are recycled. */
+    VscRcuHashMapReader *reader2 = vsc_rcu_hashmap_register_reader(map.get());
+    CHECK(reader2 == reader);
+    vsc_rcu_hashmap_unregister_reader(reader2);
+}
+
+TEST_CASE("rcu hashmap concurrent readers", "[rcu_hashmap]")
+{
+    constexpr size_t    num_readers = 4;
+    constexpr uintptr_t num_keys    = 256;
+
+    rcuptr map(vsc_rcu_hashmap_alloc(ptr_hashproc, ptr_compareproc));
+    REQUIRE(map);
+
+    /* Keys 1..num_keys always map to themselves, and are never removed. */
+    for(uintptr_t i = 1; i <= num_keys; ++i)
+        REQUIRE(vsc_rcu_hashmap_insert(map.get(), make_key(i), make_key(i)) == 0);
+
+    std::atomic<bool>        stop(false);
+    std::vector<size_t>      failures(num_readers, 0);
+    std::vector<std::thread> threads;
+
+    for(size_t t = 0; t < num_readers; ++t) {
+        threads.emplace_back([&map, &stop, &failures, t]() {
+            VscRcuHashMapReader *reader = vsc_rcu_hashmap_register_reader(map.get());
+            if(reader == nullptr) {
+                ++failures[t];
+                return;
+            }
+
+            while(!stop.load()) {
+                for(uintptr_t i = 1; i <= num_keys; ++i) {
+                    if(vsc_rcu_hashmap_find(reader, make_key(i)) != make_key(i))
+                        ++failures[t];
+                }
+            }
+
+            vsc_rcu_hashmap_unregister_reader(reader);
+        });
+    }
+
+    /* Churn other keys, forcing lots of snapshots to be retired. */
+    for(uintptr_t i = num_keys + 1; i <= num_keys + 2000; ++i) {
+        REQUIRE(vsc_rcu_hashmap_insert(map.get(), make_key(i), make_key(i)) == 0);
+        void *v = nullptr;
+        REQUIRE(vsc_rcu_hashmap_remove(map.get(), make_key(i), &v) == 0);
+        REQUIRE(v == make_key(i));
+    }
+
+    stop.store(true);
+    for(std::thread& t : threads)
+        t.join();
+
+    for(size_t t = 0; t < num_readers; ++t)
+        CHECK(failures[t] == 0);
+
+    vsc_rcu_hashmap_reclaim(map.get());
+    CHECK(vsc_rcu_hashmap_size(map.get()) == num_keys);
+}
+
+static bool fail_allocs = false;
+
+static int failing_alloc(void **ptr, size_t size, size_t alignment, VscAllocFlags flags, void *user)
+{
+    (void)user;
+    if(fail_allocs && !(flags & VSC_ALLOC_NOFAIL))
+        return VSC_ERROR(ENOMEM);
+
+    return vsc_xalloc_ex(vsclib_system_allocator, ptr, size, flags, alignment);
+}
+
+static void failing_free(void *p, void *user)
+{
+    (void)user;
+    vsc_xfree(vsclib_system_allocator, p);
+}
+
+static size_t failing_size(void *p, void *user)
+{
+    (void)user;
+    return vsclib_system_allocator->size(p, vsclib_system_allocator->user);
+}
+
+TEST_CASE("rcu hashmap failures", "[rcu_hashmap]")
+{
+    static const VscAllocator failing = {
+        failing_alloc, failing_free, failing_size, VSC_ALIGNOF(vsc_max_align_t), nullptr,
+    };
+
+    rcuptr map(vsc_rcu_hashmap_alloca(ptr_hashproc, ptr_compareproc, &failing));
+    REQUIRE(map);
+    REQUIRE(vsc_rcu_hashmap_insert(map.get(), make_key(1), make_key(2)) == 0);
+
+    /* The snapshot can't be copied, so nothing is removed, and we're told so. */
+    void *v     = nullptr;
+    fail_allocs = true;
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(1), &v) == VSC_ERROR(ENOMEM));
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(3), &v) == 1);
+    fail_allocs = false;
+
+    CHECK(v == nullptr);
+    CHECK(vsc_rcu_hashmap_size(map.get()) == 1);
+    CHECK(vsc_rcu_hashmap_remove(map.get(), make_key(1), &v) == 0);
+    CHECK(v == make_key(2));
+}
@@ -0,0 +1,156 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "common.hpp"
+
+struct stdel {
+    using pointer = VscStringTable *;
+    void operator()(pointer p) noexcept
+    {
+        vsc_string_table_free(p);
+    }
+};
+using stptr = std::unique_ptr<VscStringTable, stdel>;
+
+TEST_CASE("string table", "[string_table]")
+{
+    stptr st(vsc_string_table_alloc(0));
+    REQUIRE(st);
+
+    const char *a, *b, *c;
+    uint32_t    atom_a, atom_b, atom_c;
+
+    REQUIRE(vsc_string_table_intern_cstr(st.get(), "hello", &a, &atom_a) == 0);
+    REQUIRE(vsc_string_table_intern(st.get(), "hello, world", 5, &b, &atom_b) == 0);
+    REQUIRE(vsc_string_table_intern_cstr(st.get(), "world", &c, &atom_c) == 0);
+
+    /* Same string, same pointer and atom. */
+    CHECK(a == b);
+    CHECK(atom_a == atom_b);
+    CHECK(a != c);
+    CHECK(atom_a != atom_c);
+    CHECK(vsc_string_table_size(st.get()) == 2);
+
+    CHECK(std::string(a) == "hello");
+    CHECK(vsc_string_table_length(a) == 5);
+    CHECK(vsc_string_table_atom(a) == atom_a);
+
+    size_t len = 0;
+    CHECK(vsc_string_table_string(st.get(), atom_c, &len) == c);
+    CHECK(len == 5);
+    CHECK(vsc_string_table_string(st.get(), 2, nullptr) == nullptr);
+    CHECK(vsc_string_table_string(st.get(), VSC_STRING_TABLE_INVALID_ATOM, nullptr) == nullptr);
+
+    uint32_t atom;
+    CHECK(vsc_string_table_find(st.get(), "world", 5, &atom) == c);
+    CHECK(atom == atom_c);
+    CHECK(vsc_string_table_find(st.get(), "worl", 4, nullptr) == nullptr);
+    CHECK(vsc_string_table_size(st.get()) == 2);
+
+    /* Empty strings and embedded NULs. */
+    const char *e, *n;
+    REQUIRE(vsc_string_table_intern(st.get(), nullptr, 0, &e, nullptr) == 0);
+    CHECK(std::string(e).empty());
+    REQUIRE(vsc_string_table_intern(st.get(), "a\0b", 3, &n, nullptr) == 0);
+    CHECK(vsc_string_table_length(n) == 3);
+    CHECK(memcmp(n, "a\0b", 4) == 0);
+    CHECK(vsc_string_table_find(st.get(), "a", 1, nullptr) == nullptr);
+
+    CHECK(vsc_string_table_intern(st.get(), nullptr, 1, nullptr, nullptr) == VSC_ERROR(EINVAL));
+}
+
+TEST_CASE("string table as hashmap keys", "[string_table]")
+{
+    stptr st(vsc_string_table_alloc(0));
+    hmptr hm(vsc_hashmap_alloc(vsc_hashmap_default_hash, vsc_hashmap_default_compare));
+
+    const char *k1, *k2;
+    std::string s     = "key";
+    void       *value = &s;
+
+    REQUIRE(vsc_string_table_intern_cstr(st.get(), "key", &k1, nullptr) == 0);
+    REQUIRE(vsc_hashmap_insert(hm.get(), k1, value) == 0);
+
+    /* A different buffer with the same contents interns to the same key. */
+    REQUIRE(vsc_string_table_intern(st.get(), s.data(), s.size(), &k2, nullptr) == 0);
+    CHECK(vsc_hashmap_find(hm.get(), k2) == value);
+}
+
+TEST_CASE("string table bulk", "[string_table]")
+{
+    stptr st(vsc_string_table_alloc(0));
+
+    std::vector<std::string> strings;
+    for(size_t i = 0; i < 10000; ++i)
+        strings.push_back(std::to_string(i % 5000));
+
+    std::vector<const char *> ptrs;
+    std::vector<size_t>       lens;
+    for(const auto& s : strings) {
+        ptrs.push_back(s.c_str());
+        lens.push_back(s.size());
+    }
+
+    std::vector<const char *> out(strings.size());
+    std::vector<uint32_t>     atoms(strings.size());
+
+    REQUIRE(vsc_string_table_intern_bulk(st.get(), ptrs.data(), lens.data(), ptrs.size(), out.data(), atoms.data()) ==
+            0);
+    CHECK(vsc_string_table_size(st.get()) == 5000);
+
+    for(size_t i = 0; i < strings.size(); ++i) {
+        CHECK(strings[i] == out[i]);
+        CHECK(vsc_string_table_atom(out[i]) == atoms[i]);
+        CHECK(out[i] == out[i % 5000]);
+    }
+
+    /* NUL-terminated, and already interned. */
+    std::vector<const char *> out2(strings.size());
+    REQUIRE(vsc_string_table_intern_bulk(st.get(), ptrs.data(), nullptr, ptrs.size(), out2.data(), nullptr) == 0);
+    CHECK(out == out2);
+    CHECK(vsc_string_table_size(st.get()) == 5000);
+
+    /* Bigger than a chunk. */
+    std::string big(200000, 'x');
+    const char *bigp;
+    REQUIRE(vsc_string_table_intern(st.get(), big.data(), big.size(), &bigp, nullptr) == 0);
+    CHECK(big == bigp);
+}
+
+TEST_CASE("string table concurrent", "[string_table]")
+{
+    const size_t num_threads = 8;
+    const size_t per_thread  = 5000;
+
+    stptr st(vsc_string_table_alloc(VSC_STRING_TABLE_CONCURRENT));
+    REQUIRE(st);
+
+    /* Every thread interns the same strings, they should all agree. */
+    std::vector<std::thread>              threads;
+    std::vector<std::vector<const char *>> results(num_threads);
+    for(size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&st, &results, t, per_thread]() {
+            for(size_t i = 0; i < per_thread; ++i) {
+                std::string s = std::to_string((i + t * 7) % per_thread);
+                const char *p = nullptr;
+
+                (void)vsc_string_table_intern(st.get(), s.data(), s.size(), &p, nullptr);
+                results[t].push_back(p);
+            }
+        });
+    }
+
+    for(std::thread& t : threads)
+        t.join();
+
+    CHECK(vsc_string_table_size(st.get()) == per_thread);
+
+    for(size_t t = 0; t < num_threads; ++t) {
+        for(size_t i = 0; i < per_thread; ++i) {
+            const char *p = results[t][i];
+            REQUIRE(p != nullptr);
+            REQUIRE(p == vsc_string_table_string(st.get(), vsc_string_table_atom(p), nullptr));
+            REQUIRE(std::to_string((i + t * 7) % per_thread) == p);
+        }
+    }
+}
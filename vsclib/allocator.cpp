@@ -124,6 +124,17 @@ static int malloc_(void **ptr, size_t size, size_t alignment, VscAllocFlags flag
     vsc_assert(VSC_IS_ALIGNED(p, alignment));
     vsc_assert(VSC_IS_ALIGNED(nhdr, VSC_ALIGNOF(H)));
 
+    if(flags & VSC_ALLOC_REALLOC) {
+        /*
+         * If our alignment has increased, but we're still aligned our what we
+         * were before, the padding between the header/data may have changed. Account for this.
+         *
+         * This must be done before the header pointer is written, as it may overlap the old data.
+         */
+        if(shift != (reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(nhdr)))
+            memmove(p, reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(nhdr) + shift), oldsize);
+    }
+
     /*
      * For large alignments, store a pointer to the header immediately
      * before our data, so we don't have to scan backwards for the header.
@@ -139,15 +150,6 @@ static int malloc_(void **ptr, size_t size, size_t alignment, VscAllocFlags flag
     nhdr->reserved    = 0;
     nhdr->sig         = VSC__MEMHDR_SIG;
 
-    if(flags & VSC_ALLOC_REALLOC) {
-        /*
-         * If our alignment has increased, but we're still aligned our what we
-         * were before, the padding between the header/data may have changed. Account for this.
-         */
-        if(shift != (reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(nhdr)))
-            memmove(p, reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(nhdr) + shift), oldsize);
-    }
-
     if(flags & VSC_ALLOC_ZERO && nhdr->size > oldsize)
         memset(p + oldsize, 0, nhdr->size - oldsize);
 
@@ -0,0 +1,226 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_ATOMIC_INTERNAL_H
+#define _VSCLIB_ATOMIC_INTERNAL_H
+
+/*
+ * Minimal atomics for internal use.
+ *
+ * <stdatomic.h> isn't usable everywhere we need to build (i.e. MSVC), so wrap
+ * the compiler builtins instead. Only what's needed is provided.
+ *
+ * Loads are acquire, stores are release, and read-modify-write operations
+ * are sequentially consistent.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <vsclib/platform.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VSC_ATOMIC_MSVC 1
+#elif defined(__GNUC__)
+#define VSC_ATOMIC_MSVC 0
+#else
+#error No atomic builtins available, please fix your system
+#endif
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+/*
+ * Assume 64-byte cache lines. Close enough for padding purposes.
+ */
+#define VSC_CACHE_LINE_SIZE 64
+
+static inline uint32_t vsci_atomic_load_u32(const volatile uint32_t *p)
+{
+#if VSC_ATOMIC_MSVC
+    return (uint32_t)_InterlockedCompareExchange((volatile long *)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void vsci_atomic_store_u32(volatile uint32_t *p, uint32_t v)
+{
+#if VSC_ATOMIC_MSVC
+    (void)_InterlockedExchange((volatile long *)p, (long)v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline uint32_t vsci_atomic_xchg_u32(volatile uint32_t *p, uint32_t v)
+{
+#if VSC_ATOMIC_MSVC
+    return (uint32_t)_InterlockedExchange((volatile long *)p, (long)v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/*
+ * If *p == *expected, set *p to desired and return 1.
+ * Otherwise, store the current value of *p in *expected and return 0.
+ */
+static inline int vsci_atomic_cas_u32(volatile uint32_t *p, uint32_t *expected, uint32_t desired)
+{
+#if VSC_ATOMIC_MSVC
+    uint32_t old = (uint32_t)_InterlockedCompareExchange((volatile long *)p, (long)desired, (long)*expected);
+    if(old == *expected)
+        return 1;
+
+    *expected = old;
+    return 0;
+#else
+    return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline size_t vsci_atomic_load_size(const volatile size_t *p)
+{
+#if VSC_ATOMIC_MSVC && VSC_SIZEOF_SIZE_T == 8
+    return (size_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+#elif VSC_ATOMIC_MSVC
+    return (size_t)_InterlockedCompareExchange((volatile long *)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void vsci_atomic_store_size(volatile size_t *p, size_t v)
+{
+#if VSC_ATOMIC_MSVC && VSC_SIZEOF_SIZE_T == 8
+    (void)_InterlockedExchange64((volatile __int64 *)p, (__int64)v);
+#elif VSC_ATOMIC_MSVC
+    (void)_InterlockedExchange((volatile long *)p, (long)v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+/* Returns the previous value. */
+static inline size_t vsci_atomic_fetch_add_size(volatile size_t *p, size_t v)
+{
+#if VSC_ATOMIC_MSVC && VSC_SIZEOF_SIZE_T == 8
+    return (size_t)_InterlockedExchangeAdd64((volatile __int64 *)p, (__int64)v);
+#elif VSC_ATOMIC_MSVC
+    return (size_t)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+#else
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Returns the previous value. */
+static inline size_t vsci_atomic_fetch_sub_size(volatile size_t *p, size_t v)
+{
+    return vsci_atomic_fetch_add_size(p, (size_t)0 - v);
+}
+
+/*
+ * For counters where only the eventual total matters, so there's no ordering.
+ */
+static inline void vsci_atomic_add_relaxed_size(volatile size_t *p, size_t v)
+{
+#if VSC_ATOMIC_MSVC && VSC_SIZEOF_SIZE_T == 8
+    (void)_InterlockedExchangeAdd64((volatile __int64 *)p, (__int64)v);
+#elif VSC_ATOMIC_MSVC
+    (void)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+#else
+    (void)__atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline uint64_t vsci_atomic_load_u64(const volatile uint64_t *p)
+{
+#if VSC_ATOMIC_MSVC
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void vsci_atomic_store_u64(volatile uint64_t *p, uint64_t v)
+{
+#if VSC_ATOMIC_MSVC
+    /* There's no 64-bit exchange on 32-bit x86. */
+    __int64 old = _InterlockedCompareExchange64((volatile __int64 *)p, 0, 0), prev;
+
+    while((prev = _InterlockedCompareExchange64((volatile __int64 *)p, (__int64)v, old)) != old)
+        old = prev;
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline void *vsci_atomic_load_ptr(void *const volatile *p)
+{
+#if VSC_ATOMIC_MSVC
+    return _InterlockedCompareExchangePointer((void *volatile *)p, NULL, NULL);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void vsci_atomic_store_ptr(void *volatile *p, void *v)
+{
+#if VSC_ATOMIC_MSVC
+    (void)_InterlockedExchangePointer(p, v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline void *vsci_atomic_xchg_ptr(void *volatile *p, void *v)
+{
+#if VSC_ATOMIC_MSVC
+    return _InterlockedExchangePointer(p, v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void vsci_atomic_fence(void)
+{
+#if VSC_ATOMIC_MSVC
+    MemoryBarrier();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/*
+ * Hint to the CPU that we're spinning.
+ */
+static inline void vsci_cpu_relax(void)
+{
+#if defined(_WIN32)
+    YieldProcessor();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#endif /* _VSCLIB_ATOMIC_INTERNAL_H */
@@ -0,0 +1,266 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Split-block Bloom filter.
+ *
+ * Serialised form, everything little-endian:
+ *   [ 0] char[8]  magic, "VSCBLOOM"
+ *   [ 8] uint32_t version, 2
+ *   [12] uint32_t reserved, 0
+ *   [16] uint64_t number of blocks
+ *   [24] uint64_t reserved, 0
+ *   [32] uint32_t[8] for each block
+ */
+#include <string.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/hash.h>
+#include <vsclib/io.h>
+#include <vsclib/mem.h>
+#include <vsclib/bloom_filter.h>
+
+#define BLOOM_MAGIC       "VSCBLOOM"
+#define BLOOM_VERSION     2
+#define BLOOM_HEADER_SIZE 32
+#define BLOOM_BLOCK_BITS  256
+
+typedef struct BloomBlock {
+    uint32_t words[8];
+} BloomBlock;
+
+struct VscBloomFilter {
+    size_t              num_blocks;
+    BloomBlock         *blocks;
+    const VscAllocator *allocator;
+};
+
+/*
+ * Odd constants, one per word. Multiplying the key by each and keeping the
+ * top 5 bits picks a bit in each word.
+ */
+static const uint32_t bloom_salts[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+static inline void validate(const VscBloomFilter *bf)
+{
+    (void)bf;
+    vsc_assert(bf != NULL);
+    vsc_assert(bf->num_blocks > 0);
+    vsc_assert(bf->num_blocks <= UINT32_MAX);
+    vsc_assert(bf->blocks != NULL);
+    vsc_assert(bf->allocator != NULL);
+}
+
+/*
+ * Spread a hash over 64 bits. The top half picks the block, the bottom half the bits. * Always mixed, as map hashes can be weak, e.g. vsc_hashmap_default_hash() on pointers.
+ */
+static inline uint64_t widen(vsc_hash_t hash)
+{
+    uint64_t h = (uint64_t)hash * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 29);
+}
+
+static inline BloomBlock *block_of(const VscBloomFilter *bf, uint64_t h)
+{
+    /* Fast range reduction, avoids a division. */
+    return bf->blocks + (size_t)(((h >> 32) * bf->num_blocks) >> 32);
+}
+
+static inline void make_mask(uint32_t key, uint32_t mask[8])
+{
+    for(size_t i = 0; i < 8; ++i)
+        mask[i] = UINT32_C(1) << ((key * bloom_salts[i]) >> 27);
+}
+
+static VscBloomFilter *alloc_blocks(size_t num_blocks, const VscAllocator *a)
+{
+    void             *ptrs[2];
+    VscBloomFilter   *bf;
+    VscBlockAllocInfo bai[2] = {
+        {1,          sizeof(VscBloomFilter), VSC_ALIGNOF(VscBloomFilter), NULL},
+        {num_blocks, sizeof(BloomBlock),     sizeof(BloomBlock),          NULL},
+    };
+
+    if(num_blocks == 0 || num_blocks > UINT32_MAX || num_blocks > SIZE_MAX / sizeof(BloomBlock))
+        return NULL;
+
+    if(vsc_block_xalloc(a, ptrs, bai, 2, VSC_ALLOC_ZERO) < 0)
+        return NULL;
+
+    bf  = ptrs[0];
+    *bf = (VscBloomFilter){
+        .num_blocks = num_blocks,
+        .blocks     = ptrs[1],
+        .allocator  = a,
+    };
+    return bf;
+}
+
+VscBloomFilter *vsc_bloom_filter_alloca(size_t capacity, size_t bits_per_key, const VscAllocator *a)
+{
+    size_t num_blocks;
+
+    vsc_assert(a != NULL);
+
+    if(bits_per_key == 0)
+        return NULL;
+
+    capacity = VSC_MAX(capacity, 1);
+    if(capacity > SIZE_MAX / bits_per_key)
+        return NULL;
+
+    num_blocks = (capacity * bits_per_key + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+    return alloc_blocks(num_blocks, a);
+}
+
+VscBloomFilter *vsc_bloom_filter_alloc(size_t capacity, size_t bits_per_key)
+{
+    return vsc_bloom_filter_alloca(capacity, bits_per_key, vsclib_system_allocator);
+}
+
+void vsc_bloom_filter_free(VscBloomFilter *bf)
+{
+    validate(bf);
+    vsc_xfree(bf->allocator, bf);
+}
+
+void vsc_bloom_filter_clear(VscBloomFilter *bf)
+{
+    validate(bf);
+    memset(bf->blocks, 0, sizeof(BloomBlock) * bf->num_blocks);
+}
+
+void vsc_bloom_filter_insert_hash(VscBloomFilter *bf, vsc_hash_t hash)
+{
+    uint64_t    h = widen(hash);
+    BloomBlock *b;
+    uint32_t    mask[8];
+
+    validate(bf);
+
+    b = block_of(bf, h);
+    make_mask((uint32_t)h, mask);
+
+    for(size_t i = 0; i < 8; ++i)
+        b->words[i] |= mask[i];
+}
+
+int vsc_bloom_filter_contains_hash(const VscBloomFilter *bf, vsc_hash_t hash)
+{
+    uint64_t          h = widen(hash);
+    const BloomBlock *b;
+    uint32_t          mask[8], missing = 0;
+
+    validate(bf);
+
+    b = block_of(bf, h);
+    make_mask((uint32_t)h, mask);
+
+    /* No early exit, so this vectorises. */
+    for(size_t i = 0; i < 8; ++i)
+        missing |= mask[i] & ~b->words[i];
+
+    return missing == 0;
+}
+
+void vsc_bloom_filter_insert(VscBloomFilter *bf, const void *data, size_t size)
+{
+    vsc_bloom_filter_insert_hash(bf, vsc_hash(data, size));
+}
+
+int vsc_bloom_filter_contains(const VscBloomFilter *bf, const void *data, size_t size)
+{
+    return vsc_bloom_filter_contains_hash(bf, vsc_hash(data, size));
+}
+
+size_t vsc_bloom_filter_bits(const VscBloomFilter *bf)
+{
+    validate(bf);
+    return bf->num_blocks * BLOOM_BLOCK_BITS;
+}
+
+int vsc_bloom_filter_write(const VscBloomFilter *bf, FILE *f)
+{
+    uint8_t hdr[BLOOM_HEADER_SIZE];
+
+    validate(bf);
+
+    if(f == NULL)
+        return VSC_ERROR(EINVAL);
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr + 0, BLOOM_MAGIC, 8);
+    vsc_write_leu32(hdr + 8, BLOOM_VERSION);
+    vsc_write_leu64(hdr + 16, bf->num_blocks);
+
+    if(fwrite(hdr, sizeof(hdr), 1, f) != 1)
+        return VSC_ERROR(EIO);
+
+    for(size_t i = 0; i < bf->num_blocks; ++i) {
+        uint8_t buf[sizeof(BloomBlock)];
+
+        for(size_t j = 0; j < 8; ++j)
+            vsc_write_leu32(buf + j * 4, bf->blocks[i].words[j]);
+
+        if(fwrite(buf, sizeof(buf), 1, f) != 1)
+            return VSC_ERROR(EIO);
+    }
+
+    return 0;
+}
+
+int vsc_bloom_filter_loada(VscBloomFilter **bf, const void *data, size_t size, const VscAllocator *a)
+{
+    const uint8_t  *p = data;
+    VscBloomFilter *_bf;
+    uint64_t        num_blocks;
+
+    if(bf == NULL || a == NULL)
+        return VSC_ERROR(EINVAL);
+
+    if(p == NULL || size < BLOOM_HEADER_SIZE)
+        return VSC_ERROR(EINVAL);
+
+    if(memcmp(p, BLOOM_MAGIC, 8) != 0 || vsc_read_leu32(p + 8) != BLOOM_VERSION)
+        return VSC_ERROR(EINVAL);
+
+    num_blocks = vsc_read_leu64(p + 16);
+    if(num_blocks == 0 || num_blocks > (size - BLOOM_HEADER_SIZE) / sizeof(BloomBlock))
+        return VSC_ERROR(EINVAL);
+
+    if((_bf = alloc_blocks((size_t)num_blocks, a)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    p += BLOOM_HEADER_SIZE;
+    for(size_t i = 0; i < _bf->num_blocks; ++i) {
+        for(size_t j = 0; j < 8; ++j, p += 4)
+            _bf->blocks[i].words[j] = vsc_read_leu32(p);
+    }
+
+    *bf = _bf;
+    return 0;
+}
+
+int vsc_bloom_filter_load(VscBloomFilter **bf, const void *data, size_t size)
+{
+    return vsc_bloom_filter_loada(bf, data, size, vsclib_system_allocator);
+}
@@ -0,0 +1,915 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/macros.h>
+#include <vsclib/time.h>
+#include <vsclib/clock_cache.h>
+#include "lock_internal.h"
+
+#define VSC_CLOCK_CACHE_NIL UINT32_MAX
+
+/* Index slots hold an entry index + 1, so 0 is empty. */
+#define VSC_CLOCK_CACHE_TOMBSTONE UINT32_MAX
+
+/* Lookups are spread over this many reader stripes per shard, see get_stripe(). */
+#define VSC_CLOCK_CACHE_STRIPE_BITS 4
+#define VSC_CLOCK_CACHE_STRIPES     (1u << VSC_CLOCK_CACHE_STRIPE_BITS)
+
+/* The most entries handed to the eviction procedure per unlock. */
+#define VSC_CLOCK_CACHE_BATCH 32
+
+typedef struct VscClockCacheEntry {
+    /* Read by lookups without the lock, so always accessed atomically. */
+    volatile size_t   hash;
+    void *volatile    key;
+    void *volatile    value;
+    volatile uint64_t expires; /* 0 if never. */
+    volatile uint32_t referenced;
+
+    /* Only ever touched with the lock held. */
+    uint32_t next_free;
+    uint8_t  used;
+    uint8_t  evict; /* Once dropped, is it owed to the eviction procedure? */
+} VscClockCacheEntry;
+
+/*
+ * Everything a lookup writes to. Threads mostly get a stripe to themselves,
+ * so these lines aren't bounced between them.
+ */
+typedef struct VscClockCacheStripe {
+    volatile size_t readers[2];
+
+    /* Only the eventual totals matter, so relaxed atomics. */
+    volatile size_t hits;
+    volatile size_t misses;
+} VscClockCacheStripe;
+
+typedef union VscClockCacheStripeSlot {
+    VscClockCacheStripe stripe;
+    char _pad[(sizeof(VscClockCacheStripe) + VSC_CACHE_LINE_SIZE - 1) / VSC_CACHE_LINE_SIZE * VSC_CACHE_LINE_SIZE];
+} VscClockCacheStripeSlot;
+
+typedef struct VscClockCacheShard {
+    VscLock  lock;
+    uint32_t size;
+    uint32_t hand;
+    uint32_t free_list;
+
+    /*
+     * Lookups don't take the lock. They count themselves in their stripe's reader
+     * count for the current period instead. Dropped entries aren't reused, nor
+     * handed to the eviction procedure, until every lookup that may have seen
+     * them has finished. Nothing waits for this, it's checked in passing:
+     *
+     * - `pending` entries were dropped since the period last flipped,
+     * - `retired` entries were dropped before that, and wait for the old
+     *   period's readers to drain,
+     * - `ready` entries are safe, and are released a batch at a time.
+     *
+     * Every flip bumps `flips`, and `grace` catches up once the old period has
+     * drained. So, anything dropped while `flips` was `f` is safe once
+     * `grace > f`. See reclaim().
+     */
+    volatile uint32_t        period;
+    VscClockCacheStripeSlot *stripes;
+    uint64_t                 flips;
+    uint64_t                 grace;
+    uint32_t                 pending;
+    uint32_t                 retired;
+    uint32_t                 ready;
+
+    /*
+     * Open-addressed, maps keys to entry index + 1. Removing leaves a tombstone,
+     * so nothing moves under a lookup. Once they build up, the live entries are
+     * copied to the spare, which is swapped in. The old one becomes the spare
+     * once `grace` reaches `spare_grace`.
+     */
+    uint32_t *volatile index;
+    uint32_t          *spare;
+    uint64_t           spare_grace;
+    size_t             index_mask;
+    size_t             tombstones;
+
+    VscClockCacheEntry *entries;
+
+    /*
+     * VSC_CLOCK_CACHE_DOORKEEPER
+     * Tags of keys refused admission, indexed by hash. 0 is empty.
+     */
+    uint32_t *ghosts;
+
+    /* The hits and misses are kept in the stripes. */
+    VscClockCacheStats stats;
+} VscClockCacheShard;
+
+/* Each shard gets its own cache lines, see VscHashMapShard. */
+typedef union VscClockCacheShardSlot {
+    VscClockCacheShard shard;
+    char _pad[(sizeof(VscClockCacheShard) + VSC_CACHE_LINE_SIZE - 1) / VSC_CACHE_LINE_SIZE * VSC_CACHE_LINE_SIZE];
+} VscClockCacheShardSlot;
+
+struct VscClockCache {
+    size_t                  num_shards;
+    unsigned int            shard_shift;
+    uint32_t                shard_capacity;
+    VscClockCacheShardSlot *shards;
+
+    VscHashMapHashProc     hash_proc;
+    VscHashMapCompareProc  compare_proc;
+    VscClockCacheEvictProc evict_proc;
+    void                  *user;
+    const VscAllocator    *allocator;
+};
+
+/* An entry that's been dropped, but whose eviction procedure hasn't been called yet. */
+typedef struct Dropped {
+    const void *key;
+    void       *value;
+    int         valid;
+} Dropped;
+
+/* Safe entries released by reclaim(), to be handed over once unlocked. */
+typedef struct Released {
+    size_t  count;
+    Dropped entries[VSC_CLOCK_CACHE_BATCH];
+} Released;
+
+static inline void validate(const VscClockCache *cache)
+{
+    (void)cache;
+    vsc_assert(cache != NULL);
+    vsc_assert(cache->num_shards > 0);
+    vsc_assert(VSC_IS_POT(cache->num_shards));
+    vsc_assert(cache->shard_capacity > 0);
+    vsc_assert(cache->shards != NULL);
+    vsc_assert(cache->hash_proc != NULL);
+    vsc_assert(cache->compare_proc != NULL);
+    vsc_assert(cache->allocator != NULL);
+}
+
+/* As with VscConcurrentHashMap, mix the hash so the high bits are worth using. */
+static inline VscClockCacheShard *get_shard(const VscClockCache *cache, vsc_hash_t hash)
+{
+    if(cache->num_shards == 1)
+        return &cache->shards[0].shard;
+
+#if VSC_SIZEOF_SIZE_T > 4
+    hash *= (vsc_hash_t)UINT64_C(0x9E3779B97F4A7C15);
+#else
+    hash *= (vsc_hash_t)UINT32_C(0x9E3779B9);
+#endif
+
+    return &cache->shards[hash >> cache->shard_shift].shard;
+}
+
+/*
+ * Pick the calling thread's stripe. There's no portable thread-local storage,
+ * so go by the stack instead. Threads' stacks are far apart and a thread's own
+ * frames are close together, so this spreads threads out well enough. Nothing
+ * relies on it being stable, lookups remember the stripe they counted themselves in.
+ */
+static inline VscClockCacheStripe *get_stripe(const VscClockCacheShard *shard)
+{
+    char       probe;
+    vsc_hash_t h = (vsc_hash_t)((uintptr_t)&probe >> 16);
+
+#if VSC_SIZEOF_SIZE_T > 4
+    h *= (vsc_hash_t)UINT64_C(0x9E3779B97F4A7C15);
+#else
+    h *= (vsc_hash_t)UINT32_C(0x9E3779B9);
+#endif
+
+    return &shard->stripes[h >> (VSC_SIZE_T_BITSIZE - VSC_CLOCK_CACHE_STRIPE_BITS)].stripe;
+}
+
+static inline vsc_hash_t hash_key(const VscClockCache *cache, const void *key)
+{
+    vsc_hash_t hash = cache->hash_proc(key);
+    vsc_assert(hash != VSC_INVALID_HASH);
+    return hash;
+}
+
+static inline uint32_t make_ghost(vsc_hash_t hash)
+{
+    uint32_t tag;
+
+#if VSC_SIZEOF_SIZE_T > 4
+    tag = (uint32_t)(hash ^ (hash >> 32));
+#else
+    tag = (uint32_t)hash;
+#endif
+
+    return tag != 0 ? tag : 1;
+}
+
+static inline int is_expired(const VscClockCacheEntry *e, vsc_counter_t *now)
+{
+    uint64_t expires = vsci_atomic_load_u64(&e->expires);
+
+    if(expires == 0)
+        return 0;
+
+    /* Only read the clock if something can actually expire. */
+    if(*now == 0)
+        *now = vsc_counter_ns();
+
+    return *now >= expires;
+}
+
+static inline void call_evict(const VscClockCache *cache, const Dropped *d)
+{
+    if(d->valid && cache->evict_proc != NULL)
+        cache->evict_proc(d->key, d->value, cache->user);
+}
+
+static void call_evict_released(const VscClockCache *cache, Released *r)
+{
+    for(size_t i = 0; i < r->count; ++i)
+        call_evict(cache, r->entries + i);
+
+    r->count = 0;
+}
+
+static inline uint32_t read_begin(VscClockCacheShard *shard, VscClockCacheStripe *stripe)
+{
+    for(;;) {
+        uint32_t period = vsci_atomic_load_u32(&shard->period);
+
+        (void)vsci_atomic_fetch_add_size(&stripe->readers[period], 1);
+
+        /* Pairs with the fence in drained(). */
+        vsci_atomic_fence();
+
+        /*
+         * If the period flipped in the meantime, drained() may already have
+         * seen this count at zero. Only readers that saw their own period after
+         * counting themselves are waited for, so try again.
+         */
+        if(vsci_atomic_load_u32(&shard->period) == period)
+            return period;
+
+        (void)vsci_atomic_fetch_sub_size(&stripe->readers[period], 1);
+    }
+}
+
+static inline void read_end(VscClockCacheStripe *stripe, uint32_t period)
+{
+    (void)vsci_atomic_fetch_sub_size(&stripe->readers[period], 1);
+}
+
+/*
+ * Have all the lookups counted in `period` finished? Lookups that start
+ * afterwards will see anything already written. The lock must be held.
+ */
+static int drained(const VscClockCacheShard *shard, uint32_t period)
+{
+    /* Pairs with the fence in read_begin(). */
+    vsci_atomic_fence();
+
+    for(size_t i = 0; i < VSC_CLOCK_CACHE_STRIPES; ++i) {
+        if(vsci_atomic_load_size(&shard->stripes[i].stripe.readers[period]) != 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Put the list starting at `head` in front of `*list`. The lock must be held. */
+static void splice(VscClockCacheShard *shard, uint32_t head, uint32_t *list)
+{
+    uint32_t tail = head;
+
+    if(head == VSC_CLOCK_CACHE_NIL)
+        return;
+
+    while(shard->entries[tail].next_free != VSC_CLOCK_CACHE_NIL)
+        tail = shard->entries[tail].next_free;
+
+    shard->entries[tail].next_free = *list;
+    *list                          = head;
+}
+
+/* If the old period has drained, the retired entries are safe. The lock must be held. */
+static void try_drain(VscClockCacheShard *shard)
+{
+    if(shard->grace == shard->flips || !drained(shard, shard->period ^ 1))
+        return;
+
+    shard->grace = shard->flips;
+    splice(shard, shard->retired, &shard->ready);
+    shard->retired = VSC_CLOCK_CACHE_NIL;
+}
+
+/*
+ * Return safe entries to the free list, noting which are owed to the
+ * eviction procedure in `out`. Stops early if that fills up.
+ * The lock must be held.
+ */
+static void release_ready(VscClockCacheShard *shard, Released *out)
+{
+    while(shard->ready != VSC_CLOCK_CACHE_NIL) {
+        uint32_t            index = shard->ready;
+        VscClockCacheEntry *e     = shard->entries + index;
+
+        if(e->evict) {
+            if(out->count == VSC_CLOCK_CACHE_BATCH)
+                break;
+
+            out->entries[out->count++] = (Dropped){.key = e->key, .value = e->value, .valid = 1};
+        }
+
+        shard->ready     = e->next_free;
+        e->next_free     = shard->free_list;
+        shard->free_list = index;
+    }
+}
+
+/*
+ * Move dropped entries along, without waiting for any lookups. If `force`, the
+ * period is flipped even if nothing is pending, so something dropped outside the
+ * lists (i.e. a replaced key) can become safe. If `out` isn't NULL, safe entries
+ * are released into it. The lock must be held.
+ */
+static void reclaim(VscClockCacheShard *shard, int force, Released *out)
+{
+    try_drain(shard);
+
+    /* Only flip once the last one has drained, or its stragglers would be lost track of. */
+    if(shard->grace == shard->flips && (shard->pending != VSC_CLOCK_CACHE_NIL || force)) {
+        vsci_atomic_store_u32(&shard->period, shard->period ^ 1);
+        ++shard->flips;
+        shard->retired = shard->pending;
+        shard->pending = VSC_CLOCK_CACHE_NIL;
+
+        /* Usually nobody's looking, so don't leave it for next time. */
+        try_drain(shard);
+    }
+
+    if(out != NULL)
+        release_ready(shard, out);
+}
+
+/*
+ * Wait until `grace > f`, i.e. every lookup that may have seen something dropped
+ * while `flips` was `f` has finished, and nothing is left ready. The lock must not
+ * be held, it's only taken in between checks.
+ */
+static void wait_grace(const VscClockCache *cache, VscClockCacheShard *shard, uint64_t f)
+{
+    Released out = {.count = 0};
+    int      done;
+
+    for(;;) {
+        vsci_lock_acquire(&shard->lock);
+        reclaim(shard, 1, &out);
+        done = shard->grace > f && shard->ready == VSC_CLOCK_CACHE_NIL;
+        vsci_lock_release(&shard->lock);
+
+        call_evict_released(cache, &out);
+        if(done)
+            return;
+
+        vsci_cpu_relax();
+    }
+}
+
+/*
+ * Find an entry, returning its index or VSC_CLOCK_CACHE_NIL.
+ * This is safe without the lock, between read_begin() and read_end().
+ */
+static uint32_t find_entry(const VscClockCache *cache, const VscClockCacheShard *shard, const void *key,
+                           vsc_hash_t hash)
+{
+    const uint32_t *index = vsci_atomic_load_ptr((void *const volatile *)&shard->index);
+    size_t          mask  = shard->index_mask;
+
+    for(size_t i = hash & mask, n = 0; n <= mask; i = (i + 1) & mask, ++n) {
+        const VscClockCacheEntry *e;
+        uint32_t                  slot = vsci_atomic_load_u32(index + i);
+
+        if(slot == 0)
+            break;
+
+        if(slot == VSC_CLOCK_CACHE_TOMBSTONE)
+            continue;
+
+        e = shard->entries + (slot - 1);
+        if(vsci_atomic_load_size(&e->hash) == hash && cache->compare_proc(key, vsci_atomic_load_ptr(&e->key)))
+            return slot - 1;
+    }
+
+    return VSC_CLOCK_CACHE_NIL;
+}
+
+/* Find the index slot pointing at an entry. The lock must be held. */
+static size_t find_slot(const VscClockCacheShard *shard, uint32_t entry)
+{
+    size_t mask = shard->index_mask, i;
+
+    for(i = shard->entries[entry].hash & mask; shard->index[i] != entry + 1; i = (i + 1) & mask)
+        vsc_assert(shard->index[i] != 0);
+
+    return i;
+}
+
+/*
+ * Copy the live entries into the spare index, and swap it in.
+ * The lock must be held.
+ */
+static void rebuild_index(VscClockCacheShard *shard, uint32_t capacity)
+{
+    uint32_t *old = shard->index, *index = shard->spare;
+    size_t    mask = shard->index_mask;
+
+    /*
+     * Lookups may still be walking the spare from the last rebuild. That's at
+     * least a few hundred writes ago, so this hardly ever has to wait.
+     */
+    while(shard->grace < shard->spare_grace) {
+        reclaim(shard, 1, NULL);
+        vsci_cpu_relax();
+    }
+
+    for(size_t i = 0; i <= mask; ++i)
+        index[i] = 0;
+
+    for(uint32_t j = 0; j < capacity; ++j) {
+        size_t i;
+
+        if(!shard->entries[j].used)
+            continue;
+
+        for(i = shard->entries[j].hash & mask; index[i] != 0; i = (i + 1) & mask)
+            ;
+
+        index[i] = j + 1;
+    }
+
+    vsci_atomic_store_ptr((void *volatile *)&shard->index, index);
+    shard->tombstones = 0;
+
+    shard->spare       = old;
+    shard->spare_grace = shard->flips + 1;
+}
+
+/*
+ * Add an entry to the index. It must not be marked as used yet, nor its key
+ * already be present. The lock must be held.
+ */
+static void insert_slot(VscClockCacheShard *shard, uint32_t capacity, uint32_t entry)
+{
+    size_t mask = shard->index_mask, i;
+
+    /* Keep empty slots at 1/4 or more, so misses stay short. */
+    if(shard->size + shard->tombstones + 1 > mask + 1 - (mask + 1) / 4)
+        rebuild_index(shard, capacity);
+
+    for(i = shard->entries[entry].hash & mask;; i = (i + 1) & mask) {
+        uint32_t slot = shard->index[i];
+
+        if(slot == VSC_CLOCK_CACHE_TOMBSTONE) {
+            --shard->tombstones;
+            break;
+        }
+
+        if(slot == 0)
+            break;
+    }
+
+    vsci_atomic_store_u32(shard->index + i, entry + 1);
+}
+
+/*
+ * Drop an entry. It's parked on the pending list until no lookup can still see
+ * it, see reclaim(). If `evict`, the eviction procedure is invoked on it then.
+ * The lock must be held.
+ */
+static void drop_entry(VscClockCacheShard *shard, uint32_t index, int evict)
+{
+    VscClockCacheEntry *e = shard->entries + index;
+
+    vsci_atomic_store_u32(shard->index + find_slot(shard, index), VSC_CLOCK_CACHE_TOMBSTONE);
+    ++shard->tombstones;
+
+    /* The key and value are left alone, a lookup may be about to compare them. */
+    e->used        = 0;
+    e->evict       = (uint8_t)(evict != 0);
+    e->next_free   = shard->pending;
+    shard->pending = index;
+    --shard->size;
+}
+
+/*
+ * Advance the hand until it finds something to evict. This takes at most two
+ * laps, as every referenced entry is cleared on the first.
+ */
+static void evict_one(VscClockCacheShard *shard, uint32_t capacity, vsc_counter_t *now)
+{
+    for(;;) {
+        uint32_t            index = shard->hand;
+        VscClockCacheEntry *e     = shard->entries + index;
+
+        shard->hand = (index + 1) % capacity;
+
+        if(!e->used)
+            continue;
+
+        if(is_expired(e, now)) {
+            ++shard->stats.expirations;
+            drop_entry(shard, index, 1);
+            return;
+        }
+
+        if(vsci_atomic_load_u32(&e->referenced)) {
+            vsci_atomic_store_u32(&e->referenced, 0);
+            continue;
+        }
+
+        ++shard->stats.evictions;
+        drop_entry(shard, index, 1);
+        return;
+    }
+}
+
+VscClockCache *vsc_clock_cache_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t capacity,
+                                      size_t num_shards, uint32_t flags, VscClockCacheEvictProc evict, void *user,
+                                      const VscAllocator *a)
+{
+    VscClockCache *cache;
+    void          *ptrs[6];
+    size_t         shard_capacity, total, index_size;
+    int            r;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(compare != NULL);
+    vsc_assert(a != NULL);
+
+    if(num_shards == 0)
+        num_shards = VSC_CLOCK_CACHE_DEFAULT_SHARDS;
+
+    if(capacity == 0 || !VSC_IS_POT(num_shards))
+        return NULL;
+
+    shard_capacity = capacity / num_shards + (capacity % num_shards != 0);
+    if(shard_capacity >= VSC_CLOCK_CACHE_NIL || shard_capacity > SIZE_MAX / 4 / num_shards)
+        return NULL;
+
+    total = shard_capacity * num_shards;
+
+    /* Two indices per shard, each at least twice the capacity. */
+    for(index_size = 16; index_size < shard_capacity * 2; index_size *= 2)
+        ;
+
+    if(index_size > SIZE_MAX / 2 / num_shards / sizeof(uint32_t))
+        return NULL;
+
+    VscBlockAllocInfo bai[6] = {
+        {1,                  sizeof(VscClockCache),          VSC_ALIGNOF(VscClockCache),      NULL},
+        {num_shards,         sizeof(VscClockCacheShardSlot), VSC_CACHE_LINE_SIZE,             NULL},
+        {total,              sizeof(VscClockCacheEntry),     VSC_ALIGNOF(VscClockCacheEntry), NULL},
+        {(flags & VSC_CLOCK_CACHE_DOORKEEPER) ? total : 0, sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {num_shards * 2 * index_size, sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {num_shards * VSC_CLOCK_CACHE_STRIPES, sizeof(VscClockCacheStripeSlot), VSC_CACHE_LINE_SIZE, NULL},
+    };
+
+    if((r = vsc_block_xalloc(a, ptrs, bai, 6, VSC_ALLOC_ZERO)) < 0)
+        return NULL;
+
+    cache  = ptrs[0];
+    *cache = (VscClockCache){
+        .num_shards     = num_shards,
+        .shard_shift    = VSC_SIZE_T_BITSIZE - vsc_ctz(num_shards),
+        .shard_capacity = (uint32_t)shard_capacity,
+        .shards         = ptrs[1],
+        .hash_proc      = hash,
+        .compare_proc   = compare,
+        .evict_proc     = evict,
+        .user           = user,
+        .allocator      = a,
+    };
+
+    for(size_t i = 0; i < num_shards; ++i) {
+        VscClockCacheShard *shard = &cache->shards[i].shard;
+
+        shard->lock        = (VscLock)VSC_LOCK_INIT;
+        shard->size        = 0;
+        shard->hand        = 0;
+        shard->free_list   = 0;
+        shard->period      = 0;
+        shard->stripes     = (VscClockCacheStripeSlot *)ptrs[5] + i * VSC_CLOCK_CACHE_STRIPES;
+        shard->flips       = 0;
+        shard->grace       = 0;
+        shard->pending     = VSC_CLOCK_CACHE_NIL;
+        shard->retired     = VSC_CLOCK_CACHE_NIL;
+        shard->ready       = VSC_CLOCK_CACHE_NIL;
+        shard->index       = (uint32_t *)ptrs[4] + (i * 2) * index_size;
+        shard->spare       = (uint32_t *)ptrs[4] + (i * 2 + 1) * index_size;
+        shard->spare_grace = 0;
+        shard->index_mask  = index_size - 1;
+        shard->tombstones  = 0;
+        shard->entries     = (VscClockCacheEntry *)ptrs[2] + i * shard_capacity;
+        shard->ghosts      = ptrs[3] != NULL ? (uint32_t *)ptrs[3] + i * shard_capacity : NULL;
+
+        for(uint32_t j = 0; j < shard_capacity; ++j)
+            shard->entries[j].next_free = j + 1 < shard_capacity ? j + 1 : VSC_CLOCK_CACHE_NIL;
+    }
+
+    return cache;
+}
+
+VscClockCache *vsc_clock_cache_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t capacity,
+                                     size_t num_shards, uint32_t flags, VscClockCacheEvictProc evict, void *user)
+{
+    return vsc_clock_cache_alloca(hash, compare, capacity, num_shards, flags, evict, user, vsclib_system_allocator);
+}
+
+void vsc_clock_cache_free(VscClockCache *cache)
+{
+    if(cache == NULL)
+        return;
+
+    validate(cache);
+
+    vsc_clock_cache_clear(cache);
+    vsc_xfree(cache->allocator, cache);
+}
+
+size_t vsc_clock_cache_capacity(const VscClockCache *cache)
+{
+    validate(cache);
+    return cache->shard_capacity * cache->num_shards;
+}
+
+void *vsc_clock_cache_get(VscClockCache *cache, const void *key)
+{
+    VscClockCacheShard  *shard;
+    VscClockCacheStripe *stripe;
+    VscClockCacheEntry  *e;
+    vsc_hash_t           hash;
+    vsc_counter_t        now = 0;
+    uint32_t             period, index;
+    int                  expired = 0;
+    void                *value   = NULL;
+    Released             out     = {.count = 0};
+
+    validate(cache);
+
+    hash   = hash_key(cache, key);
+    shard  = get_shard(cache, hash);
+    stripe = get_stripe(shard);
+
+    period = read_begin(shard, stripe);
+
+    if((index = find_entry(cache, shard, key, hash)) != VSC_CLOCK_CACHE_NIL) {
+        e = shard->entries + index;
+
+        if(!(expired = is_expired(e, &now))) {
+            /* This is all a hit does, nothing's reordered. Don't dirty the line if it's already set. */
+            if(!vsci_atomic_load_u32(&e->referenced))
+                vsci_atomic_store_u32(&e->referenced, 1);
+
+            value = vsci_atomic_load_ptr(&e->value);
+        }
+    }
+
+    read_end(stripe, period);
+
+    if(index != VSC_CLOCK_CACHE_NIL && !expired) {
+        vsci_atomic_add_relaxed_size(&stripe->hits, 1);
+        return value;
+    }
+
+    vsci_atomic_add_relaxed_size(&stripe->misses, 1);
+
+    if(!expired)
+        return NULL;
+
+    /* Only now is the lock needed, to drop it. Someone may have beaten us to it. */
+    vsci_lock_acquire(&shard->lock);
+    index = find_entry(cache, shard, key, hash);
+    if(index != VSC_CLOCK_CACHE_NIL && is_expired(shard->entries + index, &now)) {
+        ++shard->stats.expirations;
+        drop_entry(shard, index, 1);
+    }
+    reclaim(shard, 0, &out);
+    vsci_lock_release(&shard->lock);
+
+    call_evict_released(cache, &out);
+    return NULL;
+}
+
+int vsc_clock_cache_put(VscClockCache *cache, const void *key, void *value, vsc_counter_t ttl)
+{
+    VscClockCacheShard *shard;
+    VscClockCacheEntry *e;
+    vsc_hash_t          hash;
+    vsc_counter_t       now = 0;
+    uint32_t            index;
+    Released            out = {.count = 0};
+
+    validate(cache);
+
+    hash  = hash_key(cache, key);
+    shard = get_shard(cache, hash);
+
+    if(ttl != 0)
+        now = vsc_counter_ns();
+
+    for(;;) {
+        vsci_lock_acquire(&shard->lock);
+
+        if((index = find_entry(cache, shard, key, hash)) != VSC_CLOCK_CACHE_NIL) {
+            Dropped  d           = {NULL, NULL, 0};
+            int      key_changed = 0;
+            uint64_t f;
+
+            e = shard->entries + index;
+
+            /* Only hand back what the cache let go of, it may still hold the key or the value. */
+            if(!(e->key == key && e->value == value)) {
+                key_changed = e->key != key;
+                d.key       = key_changed ? e->key : NULL;
+                d.value     = e->value != value ? e->value : NULL;
+                d.valid     = 1;
+            }
+
+            vsci_atomic_store_ptr(&e->key, (void *)key);
+            vsci_atomic_store_ptr(&e->value, value);
+            vsci_atomic_store_u64(&e->expires, ttl != 0 ? now + ttl : 0);
+            vsci_atomic_store_u32(&e->referenced, 0);
+
+            f = shard->flips;
+            reclaim(shard, 0, &out);
+            vsci_lock_release(&shard->lock);
+
+            call_evict_released(cache, &out);
+
+            /* A lookup may still be comparing against the old key. Values needn't wait, see vsc_clock_cache_get(). */
+            if(key_changed)
+                wait_grace(cache, shard, f);
+
+            call_evict(cache, &d);
+            return 0;
+        }
+
+        if(shard->size == cache->shard_capacity) {
+            if(shard->ghosts != NULL) {
+                uint32_t *ghost = shard->ghosts + (hash % cache->shard_capacity);
+                uint32_t  tag   = make_ghost(hash);
+
+                /* First time we've seen it, remember it and refuse. */
+                if(*ghost != tag) {
+                    *ghost = tag;
+                    ++shard->stats.rejections;
+                    vsci_lock_release(&shard->lock);
+                    return 1;
+                }
+
+                *ghost = 0;
+            }
+
+            evict_one(shard, cache->shard_capacity, &now);
+        }
+
+        reclaim(shard, 0, &out);
+        if(shard->free_list != VSC_CLOCK_CACHE_NIL)
+            break;
+
+        /* Every free entry is still waiting on lookups. Let them finish, then look again. */
+        vsci_lock_release(&shard->lock);
+        call_evict_released(cache, &out);
+        vsci_cpu_relax();
+    }
+
+    index            = shard->free_list;
+    e                = shard->entries + index;
+    shard->free_list = e->next_free;
+
+    /* Nothing can see it yet, it's published by insert_slot(). */
+    vsci_atomic_store_size(&e->hash, hash);
+    vsci_atomic_store_ptr(&e->key, (void *)key);
+    vsci_atomic_store_ptr(&e->value, value);
+    vsci_atomic_store_u64(&e->expires, ttl != 0 ? now + ttl : 0);
+    vsci_atomic_store_u32(&e->referenced, 0);
+    e->next_free = VSC_CLOCK_CACHE_NIL;
+
+    insert_slot(shard, cache->shard_capacity, index);
+    e->used = 1;
+    ++shard->size;
+    ++shard->stats.insertions;
+
+    vsci_lock_release(&shard->lock);
+
+    call_evict_released(cache, &out);
+    return 0;
+}
+
+void *vsc_clock_cache_remove(VscClockCache *cache, const void *key)
+{
+    VscClockCacheShard *shard;
+    vsc_hash_t          hash;
+    uint32_t            index;
+    uint64_t            f;
+    void               *value = NULL;
+
+    validate(cache);
+
+    hash  = hash_key(cache, key);
+    shard = get_shard(cache, hash);
+
+    vsci_lock_acquire(&shard->lock);
+    if((index = find_entry(cache, shard, key, hash)) == VSC_CLOCK_CACHE_NIL) {
+        vsci_lock_release(&shard->lock);
+        return NULL;
+    }
+
+    value = shard->entries[index].value;
+    drop_entry(shard, index, 0);
+    f = shard->flips;
+    vsci_lock_release(&shard->lock);
+
+    /* The caller may release the key as soon as we return. */
+    wait_grace(cache, shard, f);
+    return value;
+}
+
+void vsc_clock_cache_clear(VscClockCache *cache)
+{
+    validate(cache);
+
+    for(size_t i = 0; i < cache->num_shards; ++i) {
+        VscClockCacheShard *shard = &cache->shards[i].shard;
+        uint64_t            f;
+
+        vsci_lock_acquire(&shard->lock);
+        for(uint32_t j = 0; j < cache->shard_capacity; ++j) {
+            if(shard->entries[j].used)
+                drop_entry(shard, j, 1);
+        }
+        f = shard->flips;
+        vsci_lock_release(&shard->lock);
+
+        /* Hands them all over, a batch at a time, as they become safe. */
+        wait_grace(cache, shard, f);
+    }
+}
+
+size_t vsc_clock_cache_size(VscClockCache *cache)
+{
+    size_t size = 0;
+
+    validate(cache);
+
+    for(size_t i = 0; i < cache->num_shards; ++i) {
+        VscClockCacheShard *shard = &cache->shards[i].shard;
+
+        vsci_lock_acquire(&shard->lock);
+        size += shard->size;
+        vsci_lock_release(&shard->lock);
+    }
+
+    return size;
+}
+
+void vsc_clock_cache_stats(VscClockCache *cache, VscClockCacheStats *stats)
+{
+    validate(cache);
+    vsc_assert(stats != NULL);
+
+    *stats = (VscClockCacheStats){0, 0, 0, 0, 0, 0};
+
+    for(size_t i = 0; i < cache->num_shards; ++i) {
+        VscClockCacheShard *shard = &cache->shards[i].shard;
+
+        for(size_t j = 0; j < VSC_CLOCK_CACHE_STRIPES; ++j) {
+            stats->hits += vsci_atomic_load_size(&shard->stripes[j].stripe.hits);
+            stats->misses += vsci_atomic_load_size(&shard->stripes[j].stripe.misses);
+        }
+
+        vsci_lock_acquire(&shard->lock);
+        stats->insertions += shard->stats.insertions;
+        stats->evictions += shard->stats.evictions;
+        stats->expirations += shard->stats.expirations;
+        stats->rejections += shard->stats.rejections;
+        vsci_lock_release(&shard->lock);
+    }
+}
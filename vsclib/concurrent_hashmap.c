@@ -0,0 +1,332 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <assert.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/hashmap.h>
+#include <vsclib/concurrent_hashmap.h>
+#include "lock_internal.h"
+
+typedef struct VscHashMapShard {
+    VscLock     lock;
+    VscHashMap *hm;
+} VscHashMapShard;
+
+/*
+ * Each shard gets its own cache lines, so that threads hammering
+ * neighbouring shards don't bounce each other's locks around.
+ */
+typedef union VscHashMapShardSlot {
+    VscHashMapShard shard;
+    char _pad[(sizeof(VscHashMapShard) + VSC_CACHE_LINE_SIZE - 1) / VSC_CACHE_LINE_SIZE * VSC_CACHE_LINE_SIZE];
+} VscHashMapShardSlot;
+
+static_assert(sizeof(VscHashMapShardSlot) % VSC_CACHE_LINE_SIZE == 0, "VscHashMapShardSlot straddles cache lines");
+
+struct VscConcurrentHashMap {
+    size_t               num_shards;
+    unsigned int         shard_shift;
+    VscHashMapShardSlot *shards;
+    VscHashMapHashProc   hash_proc;
+    const VscAllocator  *allocator;
+};
+
+static inline void validate(const VscConcurrentHashMap *chm)
+{
+    (void)chm;
+    vsc_assert(chm != NULL);
+    vsc_assert(chm->num_shards > 0);
+    vsc_assert(VSC_IS_POT(chm->num_shards));
+    vsc_assert(chm->shards != NULL);
+    vsc_assert(chm->hash_proc != NULL);
+    vsc_assert(chm->allocator != NULL);
+}
+
+/*
+ * Use the high bits of the hash to pick the shard. The inner maps
+ * use the low bits for their buckets, so this keeps them independent.
+ *
+ * Many hash procs (vsc_hashmap_default_hash(), small integers) leave the
+ * high bits zero, so mix them in first with a Fibonacci multiply. The
+ * mixed value only picks the shard, the inner map still gets the original.
+ */
+static inline VscHashMapShard *get_shard(const VscConcurrentHashMap *chm, vsc_hash_t hash)
+{
+    if(chm->num_shards == 1)
+        return &chm->shards[0].shard;
+
+#if VSC_SIZEOF_SIZE_T > 4
+    hash *= (vsc_hash_t)UINT64_C(0x9E3779B97F4A7C15);
+#else
+    hash *= (vsc_hash_t)UINT32_C(0x9E3779B9);
+#endif
+
+    return &chm->shards[hash >> chm->shard_shift].shard;
+}
+
+static void free_shards(VscConcurrentHashMap *chm, size_t n)
+{
+    /* Reverse order, to be nice to linear allocators. */
+    while(n-- > 0)
+        vsc_hashmap_free(chm->shards[n].shard.hm);
+}
+
+VscConcurrentHashMap *vsc_concurrent_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                                    size_t num_shards, const VscAllocator *a)
+{
+    VscConcurrentHashMap *chm;
+    void                 *ptrs[2];
+    int                   r;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(compare != NULL);
+    vsc_assert(a != NULL);
+
+    if(num_shards == 0)
+        num_shards = VSC_CONCURRENT_HASHMAP_DEFAULT_SHARDS;
+
+    if(!VSC_IS_POT(num_shards))
+        return NULL;
+
+    VscBlockAllocInfo bai[2] = {
+        {1,          sizeof(VscConcurrentHashMap), VSC_ALIGNOF(VscConcurrentHashMap), NULL},
+        {num_shards, sizeof(VscHashMapShardSlot),  VSC_CACHE_LINE_SIZE,               NULL},
+    };
+
+    if((r = vsc_block_xalloc(a, ptrs, bai, 2, VSC_ALLOC_ZERO)) < 0)
+        return NULL;
+
+    chm = ptrs[0];
+    *chm = (VscConcurrentHashMap){
+        .num_shards  = num_shards,
+        .shard_shift = VSC_SIZE_T_BITSIZE - vsc_ctz(num_shards),
+        .shards      = ptrs[1],
+        .hash_proc   = hash,
+        .allocator   = a,
+    };
+
+    for(size_t i = 0; i < num_shards; ++i) {
+        chm->shards[i].shard.lock = (VscLock)VSC_LOCK_INIT;
+
+        if((chm->shards[i].shard.hm = vsc_hashmap_alloca(hash, compare, a)) == NULL) {
+            free_shards(chm, i);
+            vsc_xfree(a, chm);
+            return NULL;
+        }
+    }
+
+    return chm;
+}
+
+VscConcurrentHashMap *vsc_concurrent_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                                   size_t num_shards)
+{
+    return vsc_concurrent_hashmap_alloca(hash, compare, num_shards, vsclib_system_allocator);
+}
+
+void vsc_concurrent_hashmap_free(VscConcurrentHashMap *chm)
+{
+    if(chm == NULL)
+        return;
+
+    validate(chm);
+
+    free_shards(chm, chm->num_shards);
+    vsc_xfree(chm->allocator, chm);
+}
+
+size_t vsc_concurrent_hashmap_shard_count(const VscConcurrentHashMap *chm)
+{
+    validate(chm);
+    return chm->num_shards;
+}
+
+int vsc_concurrent_hashmap_configure(VscConcurrentHashMap *chm, uint16_t min_num, uint16_t min_den, uint16_t max_num,
+                                     uint16_t max_den)
+{
+    int r = 0;
+
+    validate(chm);
+
+    for(size_t i = 0; i < chm->num_shards && r == 0; ++i) {
+        VscHashMapShard *s = &chm->shards[i].shard;
+
+        vsci_lock_acquire(&s->lock);
+        r = vsc_hashmap_configure(s->hm, min_num, min_den, max_num, max_den);
+        vsci_lock_release(&s->lock);
+    }
+
+    return r;
+}
+
+vsc_hash_t vsc_concurrent_hashmap_hash(const VscConcurrentHashMap *chm, const void *key)
+{
+    vsc_hash_t hash;
+
+    validate(chm);
+
+    hash = chm->hash_proc(key);
+    vsc_assert(hash != VSC_INVALID_HASH);
+    return hash;
+}
+
+int vsc_concurrent_hashmap_insert_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash, void *value)
+{
+    VscHashMapShard *s;
+    int              r;
+
+    validate(chm);
+
+    if(hash == VSC_INVALID_HASH)
+        return VSC_ERROR(ERANGE);
+
+    s = get_shard(chm, hash);
+
+    vsci_lock_acquire(&s->lock);
+    r = vsc_hashmap_insert_with_hash(s->hm, key, hash, value);
+    vsci_lock_release(&s->lock);
+
+    return r;
+}
+
+int vsc_concurrent_hashmap_insert(VscConcurrentHashMap *chm, const void *key, void *value)
+{
+    return vsc_concurrent_hashmap_insert_with_hash(chm, key, vsc_concurrent_hashmap_hash(chm, key), value);
+}
+
+void *vsc_concurrent_hashmap_find_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash)
+{
+    VscHashMapShard *s;
+    void            *v;
+
+    validate(chm);
+
+    if(hash == VSC_INVALID_HASH)
+        return NULL;
+
+    s = get_shard(chm, hash);
+
+    vsci_lock_acquire(&s->lock);
+    v = vsc_hashmap_find_with_hash(s->hm, key, hash);
+    vsci_lock_release(&s->lock);
+
+    return v;
+}
+
+void *vsc_concurrent_hashmap_find(VscConcurrentHashMap *chm, const void *key)
+{
+    return vsc_concurrent_hashmap_find_with_hash(chm, key, vsc_concurrent_hashmap_hash(chm, key));
+}
+
+int vsc_concurrent_hashmap_update_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash, void *value)
+{
+    VscHashMapShard *s;
+    int              r;
+
+    validate(chm);
+
+    if(hash == VSC_INVALID_HASH)
+        return 1;
+
+    s = get_shard(chm, hash);
+
+    vsci_lock_acquire(&s->lock);
+    r = vsc_hashmap_update_with_hash(s->hm, key, hash, value);
+    vsci_lock_release(&s->lock);
+
+    return r;
+}
+
+int vsc_concurrent_hashmap_update(VscConcurrentHashMap *chm, const void *key, void *value)
+{
+    return vsc_concurrent_hashmap_update_with_hash(chm, key, vsc_concurrent_hashmap_hash(chm, key), value);
+}
+
+void *vsc_concurrent_hashmap_remove_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash)
+{
+    VscHashMapShard *s;
+    void            *v;
+
+    validate(chm);
+
+    if(hash == VSC_INVALID_HASH)
+        return NULL;
+
+    s = get_shard(chm, hash);
+
+    vsci_lock_acquire(&s->lock);
+    v = vsc_hashmap_remove_with_hash(s->hm, key, hash);
+    vsci_lock_release(&s->lock);
+
+    return v;
+}
+
+void *vsc_concurrent_hashmap_remove(VscConcurrentHashMap *chm, const void *key)
+{
+    return vsc_concurrent_hashmap_remove_with_hash(chm, key, vsc_concurrent_hashmap_hash(chm, key));
+}
+
+size_t vsc_concurrent_hashmap_size(VscConcurrentHashMap *chm)
+{
+    size_t size = 0;
+
+    validate(chm);
+
+    for(size_t i = 0; i < chm->num_shards; ++i) {
+        VscHashMapShard *s = &chm->shards[i].shard;
+
+        vsci_lock_acquire(&s->lock);
+        size += vsc_hashmap_size(s->hm);
+        vsci_lock_release(&s->lock);
+    }
+
+    return size;
+}
+
+void vsc_concurrent_hashmap_clear(VscConcurrentHashMap *chm)
+{
+    validate(chm);
+
+    for(size_t i = 0; i < chm->num_shards; ++i) {
+        VscHashMapShard *s = &chm->shards[i].shard;
+
+        vsci_lock_acquire(&s->lock);
+        vsc_hashmap_clear(s->hm);
+        vsci_lock_release(&s->lock);
+    }
+}
+
+int vsc_concurrent_hashmap_enumerate(VscConcurrentHashMap *chm, VscHashMapEnumProc proc, void *user)
+{
+    int r = 0;
+
+    validate(chm);
+
+    for(size_t i = 0; i < chm->num_shards && r == 0; ++i) {
+        VscHashMapShard *s = &chm->shards[i].shard;
+
+        vsci_lock_acquire(&s->lock);
+        r = vsc_hashmap_enumerate(s->hm, proc, user);
+        vsci_lock_release(&s->lock);
+    }
+
+    return r;
+}
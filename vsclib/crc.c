@@ -0,0 +1,725 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2021 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include <vsclib/hash.h>
+#include <vsclib/mem.h>
+#include <vsclib/platform.h>
+#include "atomic_internal.h"
+
+/*
+ * x86-64 gets SSE4.2 (CRC32C only) and PCLMULQDQ kernels, everything else
+ * uses slice-by-8. The kernels are chosen at runtime, so the library doesn't
+ * need to be built with -msse4.2 and still runs on older CPUs.
+ */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VSC_CRC_X86 1
+#define VSC_CRC_TARGET(x) __attribute__((target(x)))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && VSC_HAVE_INTRIN_H && defined(_M_X64)
+#define VSC_CRC_X86 1
+#define VSC_CRC_TARGET(x)
+#include <intrin.h>
+#else
+#define VSC_CRC_X86 0
+#endif
+
+/*
+ * These all operate on the raw CRC register, i.e. without the initial value,
+ * output reflection, or final XOR.
+ *
+ * For reflected models, the register is in the low `width` bits and shifts right.
+ * Otherwise, it's in the high `width` bits and shifts left. Either way, the next
+ * message bit is always at the same end, regardless of the width.
+ */
+typedef uint64_t (*CrcProc)(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl);
+
+struct VscCrc {
+    unsigned int width;
+    int          refin;
+    int          refout;
+    uint64_t     init;
+    uint64_t     xorout;
+
+    /*
+     * Slice-by-8 tables. table[0] is the usual byte-at-a-time table.
+     * Reflected models up to 32 bits wide use the narrower table32, it halves the cache footprint.
+     */
+    union {
+        uint64_t table[8][256];
+        uint32_t table32[8][256];
+    };
+
+    /*
+     * PCLMULQDQ folding constants, see fold_reflected() and fold_normal().
+     * fold4 folds across 512 bits, fold1 across 128.
+     */
+    uint64_t fold4[2];
+    uint64_t fold1[2];
+
+    /*
+     * Reflected models only, for vsc_crc32_combine().
+     * rpoly is the bit-reflected polynomial and x2n[k] = x^(2^k) mod P, reflected.
+     */
+    uint64_t rpoly;
+    uint64_t x2n[64 + 3];
+
+    /* The fastest kernel for large inputs. */
+    CrcProc proc;
+    /* The fastest kernel for inputs too small for proc. */
+    CrcProc tail;
+
+    const VscAllocator *allocator;
+};
+
+// clang-format off
+/*
+ * https://reveng.sourceforge.io/crc-catalogue/all.htm
+ * width=32 poly=0x04c11db7 init=0xffffffff refin=true
+ * refout=true xorout=0xffffffff check=0xcbf43926
+ * residue=0xdebb20e3 name="CRC-32/ISO-HDLC"
+ */
+const VscCrcModel vsc_crc_model_crc32 = {
+    .width = 32, .poly = 0x04c11db7, .init = 0xffffffff,
+    .refin = 1, .refout = 1, .xorout = 0xffffffff, .check = 0xcbf43926,
+    .name = "CRC-32/ISO-HDLC",
+};
+
+/*
+ * width=32 poly=0x1edc6f41 init=0xffffffff refin=true
+ * refout=true xorout=0xffffffff check=0xe3069283
+ * residue=0xb798b438 name="CRC-32/ISCSI"
+ */
+const VscCrcModel vsc_crc_model_crc32c = {
+    .width = 32, .poly = 0x1edc6f41, .init = 0xffffffff,
+    .refin = 1, .refout = 1, .xorout = 0xffffffff, .check = 0xe3069283,
+    .name = "CRC-32/ISCSI",
+};
+
+/*
+ * width=32 poly=0x04c11db7 init=0xffffffff refin=false
+ * refout=false xorout=0xffffffff check=0xfc891918
+ * residue=0xc704dd7b name="CRC-32/BZIP2"
+ */
+const VscCrcModel vsc_crc_model_crc32_bzip2 = {
+    .width = 32, .poly = 0x04c11db7, .init = 0xffffffff,
+    .refin = 0, .refout = 0, .xorout = 0xffffffff, .check = 0xfc891918,
+    .name = "CRC-32/BZIP2",
+};
+
+/*
+ * width=16 poly=0x1021 init=0x0000 refin=true
+ * refout=true xorout=0x0000 check=0x2189
+ * residue=0x0000 name="CRC-16/KERMIT"
+ */
+const VscCrcModel vsc_crc_model_crc16_kermit = {
+    .width = 16, .poly = 0x1021, .init = 0x0000,
+    .refin = 1, .refout = 1, .xorout = 0x0000, .check = 0x2189,
+    .name = "CRC-16/KERMIT",
+};
+
+/*
+ * width=16 poly=0x1021 init=0xffff refin=false
+ * refout=false xorout=0x0000 check=0x29b1
+ * residue=0x0000 name="CRC-16/IBM-3740"
+ */
+const VscCrcModel vsc_crc_model_crc16_ibm_3740 = {
+    .width = 16, .poly = 0x1021, .init = 0xffff,
+    .refin = 0, .refout = 0, .xorout = 0x0000, .check = 0x29b1,
+    .name = "CRC-16/IBM-3740",
+};
+
+/*
+ * width=64 poly=0x42f0e1eba9ea3693 init=0xffffffffffffffff refin=true
+ * refout=true xorout=0xffffffffffffffff check=0x995dc9bbdf1939fa
+ * residue=0x49958c9abd7d353f name="CRC-64/XZ"
+ */
+const VscCrcModel vsc_crc_model_crc64_xz = {
+    .width = 64, .poly = 0x42f0e1eba9ea3693, .init = 0xffffffffffffffff,
+    .refin = 1, .refout = 1, .xorout = 0xffffffffffffffff, .check = 0x995dc9bbdf1939fa,
+    .name = "CRC-64/XZ",
+};
+
+/*
+ * width=64 poly=0x42f0e1eba9ea3693 init=0x0000000000000000 refin=false
+ * refout=false xorout=0x0000000000000000 check=0x6c40df5f0b497347
+ * residue=0x0000000000000000 name="CRC-64/ECMA-182"
+ */
+const VscCrcModel vsc_crc_model_crc64_ecma_182 = {
+    .width = 64, .poly = 0x42f0e1eba9ea3693, .init = 0x0000000000000000,
+    .refin = 0, .refout = 0, .xorout = 0x0000000000000000, .check = 0x6c40df5f0b497347,
+    .name = "CRC-64/ECMA-182",
+};
+// clang-format on
+
+static VscCrc crc32_impl;
+static VscCrc crc32c_impl;
+
+/*
+ * 0 = not initialised, 1 = initialising, 2 = ready.
+ */
+static volatile uint32_t impl_state = 0;
+static uint32_t          cpu_features;
+
+static inline uint64_t width_mask(unsigned int width)
+{
+    return ~(uint64_t)0 >> (64 - width);
+}
+
+static uint64_t reflect(uint64_t v, unsigned int width)
+{
+    uint64_t r = 0;
+
+    for(unsigned int i = 0; i < width; ++i) {
+        if(v & ((uint64_t)1 << i))
+            r |= (uint64_t)1 << (width - 1 - i);
+    }
+
+    return r;
+}
+
+static uint64_t slice8_reflected(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    const uint64_t(*t)[256] = impl->table;
+
+    for(; size >= 8; p += 8, size -= 8) {
+        uint64_t v = crc ^ ((uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+                            (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56);
+
+        crc = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][(v >> 24) & 0xFF] ^
+              t[3][(v >> 32) & 0xFF] ^ t[2][(v >> 40) & 0xFF] ^ t[1][(v >> 48) & 0xFF] ^ t[0][v >> 56];
+    }
+
+    while(size--)
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+static uint64_t slice8_reflected32(uint64_t crc64, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    const uint32_t(*t)[256] = impl->table32;
+    uint32_t crc            = (uint32_t)crc64;
+
+    for(; size >= 8; p += 8, size -= 8) {
+        uint32_t lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+
+    while(size--)
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+static uint64_t slice8_normal(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    const uint64_t(*t)[256] = impl->table;
+
+    for(; size >= 8; p += 8, size -= 8) {
+        uint64_t v = crc ^ ((uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |
+                            (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7]);
+
+        crc = t[7][v >> 56] ^ t[6][(v >> 48) & 0xFF] ^ t[5][(v >> 40) & 0xFF] ^ t[4][(v >> 32) & 0xFF] ^
+              t[3][(v >> 24) & 0xFF] ^ t[2][(v >> 16) & 0xFF] ^ t[1][(v >> 8) & 0xFF] ^ t[0][v & 0xFF];
+    }
+
+    while(size--)
+        crc = t[0][(crc >> 56) ^ *p++] ^ (crc << 8);
+
+    return crc;
+}
+
+#if VSC_CRC_X86
+/* CPUID.1:ECX */
+#define CPU_PCLMULQDQ (1u << 1)
+#define CPU_SSSE3     (1u << 9)
+#define CPU_SSE42     (1u << 20)
+
+VSC_CRC_TARGET("sse4.2")
+static uint64_t crc32c_sse42(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    uint32_t c32;
+
+    (void)impl;
+
+    for(; size >= 8; p += 8, size -= 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        crc = _mm_crc32_u64(crc, v);
+    }
+
+    c32 = (uint32_t)crc;
+    while(size--)
+        c32 = _mm_crc32_u8(c32, *p++);
+
+    return c32;
+}
+
+VSC_CRC_TARGET("pclmul,sse2")
+static inline __m128i fold_128(__m128i x, __m128i k, __m128i next)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+}
+
+/*
+ * Carry-less multiplication folding, as per Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction".
+ *
+ * A 128-bit block H followed by n bits is congruent to H * x^n, so H can be replaced
+ * by H * x^128 (mod P) XOR'd into the block 128 bits later. Splitting H into 64-bit
+ * halves keeps each product within 128 bits for any width up to 64. Four blocks are
+ * folded in parallel to hide the multiplier latency. What's left is congruent to the
+ * message so far, so it's handed to the scalar kernel along with the tail.
+ */
+VSC_CRC_TARGET("pclmul,sse2")
+static uint64_t fold_reflected(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    __m128i x0, x1, x2, x3, k;
+    uint8_t buf[16];
+
+    if(size < 64)
+        return impl->tail(crc, p, size, impl);
+
+    x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(p + 0)), _mm_cvtsi64_si128((long long)crc));
+    x1 = _mm_loadu_si128((const __m128i *)(p + 16));
+    x2 = _mm_loadu_si128((const __m128i *)(p + 32));
+    x3 = _mm_loadu_si128((const __m128i *)(p + 48));
+    p += 64;
+    size -= 64;
+
+    k = _mm_set_epi64x((long long)impl->fold4[1], (long long)impl->fold4[0]);
+    for(; size >= 64; p += 64, size -= 64) {
+        x0 = fold_128(x0, k, _mm_loadu_si128((const __m128i *)(p + 0)));
+        x1 = fold_128(x1, k, _mm_loadu_si128((const __m128i *)(p + 16)));
+        x2 = fold_128(x2, k, _mm_loadu_si128((const __m128i *)(p + 32)));
+        x3 = fold_128(x3, k, _mm_loadu_si128((const __m128i *)(p + 48)));
+    }
+
+    k  = _mm_set_epi64x((long long)impl->fold1[1], (long long)impl->fold1[0]);
+    x1 = fold_128(x0, k, x1);
+    x2 = fold_128(x1, k, x2);
+    x3 = fold_128(x2, k, x3);
+
+    for(; size >= 16; p += 16, size -= 16)
+        x3 = fold_128(x3, k, _mm_loadu_si128((const __m128i *)p));
+
+    _mm_storeu_si128((__m128i *)buf, x3);
+    crc = impl->tail(0, buf, sizeof(buf), impl);
+    return impl->tail(crc, p, size, impl);
+}
+
+/*
+ * Same as fold_reflected(), but the blocks are byte-swapped on the way
+ * in and out, so each lane's bit i is the coefficient of x^i.
+ */
+VSC_CRC_TARGET("pclmul,ssse3")
+static uint64_t fold_normal(uint64_t crc, const uint8_t *p, size_t size, const VscCrc *impl)
+{
+    __m128i x0, x1, x2, x3, k, bswap;
+    uint8_t buf[16];
+
+    if(size < 64)
+        return impl->tail(crc, p, size, impl);
+
+    bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    /* The register's at the top, and the first 8 bytes are the high lane. */
+    x0 = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), bswap),
+                       _mm_set_epi64x((long long)crc, 0));
+    x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap);
+    x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap);
+    x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap);
+    p += 64;
+    size -= 64;
+
+    k = _mm_set_epi64x((long long)impl->fold4[1], (long long)impl->fold4[0]);
+    for(; size >= 64; p += 64, size -= 64) {
+        x0 = fold_128(x0, k, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), bswap));
+        x1 = fold_128(x1, k, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap));
+        x2 = fold_128(x2, k, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap));
+        x3 = fold_128(x3, k, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap));
+    }
+
+    k  = _mm_set_epi64x((long long)impl->fold1[1], (long long)impl->fold1[0]);
+    x1 = fold_128(x0, k, x1);
+    x2 = fold_128(x1, k, x2);
+    x3 = fold_128(x2, k, x3);
+
+    for(; size >= 16; p += 16, size -= 16)
+        x3 = fold_128(x3, k, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), bswap));
+
+    _mm_storeu_si128((__m128i *)buf, _mm_shuffle_epi8(x3, bswap));
+    crc = impl->tail(0, buf, sizeof(buf), impl);
+    return impl->tail(crc, p, size, impl);
+}
+
+static uint32_t cpuid_ecx(void)
+{
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (uint32_t)regs[2];
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return ecx;
+#endif
+}
+#endif
+
+/* x^n mod P, where poly excludes the x^width term. */
+static uint64_t xpow_mod(unsigned int n, uint64_t poly, unsigned int width)
+{
+    uint64_t mask = width_mask(width);
+    uint64_t r    = 1;
+
+    while(n--) {
+        uint64_t top = (r >> (width - 1)) & 1;
+
+        r = (r << 1) & mask;
+        if(top)
+            r ^= poly;
+    }
+
+    return r;
+}
+
+/* a * b mod P, reflected. */
+static uint64_t multmodp(uint64_t a, uint64_t b, const VscCrc *impl)
+{
+    uint64_t m = (uint64_t)1 << (impl->width - 1), p = 0;
+
+    for(;;) {
+        if(a & m) {
+            p ^= b;
+            if((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ impl->rpoly : b >> 1;
+    }
+
+    return p;
+}
+
+/* x^(n * 2^k) mod P, reflected. */
+static uint64_t x2nmodp(uint64_t n, unsigned int k, const VscCrc *impl)
+{
+    uint64_t p = (uint64_t)1 << (impl->width - 1); /* x^0 */
+
+    for(; n != 0; n >>= 1, ++k) {
+        if(n & 1)
+            p = multmodp(impl->x2n[k], p, impl);
+    }
+
+    return p;
+}
+
+static void init_impl(VscCrc *impl, const VscCrcModel *model)
+{
+    unsigned int width = model->width;
+    uint64_t     mask  = width_mask(width);
+    uint64_t     poly  = model->poly & mask;
+    uint64_t     t0[256];
+
+    impl->width  = width;
+    impl->refin  = model->refin;
+    impl->refout = model->refout;
+    impl->xorout = model->xorout & mask;
+
+    if(model->refin) {
+        impl->init  = reflect(model->init & mask, width);
+        impl->rpoly = reflect(poly, width);
+
+        for(int i = 0; i < 256; ++i) {
+            uint64_t v = (uint64_t)i;
+            for(int j = 0; j < 8; ++j)
+                v = v & 1 ? (v >> 1) ^ impl->rpoly : v >> 1;
+            t0[i] = v;
+        }
+
+        for(int i = 0; i < 256; ++i) {
+            uint64_t v = t0[i];
+            for(int j = 0; j < 8; ++j, v = (v >> 8) ^ t0[v & 0xFF]) {
+                if(width <= 32)
+                    impl->table32[j][i] = (uint32_t)v;
+                else
+                    impl->table[j][i] = v;
+            }
+        }
+
+        /*
+         * Bit-reflect x^(n - 1) mod P into a 64-bit lane. The extra x from multiplying
+         * reflected values brings it back up to x^n. The low lane holds the upper half
+         * of the block, so it has the extra 64 bits of distance.
+         */
+        impl->fold4[0] = reflect(xpow_mod(512 + 64 - 1, poly, width), 64);
+        impl->fold4[1] = reflect(xpow_mod(512 - 1, poly, width), 64);
+        impl->fold1[0] = reflect(xpow_mod(128 + 64 - 1, poly, width), 64);
+        impl->fold1[1] = reflect(xpow_mod(128 - 1, poly, width), 64);
+
+        if(width >= 2) {
+            uint64_t p = (uint64_t)1 << (width - 2); /* x^1 */
+            for(size_t i = 0; i < sizeof(impl->x2n) / sizeof(impl->x2n[0]); ++i) {
+                impl->x2n[i] = p;
+                p            = multmodp(p, p, impl);
+            }
+        }
+
+        impl->proc = width <= 32 ? slice8_reflected32 : slice8_reflected;
+        impl->tail = impl->proc;
+    } else {
+        uint64_t tpoly = poly << (64 - width);
+
+        impl->init  = (model->init & mask) << (64 - width);
+        impl->rpoly = 0;
+
+        for(int i = 0; i < 256; ++i) {
+            uint64_t v = (uint64_t)i << 56;
+            for(int j = 0; j < 8; ++j)
+                v = v >> 63 ? (v << 1) ^ tpoly : v << 1;
+            t0[i] = v;
+        }
+
+        for(int i = 0; i < 256; ++i) {
+            uint64_t v = t0[i];
+            for(int j = 0; j < 8; ++j, v = (v << 8) ^ t0[v >> 56])
+                impl->table[j][i] = v;
+        }
+
+        /*
+         * Unreflected products don't pick up an extra x. The high lane holds the
+         * upper half of the block here.
+         */
+        impl->fold4[0] = xpow_mod(512, poly, width);
+        impl->fold4[1] = xpow_mod(512 + 64, poly, width);
+        impl->fold1[0] = xpow_mod(128, poly, width);
+        impl->fold1[1] = xpow_mod(128 + 64, poly, width);
+
+        impl->proc = slice8_normal;
+        impl->tail = slice8_normal;
+    }
+
+#if VSC_CRC_X86
+    if(model->refin && width == 32 && poly == vsc_crc_model_crc32c.poly && (cpu_features & CPU_SSE42))
+        impl->tail = crc32c_sse42;
+
+    if(model->refin && (cpu_features & CPU_PCLMULQDQ))
+        impl->proc = fold_reflected;
+    else if(!model->refin && (cpu_features & CPU_PCLMULQDQ) && (cpu_features & CPU_SSSE3))
+        impl->proc = fold_normal;
+    else
+        impl->proc = impl->tail;
+#endif
+}
+
+static void ensure_impls(void)
+{
+    uint32_t expected = 0;
+
+    if(vsci_atomic_load_u32(&impl_state) == 2)
+        return;
+
+    if(vsci_atomic_cas_u32(&impl_state, &expected, 1)) {
+#if VSC_CRC_X86
+        cpu_features = cpuid_ecx();
+#endif
+        init_impl(&crc32_impl, &vsc_crc_model_crc32);
+        init_impl(&crc32c_impl, &vsc_crc_model_crc32c);
+        vsci_atomic_store_u32(&impl_state, 2);
+        return;
+    }
+
+    while(vsci_atomic_load_u32(&impl_state) != 2)
+        vsci_cpu_relax();
+}
+
+VscCrc *vsc_crc_alloca(const VscCrcModel *model, const VscAllocator *a)
+{
+    VscCrc *impl;
+
+    if(model == NULL || model->width == 0 || model->width > 64 || a == NULL)
+        return NULL;
+
+    /* Without the x^0 term, x^n mod P can reach zero, and multmodp() never finishes on it. */
+    if(!(model->poly & 1))
+        return NULL;
+
+    if((impl = vsc_xalloc(a, sizeof(VscCrc))) == NULL)
+        return NULL;
+
+    ensure_impls();
+    init_impl(impl, model);
+    impl->allocator = a;
+    return impl;
+}
+
+VscCrc *vsc_crc_alloc(const VscCrcModel *model)
+{
+    return vsc_crc_alloca(model, vsclib_system_allocator);
+}
+
+void vsc_crc_free(VscCrc *crc)
+{
+    if(crc == NULL)
+        return;
+
+    vsc_xfree(crc->allocator, crc);
+}
+
+uint64_t vsc_crc_begin(const VscCrc *crc)
+{
+    return crc->init;
+}
+
+uint64_t vsc_crc_update(const VscCrc *crc, uint64_t state, const void *data, size_t size)
+{
+    if(size == 0)
+        return state;
+
+    return crc->proc(state, data, size, crc);
+}
+
+uint64_t vsc_crc_end(const VscCrc *crc, uint64_t state)
+{
+    if(!crc->refin)
+        state >>= 64 - crc->width;
+
+    if(crc->refin != crc->refout)
+        state = reflect(state, crc->width);
+
+    return state ^ crc->xorout;
+}
+
+uint64_t vsc_crc_calc(const VscCrc *crc, const void *data, size_t size)
+{
+    return vsc_crc_end(crc, vsc_crc_update(crc, vsc_crc_begin(crc), data, size));
+}
+
+/*
+ * vsc_crc32() and vsc_crc32c() use built-in engines. Both are reflected
+ * with init and xorout of ~0, so the register is just the CRC inverted.
+ */
+static uint32_t crc_update(uint32_t crc, const void *buf, size_t size, const VscCrc *impl)
+{
+    if(size == 0)
+        return crc;
+
+    ensure_impls();
+    return (uint32_t)impl->proc(crc ^ ~0U, buf, size, impl) ^ ~0U;
+}
+
+static uint32_t crc_combine(uint32_t crc1, uint32_t crc2, uint64_t size2, const VscCrc *impl)
+{
+    ensure_impls();
+    return (uint32_t)multmodp(x2nmodp(size2, 3, impl), crc1, impl) ^ crc2;
+}
+
+typedef struct CrcParallel {
+    const VscCrc  *impl;
+    const uint8_t *buf;
+    size_t         size;
+    size_t         chunk_size;
+    uint32_t       crcs[VSC_CRC_PARALLEL_MAX_CHUNKS];
+} CrcParallel;
+
+static void crc_parallel_task(size_t i, void *arg)
+{
+    CrcParallel *cp     = arg;
+    size_t       offset = i * cp->chunk_size;
+
+    cp->crcs[i] = crc_update(0, cp->buf + offset, VSC_MIN(cp->chunk_size, cp->size - offset), cp->impl);
+}
+
+static uint32_t crc_parallel(const void *buf, size_t size, size_t num_chunks, VscParallelForProc proc, void *user,
+                             const VscCrc *impl)
+{
+    CrcParallel cp;
+    uint32_t    crc;
+
+    if(size == 0)
+        return 0;
+
+    num_chunks = VSC_MIN(VSC_MAX(num_chunks, 1), VSC_CRC_PARALLEL_MAX_CHUNKS);
+
+    /* Don't bother splitting small buffers, the combines would dominate. */
+    cp.chunk_size = VSC_MAX((size + num_chunks - 1) / num_chunks, VSC_CRC_PARALLEL_MIN_CHUNK_SIZE);
+    num_chunks    = (size + cp.chunk_size - 1) / cp.chunk_size;
+
+    if(proc == NULL || num_chunks == 1)
+        return crc_update(0, buf, size, impl);
+
+    ensure_impls();
+
+    cp.impl = impl;
+    cp.buf  = buf;
+    cp.size = size;
+    proc(crc_parallel_task, &cp, num_chunks, user);
+
+    crc = cp.crcs[0];
+    for(size_t i = 1; i < num_chunks; ++i)
+        crc = crc_combine(crc, cp.crcs[i], VSC_MIN(cp.chunk_size, size - i * cp.chunk_size), impl);
+
+    return crc;
+}
+
+uint32_t vsc_crc32(const void *buf, size_t size)
+{
+    return crc_update(0, buf, size, &crc32_impl);
+}
+
+uint32_t vsc_crc32_update(uint32_t crc, const void *buf, size_t size)
+{
+    return crc_update(crc, buf, size, &crc32_impl);
+}
+
+uint32_t vsc_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t size2)
+{
+    return crc_combine(crc1, crc2, size2, &crc32_impl);
+}
+
+uint32_t vsc_crc32_parallel(const void *buf, size_t size, size_t num_chunks, VscParallelForProc proc, void *user)
+{
+    return crc_parallel(buf, size, num_chunks, proc, user, &crc32_impl);
+}
+
+uint32_t vsc_crc32c(const void *buf, size_t size)
+{
+    return crc_update(0, buf, size, &crc32c_impl);
+}
+
+uint32_t vsc_crc32c_update(uint32_t crc, const void *buf, size_t size)
+{
+    return crc_update(crc, buf, size, &crc32c_impl);
+}
+
+uint32_t vsc_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t size2)
+{
+    return crc_combine(crc1, crc2, size2, &crc32c_impl);
+}
+
+uint32_t vsc_crc32c_parallel(const void *buf, size_t size, size_t num_chunks, VscParallelForProc proc, void *user)
+{
+    return crc_parallel(buf, size, num_chunks, proc, user, &crc32c_impl);
+}
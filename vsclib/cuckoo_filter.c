@@ -0,0 +1,422 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Cuckoo filter, as described in "Cuckoo Filter: Practically Better Than Bloom".
+ *
+ * Each bucket holds four 16-bit fingerprints in a single 64-bit word, 0 being empty.
+ * An element can live in bucket i1, taken from its hash, or i2 = i1 ^ H(fingerprint).
+ * Either can be found from the other and the fingerprint, so elements can be
+ * kicked between them without knowing their hash.
+ *
+ * If an insertion gives up kicking, the fingerprint left over is kept aside as the
+ * "victim", so nothing is lost. The filter is then full until something is removed.
+ *
+ * Serialised form, everything little-endian:
+ *   [ 0] char[8]  magic, "VSCCUCKO"
+ *   [ 8] uint32_t version, 2
+ *   [12] uint32_t victim fingerprint, or 0 if none
+ *   [16] uint64_t number of buckets, a power-of-two
+ *   [24] uint64_t number of elements
+ *   [32] uint64_t victim bucket
+ *   [40] uint64_t reserved, 0
+ *   [48] uint64_t for each bucket
+ */
+#include <string.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/hash.h>
+#include <vsclib/io.h>
+#include <vsclib/mem.h>
+#include <vsclib/cuckoo_filter.h>
+
+#define CUCKOO_MAGIC       "VSCCUCKO"
+#define CUCKOO_VERSION     2
+#define CUCKOO_HEADER_SIZE 48
+#define CUCKOO_BUCKET_SIZE 4
+#define CUCKOO_MAX_KICKS   500
+
+#define CUCKOO_LANES_LO UINT64_C(0x0001000100010001)
+#define CUCKOO_LANES_HI UINT64_C(0x8000800080008000)
+
+struct VscCuckooFilter {
+    size_t    num_buckets;
+    size_t    size;
+    uint64_t *buckets;
+
+    uint16_t victim_fp;
+    size_t   victim_bucket;
+
+    /* For picking which fingerprint to kick. */
+    uint32_t rng;
+
+    const VscAllocator *allocator;
+};
+
+static inline void validate(const VscCuckooFilter *cf)
+{
+    (void)cf;
+    vsc_assert(cf != NULL);
+    vsc_assert(VSC_IS_POT(cf->num_buckets));
+    vsc_assert(cf->size <= cf->num_buckets * CUCKOO_BUCKET_SIZE + 1);
+    vsc_assert(cf->buckets != NULL);
+    vsc_assert(cf->allocator != NULL);
+}
+
+/*
+ * Spread a hash over 64 bits. The top 16 bits are the fingerprint,
+ * the bottom bits the bucket. * Always mixed, as map hashes can be weak, e.g. vsc_hashmap_default_hash() on pointers.
+ */
+static inline uint64_t widen(vsc_hash_t hash)
+{
+    uint64_t h = (uint64_t)hash * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 29);
+}
+
+static inline uint16_t fingerprint(uint64_t h)
+{
+    uint16_t fp = (uint16_t)(h >> 48);
+    return fp != 0 ? fp : 1;
+}
+
+static inline size_t alt_bucket(const VscCuckooFilter *cf, size_t i, uint16_t fp)
+{
+    return (i ^ (size_t)(fp * UINT32_C(0x5bd1e995))) & (cf->num_buckets - 1);
+}
+
+/*
+ * Does any lane of `bucket` equal `fp`? Checks all four at once.
+ */
+static inline int bucket_has(uint64_t bucket, uint16_t fp)
+{
+    uint64_t x = bucket ^ (CUCKOO_LANES_LO * fp);
+    return ((x - CUCKOO_LANES_LO) & ~x & CUCKOO_LANES_HI) != 0;
+}
+
+static inline uint16_t lane_get(uint64_t bucket, size_t lane)
+{
+    return (uint16_t)(bucket >> (lane * 16));
+}
+
+static inline uint64_t lane_set(uint64_t bucket, size_t lane, uint16_t fp)
+{
+    return (bucket & ~(UINT64_C(0xFFFF) << (lane * 16))) | ((uint64_t)fp << (lane * 16));
+}
+
+/*
+ * Put `fp` in the first empty lane of bucket `i`.
+ */
+static int bucket_put(VscCuckooFilter *cf, size_t i, uint16_t fp)
+{
+    for(size_t lane = 0; lane < CUCKOO_BUCKET_SIZE; ++lane) {
+        if(lane_get(cf->buckets[i], lane) == 0) {
+            cf->buckets[i] = lane_set(cf->buckets[i], lane, fp);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int bucket_take(VscCuckooFilter *cf, size_t i, uint16_t fp)
+{
+    if(!bucket_has(cf->buckets[i], fp))
+        return 0;
+
+    for(size_t lane = 0; lane < CUCKOO_BUCKET_SIZE; ++lane) {
+        if(lane_get(cf->buckets[i], lane) == fp) {
+            cf->buckets[i] = lane_set(cf->buckets[i], lane, 0);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline uint32_t next_random(VscCuckooFilter *cf)
+{
+    /* xorshift32 */
+    uint32_t x = cf->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return cf->rng = x;
+}
+
+/*
+ * Store `fp`, starting with bucket `i`, kicking other fingerprints out of
+ * the way if needed. Never fails, but may leave a victim.
+ */
+static void place(VscCuckooFilter *cf, size_t i, uint16_t fp)
+{
+    if(bucket_put(cf, i, fp) || bucket_put(cf, i = alt_bucket(cf, i, fp), fp))
+        return;
+
+    for(size_t n = 0; n < CUCKOO_MAX_KICKS; ++n) {
+        size_t   lane   = next_random(cf) % CUCKOO_BUCKET_SIZE;
+        uint16_t kicked = lane_get(cf->buckets[i], lane);
+
+        cf->buckets[i] = lane_set(cf->buckets[i], lane, fp);
+        fp             = kicked;
+        i              = alt_bucket(cf, i, fp);
+
+        if(bucket_put(cf, i, fp))
+            return;
+    }
+
+    cf->victim_fp     = fp;
+    cf->victim_bucket = i;
+}
+
+static VscCuckooFilter *alloc_buckets(size_t num_buckets, const VscAllocator *a)
+{
+    void             *ptrs[2];
+    VscCuckooFilter  *cf;
+    VscBlockAllocInfo bai[2] = {
+        {1,           sizeof(VscCuckooFilter), VSC_ALIGNOF(VscCuckooFilter), NULL},
+        {num_buckets, sizeof(uint64_t),        VSC_ALIGNOF(uint64_t),        NULL},
+    };
+
+    if(!VSC_IS_POT(num_buckets) || num_buckets > SIZE_MAX / sizeof(uint64_t))
+        return NULL;
+
+    if(vsc_block_xalloc(a, ptrs, bai, 2, VSC_ALLOC_ZERO) < 0)
+        return NULL;
+
+    cf  = ptrs[0];
+    *cf = (VscCuckooFilter){
+        .num_buckets   = num_buckets,
+        .size          = 0,
+        .buckets       = ptrs[1],
+        .victim_fp     = 0,
+        .victim_bucket = 0,
+        .rng           = 0x9e3779b9U,
+        .allocator     = a,
+    };
+    return cf;
+}
+
+VscCuckooFilter *vsc_cuckoo_filter_alloca(size_t capacity, const VscAllocator *a)
+{
+    size_t num_buckets = 1;
+
+    vsc_assert(a != NULL);
+
+    /* Cuckoo filters only reliably fill to ~95%, so leave some slack. */
+    if(capacity > SIZE_MAX / 20)
+        return NULL;
+
+    while(num_buckets * CUCKOO_BUCKET_SIZE * 19 < capacity * 20) {
+        if(num_buckets > SIZE_MAX / 2)
+            return NULL;
+
+        num_buckets *= 2;
+    }
+
+    return alloc_buckets(num_buckets, a);
+}
+
+VscCuckooFilter *vsc_cuckoo_filter_alloc(size_t capacity)
+{
+    return vsc_cuckoo_filter_alloca(capacity, vsclib_system_allocator);
+}
+
+void vsc_cuckoo_filter_free(VscCuckooFilter *cf)
+{
+    validate(cf);
+    vsc_xfree(cf->allocator, cf);
+}
+
+void vsc_cuckoo_filter_clear(VscCuckooFilter *cf)
+{
+    validate(cf);
+
+    memset(cf->buckets, 0, sizeof(uint64_t) * cf->num_buckets);
+    cf->size      = 0;
+    cf->victim_fp = 0;
+}
+
+int vsc_cuckoo_filter_insert_hash(VscCuckooFilter *cf, vsc_hash_t hash)
+{
+    uint64_t h = widen(hash);
+
+    validate(cf);
+
+    if(cf->victim_fp != 0)
+        return VSC_ERROR(ENOSPC);
+
+    place(cf, (size_t)h & (cf->num_buckets - 1), fingerprint(h));
+    ++cf->size;
+    return 0;
+}
+
+int vsc_cuckoo_filter_contains_hash(const VscCuckooFilter *cf, vsc_hash_t hash)
+{
+    uint64_t h  = widen(hash);
+    uint16_t fp = fingerprint(h);
+    size_t   i1, i2;
+
+    validate(cf);
+
+    i1 = (size_t)h & (cf->num_buckets - 1);
+    i2 = alt_bucket(cf, i1, fp);
+
+    if(cf->victim_fp == fp && (cf->victim_bucket == i1 || cf->victim_bucket == i2))
+        return 1;
+
+    return bucket_has(cf->buckets[i1], fp) || bucket_has(cf->buckets[i2], fp);
+}
+
+int vsc_cuckoo_filter_remove_hash(VscCuckooFilter *cf, vsc_hash_t hash)
+{
+    uint64_t h  = widen(hash);
+    uint16_t fp = fingerprint(h);
+    size_t   i1, i2;
+
+    validate(cf);
+
+    i1 = (size_t)h & (cf->num_buckets - 1);
+    i2 = alt_bucket(cf, i1, fp);
+
+    if(cf->victim_fp == fp && (cf->victim_bucket == i1 || cf->victim_bucket == i2)) {
+        cf->victim_fp = 0;
+        --cf->size;
+        return 0;
+    }
+
+    if(!bucket_take(cf, i1, fp) && !bucket_take(cf, i2, fp))
+        return 1;
+
+    --cf->size;
+
+    /* There's room now, try to find the victim a home. */
+    if(cf->victim_fp != 0) {
+        fp            = cf->victim_fp;
+        cf->victim_fp = 0;
+        place(cf, cf->victim_bucket, fp);
+    }
+
+    return 0;
+}
+
+int vsc_cuckoo_filter_insert(VscCuckooFilter *cf, const void *data, size_t size)
+{
+    return vsc_cuckoo_filter_insert_hash(cf, vsc_hash(data, size));
+}
+
+int vsc_cuckoo_filter_contains(const VscCuckooFilter *cf, const void *data, size_t size)
+{
+    return vsc_cuckoo_filter_contains_hash(cf, vsc_hash(data, size));
+}
+
+int vsc_cuckoo_filter_remove(VscCuckooFilter *cf, const void *data, size_t size)
+{
+    return vsc_cuckoo_filter_remove_hash(cf, vsc_hash(data, size));
+}
+
+size_t vsc_cuckoo_filter_size(const VscCuckooFilter *cf)
+{
+    validate(cf);
+    return cf->size;
+}
+
+int vsc_cuckoo_filter_full(const VscCuckooFilter *cf)
+{
+    validate(cf);
+    return cf->victim_fp != 0;
+}
+
+int vsc_cuckoo_filter_write(const VscCuckooFilter *cf, FILE *f)
+{
+    uint8_t hdr[CUCKOO_HEADER_SIZE];
+
+    validate(cf);
+
+    if(f == NULL)
+        return VSC_ERROR(EINVAL);
+
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr + 0, CUCKOO_MAGIC, 8);
+    vsc_write_leu32(hdr + 8, CUCKOO_VERSION);
+    vsc_write_leu32(hdr + 12, cf->victim_fp);
+    vsc_write_leu64(hdr + 16, cf->num_buckets);
+    vsc_write_leu64(hdr + 24, cf->size);
+    vsc_write_leu64(hdr + 32, cf->victim_bucket);
+
+    if(fwrite(hdr, sizeof(hdr), 1, f) != 1)
+        return VSC_ERROR(EIO);
+
+    for(size_t i = 0; i < cf->num_buckets; ++i) {
+        uint8_t buf[8];
+
+        vsc_write_leu64(buf, cf->buckets[i]);
+        if(fwrite(buf, sizeof(buf), 1, f) != 1)
+            return VSC_ERROR(EIO);
+    }
+
+    return 0;
+}
+
+int vsc_cuckoo_filter_loada(VscCuckooFilter **cf, const void *data, size_t size, const VscAllocator *a)
+{
+    const uint8_t   *p = data;
+    VscCuckooFilter *_cf;
+    uint64_t         num_buckets, count, victim_bucket;
+    uint32_t         victim_fp;
+
+    if(cf == NULL || a == NULL)
+        return VSC_ERROR(EINVAL);
+
+    if(p == NULL || size < CUCKOO_HEADER_SIZE)
+        return VSC_ERROR(EINVAL);
+
+    if(memcmp(p, CUCKOO_MAGIC, 8) != 0 || vsc_read_leu32(p + 8) != CUCKOO_VERSION)
+        return VSC_ERROR(EINVAL);
+
+    victim_fp     = vsc_read_leu32(p + 12);
+    num_buckets   = vsc_read_leu64(p + 16);
+    count         = vsc_read_leu64(p + 24);
+    victim_bucket = vsc_read_leu64(p + 32);
+
+    if(!VSC_IS_POT(num_buckets) || num_buckets > (size - CUCKOO_HEADER_SIZE) / sizeof(uint64_t))
+        return VSC_ERROR(EINVAL);
+
+    if(victim_fp > UINT16_MAX || victim_bucket >= num_buckets || count > num_buckets * CUCKOO_BUCKET_SIZE + 1)
+        return VSC_ERROR(EINVAL);
+
+    if((_cf = alloc_buckets((size_t)num_buckets, a)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    _cf->size          = (size_t)count;
+    _cf->victim_fp     = (uint16_t)victim_fp;
+    _cf->victim_bucket = (size_t)victim_bucket;
+
+    p += CUCKOO_HEADER_SIZE;
+    for(size_t i = 0; i < _cf->num_buckets; ++i, p += 8)
+        _cf->buckets[i] = vsc_read_leu64(p);
+
+    *cf = _cf;
+    return 0;
+}
+
+int vsc_cuckoo_filter_load(VscCuckooFilter **cf, const void *data, size_t size)
+{
+    return vsc_cuckoo_filter_loada(cf, data, size, vsclib_system_allocator);
+}
@@ -48,6 +48,8 @@ static const VscFreadallState default_state = {
     .file_size  = 0,
     .blk_size   = 4096,
     .bytes_read = 0,
+    .chunk      = NULL,
+    .chunk_size = 0,
     .statbuf    = {0},
 };
 
@@ -257,7 +259,9 @@ int vsc_freadalla_ex(void **ptr, size_t *size, FILE *f, VscFreadallInitProc init
             p = _p;
         }
 
-        state.bytes_read += fread(p + state.bytes_read, 1, state.file_size - state.bytes_read, f);
+        state.chunk      = p + state.bytes_read;
+        state.chunk_size = fread(p + state.bytes_read, 1, state.file_size - state.bytes_read, f);
+        state.bytes_read += state.chunk_size;
 
         if(chunk_proc(&state, user) < 0) {
             vsc_xfree(a, p);
@@ -18,12 +18,32 @@
  * limitations under the License.
  */
 #include <limits.h>
+#include <string.h>
+#include <assert.h>
 #include <vsclib/hash.h>
+#include <vsclib/error.h>
+#include <vsclib/platform.h>
+#include <vsclib/string.h>
 
 #define XXH_STATIC_LINKING_ONLY
 #define XXH_IMPLEMENTATION
 #include "xxhash.h"
 
+#if defined(_WIN64) || LONG_MAX == 9223372036854775807L
+typedef XXH3_state_t hash_state_t;
+#else /* LONG_MAX == 2147483647L */
+typedef XXH32_state_t hash_state_t;
+#endif
+
+/*
+ * The states are stored in-place, so plain struct copies work. XXH3_state_t only
+ * holds pointers to static data, so it's position-independent.
+ */
+static_assert(sizeof(VscHashState) >= sizeof(hash_state_t), "VscHashState too small");
+static_assert(VSC_ALIGNOF(VscHashState) >= VSC_ALIGNOF(hash_state_t), "VscHashState underaligned");
+static_assert(sizeof(VscHash128State) >= sizeof(XXH3_state_t), "VscHash128State too small");
+static_assert(VSC_ALIGNOF(VscHash128State) >= VSC_ALIGNOF(XXH3_state_t), "VscHash128State underaligned");
+
 vsc_hash_t vsc_hash(const void *data, size_t size)
 {
     if(data == NULL && size != 0)
@@ -40,6 +60,23 @@ vsc_hash_t vsc_hash(const void *data, size_t size)
 #endif
 }
 
+vsc_hash_t vsc_hash_seeded(const void *data, size_t size, uint64_t seed)
+{
+    if(data == NULL && size != 0)
+        return VSC_INVALID_HASH;
+
+#if defined(_WIN64) || LONG_MAX == 9223372036854775807L
+    return XXH3_64bits_withSeed(data, size, seed);
+#else /* LONG_MAX == 2147483647L */
+    return XXH32(data, size, (uint32_t)(seed ^ (seed >> 32)));
+#endif
+}
+
+uint64_t vsc_hash64(const void *data, size_t size, uint64_t seed)
+{
+    return XXH3_64bits_withSeed(data, size, seed);
+}
+
 vsc_hash_t vsc_hash_string(const char *s)
 {
     if(s == NULL)
@@ -47,3 +84,180 @@ vsc_hash_t vsc_hash_string(const char *s)
 
     return vsc_hash(s, strlen(s));
 }
+
+vsc_hash_t vsc_hash_string_seeded(const char *s, uint64_t seed)
+{
+    if(s == NULL)
+        return VSC_INVALID_HASH;
+
+    return vsc_hash_seeded(s, strlen(s), seed);
+}
+
+static hash_state_t *get_state(const VscHashState *state)
+{
+    return (hash_state_t *)state->opaque;
+}
+
+void vsc_hash_state_init(VscHashState *state)
+{
+    vsc_hash_state_init_seeded(state, 0);
+}
+
+void vsc_hash_state_init_seeded(VscHashState *state, uint64_t seed)
+{
+    hash_state_t *st = get_state(state);
+
+    /* XXH3 peeks at the previous seed, make sure there isn't one. */
+    memset(st, 0, sizeof(hash_state_t));
+
+#if defined(_WIN64) || LONG_MAX == 9223372036854775807L
+    (void)XXH3_64bits_reset_withSeed(st, seed);
+#else /* LONG_MAX == 2147483647L */
+    (void)XXH32_reset(st, (uint32_t)(seed ^ (seed >> 32)));
+#endif
+}
+
+int vsc_hash_state_update(VscHashState *state, const void *data, size_t size)
+{
+    if(data == NULL && size != 0)
+        return VSC_ERROR(EINVAL);
+
+    if(size == 0)
+        return 0;
+
+#if defined(_WIN64) || LONG_MAX == 9223372036854775807L
+    (void)XXH3_64bits_update(get_state(state), data, size);
+#else /* LONG_MAX == 2147483647L */
+    (void)XXH32_update(get_state(state), data, size);
+#endif
+    return 0;
+}
+
+vsc_hash_t vsc_hash_state_digest(const VscHashState *state)
+{
+#if defined(_WIN64) || LONG_MAX == 9223372036854775807L
+    return XXH3_64bits_digest(get_state(state));
+#else /* LONG_MAX == 2147483647L */
+    return XXH32_digest(get_state(state));
+#endif
+}
+
+void vsc_hash_state_copy(VscHashState *dst, const VscHashState *src)
+{
+    *dst = *src;
+}
+
+static VscHash128 from_xxh128(XXH128_hash_t h)
+{
+    return (VscHash128){.low = h.low64, .high = h.high64};
+}
+
+VscHash128 vsc_hash128(const void *data, size_t size)
+{
+    return vsc_hash128_seeded(data, size, 0);
+}
+
+VscHash128 vsc_hash128_seeded(const void *data, size_t size, uint64_t seed)
+{
+    if(data == NULL && size != 0)
+        return (VscHash128){.low = ~(uint64_t)0, .high = ~(uint64_t)0};
+
+    return from_xxh128(XXH3_128bits_withSeed(data, size, seed));
+}
+
+static XXH3_state_t *get_state128(const VscHash128State *state)
+{
+    return (XXH3_state_t *)state->opaque;
+}
+
+void vsc_hash128_state_init(VscHash128State *state)
+{
+    vsc_hash128_state_init_seeded(state, 0);
+}
+
+void vsc_hash128_state_init_seeded(VscHash128State *state, uint64_t seed)
+{
+    XXH3_state_t *st = get_state128(state);
+
+    memset(st, 0, sizeof(XXH3_state_t));
+    (void)XXH3_128bits_reset_withSeed(st, seed);
+}
+
+int vsc_hash128_state_update(VscHash128State *state, const void *data, size_t size)
+{
+    if(data == NULL && size != 0)
+        return VSC_ERROR(EINVAL);
+
+    if(size == 0)
+        return 0;
+
+    (void)XXH3_128bits_update(get_state128(state), data, size);
+    return 0;
+}
+
+VscHash128 vsc_hash128_state_digest(const VscHash128State *state)
+{
+    return from_xxh128(XXH3_128bits_digest(get_state128(state)));
+}
+
+void vsc_hash128_state_copy(VscHash128State *dst, const VscHash128State *src)
+{
+    *dst = *src;
+}
+
+int vsc_hash128_compare(const VscHash128 *a, const VscHash128 *b)
+{
+    if(a->high != b->high)
+        return a->high < b->high ? -1 : 1;
+
+    if(a->low != b->low)
+        return a->low < b->low ? -1 : 1;
+
+    return 0;
+}
+
+char *vsc_hash128_format(char *dst, const VscHash128 *hash)
+{
+    static const char *alphabet = "0123456789abcdef";
+
+    for(int i = 0; i < 16; ++i) {
+        dst[i]      = alphabet[(hash->high >> (60 - 4 * i)) & 0xF];
+        dst[i + 16] = alphabet[(hash->low >> (60 - 4 * i)) & 0xF];
+    }
+
+    dst[32] = '\0';
+    return dst;
+}
+
+static uint64_t denibble(char c)
+{
+    if(vsc_isdigit(c))
+        return c - '0';
+
+    if(c >= 'a')
+        return 0xA + c - 'a';
+
+    return 0xA + c - 'A';
+}
+
+int vsc_hash128_parse(VscHash128 *hash, const char *s)
+{
+    uint64_t v[2] = {0, 0};
+
+    if(hash == NULL || s == NULL)
+        return VSC_ERROR(EINVAL);
+
+    for(size_t i = 0; i < 32; ++i) {
+        if(!vsc_isxdigit(s[i]))
+            return VSC_ERROR(EINVAL);
+
+        v[i / 16] = (v[i / 16] << 4) | denibble(s[i]);
+    }
+
+    if(s[32] != '\0')
+        return VSC_ERROR(EINVAL);
+
+    hash->high = v[0];
+    hash->low  = v[1];
+    return 0;
+}
@@ -22,31 +22,37 @@
 #include <vsclib/error.h>
 #include <vsclib/hash.h>
 #include <vsclib/hashmap.h>
+#include <vsclib/bloom_filter.h>
+#include <vsclib/cuckoo_filter.h>
+#include "hashmap_internal.h"
+#include "random_internal.h"
+#include "atomic_internal.h"
+
+#if VSC_HAVE_INTRIN_H
+#include <intrin.h>
+#endif
 
 #define VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION 16
 
-struct VscHashMap {
-    size_t                 size;
-    size_t                 num_buckets;
-    VscHashMapBucket      *buckets;
-    VscHashMapResizePolicy resize_policy;
-    struct {
-        uint16_t num, den;
-    } load_min;
-    struct {
-        uint16_t num, den;
-    } load_max;
-    VscHashMapHashProc    hash_proc;
-    VscHashMapCompareProc compare_proc;
-    const VscAllocator   *allocator;
-};
+/*
+ * The number of lookups vsc_hashmap_find_batch() keeps in flight.
+ * Should be large enough to cover memory latency, but small enough
+ * that the prefetched lines aren't evicted before they're used.
+ */
+#define VSC_HASHMAP_BATCH_SIZE 16
+
+/*
+ * The number of keys each task hashes in vsc_hashmap_build_parallel().
+ * Large enough that the task overhead doesn't matter.
+ */
+#define VSC_HASHMAP_BUILD_CHUNK_SIZE 16384
 
 /* This should be optimised out in Release builds. */
 static inline void validate(const VscHashMap *hm)
 {
     vsc_assert(hm != NULL);
     vsc_assert(hm->size <= hm->num_buckets);
-    vsc_assert(hm->hash_proc != NULL);
+    vsc_assert(hm->hash_proc != NULL || hm->seeded_hash_proc != NULL);
     vsc_assert(hm->compare_proc != NULL);
     vsc_assert(hm->allocator != NULL);
     vsc_assert(hm->load_min.den > 0);
@@ -54,6 +60,21 @@ static inline void validate(const VscHashMap *hm)
     vsc_assert(hm->load_max.den > 0);
     vsc_assert(hm->load_max.num < hm->load_max.den);
     vsc_assert(hm->load_min.num * hm->load_max.den <= hm->load_max.num * hm->load_max.den);
+    vsc_assert(hm->layout != VSC_HASHMAP_LAYOUT_COMPACT || hm->buckets == NULL);
+    vsc_assert(hm->layout != VSC_HASHMAP_LAYOUT_BUCKETS || hm->tags == NULL);
+    vsc_assert(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS || hm->key_buckets == NULL);
+    vsc_assert(hm->layout != VSCI_HASHMAP_LAYOUT_KEYS || (hm->buckets == NULL && hm->tags == NULL));
+}
+
+static inline void prefetch(const void *p)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && VSC_HAVE_INTRIN_H && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch((const char *)p, _MM_HINT_T0);
+#else
+    (void)p;
+#endif
 }
 
 static inline VscHashMapBucket *reset_bucket(VscHashMapBucket *bkt)
@@ -64,445 +85,1746 @@ static inline VscHashMapBucket *reset_bucket(VscHashMapBucket *bkt)
     return bkt;
 }
 
-vsc_hash_t vsc_hashmap_hash(const VscHashMap *hm, const void *key)
+static inline VscHashMapKeyBucket *reset_key_bucket(VscHashMapKeyBucket *bkt)
 {
-    vsc_hash_t hash = hm->hash_proc(key);
-    vsc_assert(hash != VSC_INVALID_HASH);
-    return hash;
+    bkt->hash = VSC_INVALID_HASH;
+    bkt->key  = NULL;
+    return bkt;
 }
 
-int vsc_hashmap_compare(const VscHashMap *hm, const void *a, const void *b)
+/*
+ * Fold a hash into a 32-bit tag for the compact layout.
+ * A tag of 0 marks an empty slot, so it's never generated.
+ */
+static inline uint32_t make_tag(vsc_hash_t hash)
 {
-    return hm->compare_proc(a, b) != 0;
+    uint32_t tag;
+
+#if VSC_SIZEOF_SIZE_T > 4
+    tag = (uint32_t)(hash ^ (hash >> 32));
+#else
+    tag = (uint32_t)hash;
+#endif
+
+    return tag != 0 ? tag : 1;
 }
 
-VscHashMap *vsc_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a)
+/*
+ * Slot accessors, these hide the difference between the layouts.
+ *
+ * The "probe hash" of a slot is what's actually stored, and is used to
+ * determine its home slot. It's the full hash for VSC_HASHMAP_LAYOUT_BUCKETS
+ * and the tag for VSC_HASHMAP_LAYOUT_COMPACT.
+ */
+static inline vsc_hash_t probe_hash(const VscHashMap *hm, vsc_hash_t hash)
 {
-    VscHashMap *hm;
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return make_tag(hash);
 
-    vsc_assert(hash != NULL);
-    vsc_assert(compare != NULL);
-    vsc_assert(a != NULL);
+    return hash;
+}
 
-    if((hm = vsc_xalloc(a, sizeof(VscHashMap))) == NULL)
-        return NULL;
+static inline int slot_empty(const VscHashMap *hm, size_t i)
+{
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return hm->tags[i] == 0;
 
-    *hm = (VscHashMap){
-        .size          = 0,
-        .num_buckets   = 0,
-        .buckets       = NULL,
-        .resize_policy = VSC_HASHMAP_RESIZE_LOAD_FACTOR,
-        .load_min.num  = 1,
-        .load_min.den  = 2,
-        .load_max.num  = 3,
-        .load_max.den  = 4,
-        .hash_proc     = hash,
-        .compare_proc  = compare,
-        .allocator     = a,
-    };
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+        return hm->key_buckets[i].hash == VSC_INVALID_HASH;
 
-    return hm;
+    return hm->buckets[i].hash == VSC_INVALID_HASH;
 }
 
-VscHashMap *vsc_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare)
+static inline vsc_hash_t slot_hash(const VscHashMap *hm, size_t i)
 {
-    return vsc_hashmap_alloca(hash, compare, vsclib_system_allocator);
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return hm->tags[i];
+
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+        return hm->key_buckets[i].hash;
+
+    return hm->buckets[i].hash;
 }
 
-void vsc_hashmap_free(VscHashMap *hm)
+static inline const void *slot_key(const VscHashMap *hm, size_t i)
 {
-    validate(hm);
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return hm->keys[i];
 
-    vsc_hashmap_reset(hm);
-    vsc_xfree(hm->allocator, hm);
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+        return hm->key_buckets[i].key;
+
+    return hm->buckets[i].key;
 }
 
-int vsc_hashmap_clear(VscHashMap *hm)
+static inline void *slot_value(const VscHashMap *hm, size_t i)
 {
-    validate(hm);
-    hm->size = 0;
-    for(size_t i = 0; i < hm->num_buckets; ++i)
-        reset_bucket(hm->buckets + i);
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return hm->values[i];
 
-    return 0;
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+        return NULL;
+
+    return hm->buckets[i].value;
 }
 
-int vsc_hashmap_configure(VscHashMap *hm, uint16_t min_num, uint16_t min_den, uint16_t max_num, uint16_t max_den)
+static inline void slot_set_value(VscHashMap *hm, size_t i, void *value)
 {
-    uint32_t numa, numb;
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        hm->values[i] = value;
+    else if(hm->layout == VSC_HASHMAP_LAYOUT_BUCKETS)
+        hm->buckets[i].value = value;
+}
 
-    if(min_num == 0 || min_den == 0 || min_num >= min_den)
-        return VSC_ERROR(EINVAL);
+static inline void slot_set(VscHashMap *hm, size_t i, vsc_hash_t phash, const void *key, void *value)
+{
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT) {
+        hm->tags[i]   = (uint32_t)phash;
+        hm->keys[i]   = key;
+        hm->values[i] = value;
+        return;
+    }
 
-    if(max_num == 0 || max_den == 0 || max_num >= max_den)
-        return VSC_ERROR(EINVAL);
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS) {
+        hm->key_buckets[i].hash = phash;
+        hm->key_buckets[i].key  = key;
+        return;
+    }
 
-    validate(hm);
+    hm->buckets[i].hash  = phash;
+    hm->buckets[i].key   = key;
+    hm->buckets[i].value = value;
+}
 
-    /*
-     * Convert the fractions to the same base so we can
-     * compare their numerators.
-     *
-     * a     c   a * d     c * b
-     * - and - = ----- and -----
-     * b     d   b * d     d * b
-     */
-    numa = min_num * max_den;
-    numb = max_num * min_den;
+static inline void slot_reset(VscHashMap *hm, size_t i)
+{
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT) {
+        hm->tags[i]   = 0;
+        hm->keys[i]   = NULL;
+        hm->values[i] = NULL;
+        return;
+    }
 
-    if(numa > numb)
-        return VSC_ERROR(EINVAL);
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS) {
+        reset_key_bucket(hm->key_buckets + i);
+        return;
+    }
 
-    hm->load_min.num = min_num;
-    hm->load_min.den = min_den;
-    hm->load_max.num = max_num;
-    hm->load_max.den = max_den;
-    return 0;
+    reset_bucket(hm->buckets + i);
 }
 
-void vsc_hashmap_reset(VscHashMap *hm)
+static inline void slot_move(VscHashMap *hm, size_t dst, size_t src)
 {
-    validate(hm);
-
-    vsc_xfree(hm->allocator, hm->buckets);
-    hm->num_buckets = 0;
-    hm->buckets     = NULL;
+    slot_set(hm, dst, slot_hash(hm, src), slot_key(hm, src), slot_value(hm, src));
+    slot_reset(hm, src);
 }
 
 /*
- * Circularly loop over each of the buckets, starting at index `start`.
+ * Allocate uninitialised storage for `n` buckets of `layout` into `dst`, using allocator `a`.
+ * Only the storage pointers of `dst` are touched.
  */
-#define LOOP_BUCKETS(hm, idxname, start)                                                \
-    for(size_t _i = 0, (idxname) = (start) % (hm)->num_buckets; _i < (hm)->num_buckets; \
-        ++_i, (idxname)          = ((idxname) + 1) % (hm)->num_buckets)
-
-static VscHashMapBucket *add_or_replace_bucket(const VscHashMap *hm, VscHashMapBucket *buckets, size_t n,
-                                               const VscHashMapBucket *bkt, int *added)
+static int alloc_storage(VscHashMap *dst, VscHashMapLayout layout, size_t n, const VscAllocator *a)
 {
+    dst->buckets     = NULL;
+    dst->key_buckets = NULL;
+    dst->tags        = NULL;
+    dst->keys        = NULL;
+    dst->values      = NULL;
+
     if(n == 0)
-        return NULL;
+        return 0;
 
-    LOOP_BUCKETS(hm, index, bkt->hash % n)
-    {
-        VscHashMapBucket *b = buckets + index;
+    if(layout == VSC_HASHMAP_LAYOUT_COMPACT) {
+        void             *ptrs[3];
+        int               r;
+        VscBlockAllocInfo bai[3] = {
+            {n, sizeof(uint32_t),     0,                          NULL},
+            {n, sizeof(const void *), VSC_ALIGNOF(const void *), NULL},
+            {n, sizeof(void *),       VSC_ALIGNOF(void *),        NULL},
+        };
 
-        /* Shortcut: use first empty bucket. */
-        if(b->hash == VSC_INVALID_HASH) {
-            *added = 1;
-            *b     = *bkt;
-            return b;
-        }
+        if((r = vsc_block_xalloc(a, ptrs, bai, 3, 0)) < 0)
+            return r;
 
-        if(b->hash != bkt->hash)
-            continue;
+        dst->tags   = ptrs[0];
+        dst->keys   = ptrs[1];
+        dst->values = ptrs[2];
+        return 0;
+    }
 
-        /* Duplicate key, replace it. */
-        if(vsc_hashmap_compare(hm, bkt->key, b->key)) {
-            *added = 0;
-            *b     = *bkt;
-            return b;
-        }
+    if(layout == VSCI_HASHMAP_LAYOUT_KEYS) {
+        if((dst->key_buckets = vsc_xalloc(a, sizeof(VscHashMapKeyBucket) * n)) == NULL)
+            return VSC_ERROR(ENOMEM);
+
+        return 0;
     }
 
-    *added = 0;
-    return NULL;
+    if((dst->buckets = vsc_xalloc(a, sizeof(VscHashMapBucket) * n)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    return 0;
 }
 
-int vsc_hashmap_resize(VscHashMap *hm, size_t nelem)
+/*
+ * Copy the storage of `src` into `dst`, using allocator `a`.
+ * Only the storage pointers of `dst` are touched.
+ */
+static int copy_storage(VscHashMap *dst, const VscHashMap *src, const VscAllocator *a)
 {
-    VscHashMapBucket *bkts, *tmpbkts;
-
-    validate(hm);
+    size_t n = src->num_buckets;
+    int    r;
 
-    if(nelem == 0 || nelem < hm->size)
-        return VSC_ERROR(EINVAL);
+    if((r = alloc_storage(dst, src->layout, n, a)) < 0)
+        return r;
 
-    /* Nothing to do. */
-    if(nelem == hm->size)
+    if(n == 0)
         return 0;
 
-    /* Make sure the realloc() size won't overflow. */
-    if(nelem >= (SIZE_MAX / sizeof(VscHashMapBucket)))
-        return VSC_ERROR(ERANGE);
+    if(src->layout == VSC_HASHMAP_LAYOUT_COMPACT) {
+        memcpy(dst->tags, src->tags, sizeof(uint32_t) * n);
+        memcpy(dst->keys, src->keys, sizeof(const void *) * n);
+        memcpy(dst->values, src->values, sizeof(void *) * n);
+    } else if(src->layout == VSCI_HASHMAP_LAYOUT_KEYS) {
+        memcpy(dst->key_buckets, src->key_buckets, sizeof(VscHashMapKeyBucket) * n);
+    } else {
+        memcpy(dst->buckets, src->buckets, sizeof(VscHashMapBucket) * n);
+    }
 
-    /* Reallocate the buckets. */
-    bkts = vsc_xrealloc(hm->allocator, hm->buckets, sizeof(VscHashMapBucket) * nelem);
-    if(bkts == NULL)
-        return VSC_ERROR(ENOMEM);
+    return 0;
+}
 
-    hm->buckets = bkts;
+/*
+ * Let go of the storage, freeing it if nobody else is using it.
+ * The storage pointers are left dangling.
+ */
+static void release_storage(VscHashMap *hm)
+{
+    if(hm->refs != NULL) {
+        size_t *refs = hm->refs;
 
-    for(size_t i = hm->num_buckets; i < nelem; ++i)
-        reset_bucket(hm->buckets + i);
+        hm->refs = NULL;
+        if(vsci_atomic_fetch_sub_size(refs, 1) != 1)
+            return;
 
-    /* Shortcut - no items. no problem! */
-    if(hm->size == 0) {
-        hm->num_buckets = nelem;
-        return 0;
+        vsc_xfree(hm->allocator, refs);
     }
 
+    vsc_xfree(hm->allocator, hm->buckets);
+    vsc_xfree(hm->allocator, hm->key_buckets);
+    vsc_xfree(hm->allocator, hm->tags);
+}
+
+/*
+ * Make sure the storage is ours alone, copying it if needed.
+ * Must be called before anything is written to it.
+ */
+static int unshare(VscHashMap *hm)
+{
+    VscHashMap tmp;
+    int        r;
+
+    if(hm->refs == NULL)
+        return 0;
+
     /*
-     * Allocate a temp bucket list (hue) to work with. Note that this
-     * needs to be done after the hm->buckets alloc to play nice to linear
-     * allocators.
+     * Everyone else has let go. Another reference can only
+     * be taken through this map, so there's no race here.
      */
-    tmpbkts = vsc_xcalloc(hm->allocator, nelem, sizeof(VscHashMapBucket));
-    if(tmpbkts == NULL) {
-
-        /*
-         * This is a bit of a sticky situation - allocation has failed,
-         * and now we have more buckets that we can't redistribute in to.
-         * This also means it's not safe to rely on another realloc to shrink
-         * it again.
-         *
-         * Our only safe option is to waste the new memory :(
-         */
-        return VSC_ERROR(ENOMEM);
+    if(vsci_atomic_load_size(hm->refs) == 1) {
+        vsc_xfree(hm->allocator, hm->refs);
+        hm->refs = NULL;
+        return 0;
     }
 
-    hm->num_buckets = nelem;
+    if((r = copy_storage(&tmp, hm, hm->allocator)) < 0)
+        return r;
 
-    for(size_t i = 0; i < nelem; ++i)
-        reset_bucket(tmpbkts + i);
+    release_storage(hm);
 
-    /* Now redistribute everything. */
-    for(size_t i = 0; i < nelem; ++i) {
-        int               added;
-        VscHashMapBucket *bkt = hm->buckets + i;
-        if(bkt->hash == VSC_INVALID_HASH)
-            continue;
+    hm->buckets     = tmp.buckets;
+    hm->key_buckets = tmp.key_buckets;
+    hm->tags        = tmp.tags;
+    hm->keys        = tmp.keys;
+    hm->values      = tmp.values;
+    return 0;
+}
 
-        added = 0;
-        bkt   = add_or_replace_bucket(hm, tmpbkts, nelem, hm->buckets + i, &added);
-        vsc_assert(bkt != NULL);
+/*
+ * Filter accessors. These take the full hash, not the probe hash.
+ */
+static inline int filter_rejects(const VscHashMap *hm, vsc_hash_t hash)
+{
+    if(hm->bloom != NULL)
+        return !vsc_bloom_filter_contains_hash(hm->bloom, hash);
+
+    if(hm->cuckoo != NULL)
+        return !vsc_cuckoo_filter_contains_hash(hm->cuckoo, hash);
+
+    return 0;
+}
+
+static int probe_slot(const VscHashMap *hm, const void *key, vsc_hash_t hash, size_t *outindex);
+
+/*
+ * Can `key` be added or replaced without overflowing the filter? Check this before changing
+ * anything, so a full filter never leaves a key in the map it doesn't know about.
+ * Replacing a value doesn't touch the filter, so only a new key needs room.
+ */
+static inline int filter_check(const VscHashMap *hm, const void *key, vsc_hash_t hash)
+{
+    size_t index;
+
+    if(hm->cuckoo == NULL || !vsc_cuckoo_filter_full(hm->cuckoo))
+        return 0;
+
+    if(probe_slot(hm, key, hash, &index))
+        return 0;
+
+    return VSC_ERROR(ENOSPC);
+}
+
+static inline void filter_add(VscHashMap *hm, vsc_hash_t hash)
+{
+    int r;
+
+    (void)r;
+
+    if(hm->bloom != NULL)
+        vsc_bloom_filter_insert_hash(hm->bloom, hash);
+
+    if(hm->cuckoo != NULL) {
+        r = vsc_cuckoo_filter_insert_hash(hm->cuckoo, hash);
+        vsc_assert(r == 0);
     }
+}
 
-    memcpy(hm->buckets, tmpbkts, sizeof(VscHashMapBucket) * nelem);
-    vsc_xfree(hm->allocator, tmpbkts);
+static inline void filter_remove(VscHashMap *hm, vsc_hash_t hash)
+{
+    if(hm->cuckoo != NULL)
+        (void)vsc_cuckoo_filter_remove_hash(hm->cuckoo, hash);
+}
+
+static inline void filter_clear(VscHashMap *hm)
+{
+    if(hm->bloom != NULL)
+        vsc_bloom_filter_clear(hm->bloom);
+
+    if(hm->cuckoo != NULL)
+        vsc_cuckoo_filter_clear(hm->cuckoo);
+}
+
+vsc_hash_t vsc_hashmap_hash(const VscHashMap *hm, const void *key)
+{
+    vsc_hash_t hash;
+
+    if(hm->seeded_hash_proc != NULL)
+        hash = hm->seeded_hash_proc(key, hm->seed);
+    else
+        hash = hm->hash_proc(key);
+
+    vsc_assert(hash != VSC_INVALID_HASH);
+    return hash;
+}
+
+int vsc_hashmap_compare(const VscHashMap *hm, const void *a, const void *b)
+{
+    return hm->compare_proc(a, b) != 0;
+}
+
+void vsci_hashmap_init(VscHashMap *hm, VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                       VscHashMapLayout layout, const VscAllocator *a)
+{
+    vsc_assert(hm != NULL);
+    vsc_assert(compare != NULL);
+    vsc_assert(a != NULL);
+
+    *hm = (VscHashMap){
+        .size             = 0,
+        .num_buckets      = 0,
+        .layout           = layout,
+        .num_resizes      = 0,
+        .num_rehashed     = 0,
+        .buckets          = NULL,
+        .key_buckets      = NULL,
+        .tags             = NULL,
+        .keys             = NULL,
+        .values           = NULL,
+        .resize_policy    = VSC_HASHMAP_RESIZE_LOAD_FACTOR,
+        .load_min.num     = 1,
+        .load_min.den     = 2,
+        .load_max.num     = 3,
+        .load_max.den     = 4,
+        .hash_proc        = hash,
+        .seeded_hash_proc = NULL,
+        .seed             = 0,
+        .compare_proc     = compare,
+        .allocator        = a,
+        .refs             = NULL,
+        .bloom            = NULL,
+        .cuckoo           = NULL,
+    };
+}
+
+void vsci_hashmap_init_seeded(VscHashMap *hm, VscHashMapSeededHashProc hash)
+{
+    vsc_assert(hm != NULL);
+    vsc_assert(hash != NULL);
+    vsc_assert(hm->size == 0);
+
+    hm->hash_proc        = NULL;
+    hm->seeded_hash_proc = hash;
+    hm->seed             = vsci_random_seed();
+}
+
+VscHashMap *vsc_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a)
+{
+    VscHashMap *hm;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(a != NULL);
+
+    if((hm = vsc_xalloc(a, sizeof(VscHashMap))) == NULL)
+        return NULL;
+
+    vsci_hashmap_init(hm, hash, compare, VSC_HASHMAP_LAYOUT_BUCKETS, a);
+    return hm;
+}
+
+VscHashMap *vsc_hashmap_alloca_seeded(VscHashMapSeededHashProc hash, VscHashMapCompareProc compare,
+                                      const VscAllocator *a)
+{
+    VscHashMap *hm;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(a != NULL);
+
+    if((hm = vsc_xalloc(a, sizeof(VscHashMap))) == NULL)
+        return NULL;
+
+    vsci_hashmap_init(hm, NULL, compare, VSC_HASHMAP_LAYOUT_BUCKETS, a);
+    vsci_hashmap_init_seeded(hm, hash);
+    return hm;
+}
+
+VscHashMap *vsc_hashmap_alloc_seeded(VscHashMapSeededHashProc hash, VscHashMapCompareProc compare)
+{
+    return vsc_hashmap_alloca_seeded(hash, compare, vsclib_system_allocator);
+}
+
+uint64_t vsc_hashmap_seed(const VscHashMap *hm)
+{
+    validate(hm);
+    return hm->seed;
+}
+
+int vsc_hashmap_set_seed(VscHashMap *hm, uint64_t seed)
+{
+    validate(hm);
+
+    /* Everything stored would need rehashing. */
+    if(hm->size != 0)
+        return VSC_ERROR(EBUSY);
+
+    hm->seed = seed;
+    return 0;
+}
+
+VscHashMap *vsc_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare)
+{
+    return vsc_hashmap_alloca(hash, compare, vsclib_system_allocator);
+}
+
+VscHashMap *vsc_hashmap_clonea(const VscHashMap *hm, const VscAllocator *a)
+{
+    VscHashMap *clone;
+
+    validate(hm);
+    vsc_assert(a != NULL);
+
+    if((clone = vsc_xalloc(a, sizeof(VscHashMap))) == NULL)
+        return NULL;
+
+    *clone           = *hm;
+    clone->allocator = a;
+    clone->refs      = NULL;
+    clone->bloom     = NULL;
+    clone->cuckoo    = NULL;
+
+    /* The hashes are all stored, so the storage is copied as-is. */
+    if(copy_storage(clone, hm, a) < 0) {
+        vsc_xfree(a, clone);
+        return NULL;
+    }
+
+    return clone;
+}
+
+VscHashMap *vsc_hashmap_clone(const VscHashMap *hm)
+{
+    validate(hm);
+    return vsc_hashmap_clonea(hm, hm->allocator);
+}
+
+VscHashMap *vsc_hashmap_clone_shared(VscHashMap *hm)
+{
+    VscHashMap *clone;
+
+    validate(hm);
+
+    /* Nothing to share. */
+    if(hm->num_buckets == 0)
+        return vsc_hashmap_clonea(hm, hm->allocator);
+
+    if((clone = vsc_xalloc(hm->allocator, sizeof(VscHashMap))) == NULL)
+        return NULL;
+
+    if(hm->refs == NULL) {
+        if((hm->refs = vsc_xalloc(hm->allocator, sizeof(size_t))) == NULL) {
+            vsc_xfree(hm->allocator, clone);
+            return NULL;
+        }
+
+        vsci_atomic_store_size(hm->refs, 1);
+    }
+
+    (void)vsci_atomic_fetch_add_size(hm->refs, 1);
+
+    *clone        = *hm;
+    clone->bloom  = NULL;
+    clone->cuckoo = NULL;
+    return clone;
+}
+
+void vsc_hashmap_free(VscHashMap *hm)
+{
+    validate(hm);
+
+    /* The filter may already be gone. */
+    vsc_hashmap_detach_filter(hm);
+    vsc_hashmap_reset(hm);
+    vsc_xfree(hm->allocator, hm);
+}
+
+int vsc_hashmap_clear(VscHashMap *hm)
+{
+    VscHashMap tmp;
+    int        r;
+
+    validate(hm);
+
+    /* Nothing needs to survive, so don't copy shared storage only to wipe it. */
+    if(hm->refs != NULL && vsci_atomic_load_size(hm->refs) != 1) {
+        if((r = alloc_storage(&tmp, hm->layout, hm->num_buckets, hm->allocator)) < 0)
+            return r;
+
+        release_storage(hm);
+
+        hm->buckets     = tmp.buckets;
+        hm->key_buckets = tmp.key_buckets;
+        hm->tags        = tmp.tags;
+        hm->keys        = tmp.keys;
+        hm->values      = tmp.values;
+    } else if((r = unshare(hm)) < 0) {
+        return r;
+    }
+
+    filter_clear(hm);
+    hm->size = 0;
+    for(size_t i = 0; i < hm->num_buckets; ++i)
+        slot_reset(hm, i);
+
+    return 0;
+}
+
+int vsc_hashmap_configure(VscHashMap *hm, uint16_t min_num, uint16_t min_den, uint16_t max_num, uint16_t max_den)
+{
+    uint32_t numa, numb;
+
+    if(min_num == 0 || min_den == 0 || min_num >= min_den)
+        return VSC_ERROR(EINVAL);
+
+    if(max_num == 0 || max_den == 0 || max_num >= max_den)
+        return VSC_ERROR(EINVAL);
+
+    validate(hm);
+
+    /*
+     * Convert the fractions to the same base so we can
+     * compare their numerators.
+     *
+     * a     c   a * d     c * b
+     * - and - = ----- and -----
+     * b     d   b * d     d * b
+     */
+    numa = min_num * max_den;
+    numb = max_num * min_den;
+
+    if(numa > numb)
+        return VSC_ERROR(EINVAL);
+
+    hm->load_min.num = min_num;
+    hm->load_min.den = min_den;
+    hm->load_max.num = max_num;
+    hm->load_max.den = max_den;
+    return 0;
+}
+
+void vsc_hashmap_reset(VscHashMap *hm)
+{
+    validate(hm);
+
+    release_storage(hm);
+    filter_clear(hm);
+    hm->size        = 0;
+    hm->num_buckets = 0;
+    hm->buckets     = NULL;
+    hm->key_buckets = NULL;
+    hm->tags        = NULL;
+    hm->keys        = NULL;
+    hm->values      = NULL;
+}
+
+VscHashMapLayout vsc_hashmap_layout(const VscHashMap *hm)
+{
+    validate(hm);
+    return hm->layout;
+}
+
+int vsc_hashmap_set_layout(VscHashMap *hm, VscHashMapLayout layout)
+{
+    validate(hm);
+
+    if(layout != VSC_HASHMAP_LAYOUT_BUCKETS && layout != VSC_HASHMAP_LAYOUT_COMPACT)
+        return VSC_ERROR(EINVAL);
+
+    if(hm->num_buckets != 0)
+        return VSC_ERROR(EBUSY);
+
+    hm->layout = layout;
+    return 0;
+}
+
+/*
+ * Circularly loop over each of the buckets, starting at index `start`.
+ */
+#define LOOP_BUCKETS(hm, idxname, start)                                                \
+    for(size_t _i = 0, (idxname) = (start) % (hm)->num_buckets; _i < (hm)->num_buckets; \
+        ++_i, (idxname)          = ((idxname) + 1) % (hm)->num_buckets)
+
+static VscHashMapBucket *add_or_replace_bucket(const VscHashMap *hm, VscHashMapBucket *buckets, size_t n,
+                                               const VscHashMapBucket *bkt, int *added)
+{
+    if(n == 0)
+        return NULL;
+
+    LOOP_BUCKETS(hm, index, bkt->hash % n)
+    {
+        VscHashMapBucket *b = buckets + index;
+
+        /* Shortcut: use first empty bucket. */
+        if(b->hash == VSC_INVALID_HASH) {
+            *added = 1;
+            *b     = *bkt;
+            return b;
+        }
+
+        if(b->hash != bkt->hash)
+            continue;
+
+        /* Duplicate key, replace it. */
+        if(vsc_hashmap_compare(hm, bkt->key, b->key)) {
+            *added = 0;
+            *b     = *bkt;
+            return b;
+        }
+    }
+
+    *added = 0;
+    return NULL;
+}
+
+static int add_or_replace(VscHashMap *hm, vsc_hash_t phash, const void *key, void *value, int *added)
+{
+    if(hm->num_buckets == 0)
+        return VSC_ERROR(ENOSPC);
+
+    LOOP_BUCKETS(hm, index, phash % hm->num_buckets)
+    {
+        /* Shortcut: use first empty bucket. */
+        if(slot_empty(hm, index)) {
+            *added = 1;
+            slot_set(hm, index, phash, key, value);
+            return 0;
+        }
+
+        if(slot_hash(hm, index) != phash)
+            continue;
+
+        /* Duplicate key, replace it. */
+        if(vsc_hashmap_compare(hm, key, slot_key(hm, index))) {
+            *added = 0;
+            slot_set(hm, index, phash, key, value);
+            return 0;
+        }
+    }
+
+    *added = 0;
+    return VSC_ERROR(ENOSPC);
+}
+
+/*
+ * Resize a compact map to `nelem` slots.
+ *
+ * The slots are always moved into a new block, as their offsets change with the
+ * count. The tags are all that's needed to redistribute them, so no rehashing
+ * or key comparisons are done.
+ *
+ * Unlike the bucket layout, the old block is freed after the new one is allocated,
+ * so this isn't friendly to linear allocators.
+ */
+static int resize_compact(VscHashMap *hm, size_t nelem)
+{
+    void             *ptrs[3];
+    uint32_t         *tags;
+    const void      **keys;
+    void            **values;
+    int               r;
+    VscBlockAllocInfo bai[3] = {
+        {nelem, sizeof(uint32_t),     0,                          NULL},
+        {nelem, sizeof(const void *), VSC_ALIGNOF(const void *), NULL},
+        {nelem, sizeof(void *),       VSC_ALIGNOF(void *),        NULL},
+    };
+
+    if(nelem >= SIZE_MAX / (sizeof(uint32_t) + sizeof(const void *) + sizeof(void *)))
+        return VSC_ERROR(ERANGE);
+
+    if((r = vsc_block_xalloc(hm->allocator, ptrs, bai, 3, VSC_ALLOC_ZERO)) < 0)
+        return r;
+
+    tags   = ptrs[0];
+    keys   = ptrs[1];
+    values = ptrs[2];
+
+    for(size_t i = 0; i < hm->num_buckets; ++i) {
+        size_t index;
+
+        if(hm->tags[i] == 0)
+            continue;
+
+        for(index = hm->tags[i] % nelem; tags[index] != 0; index = (index + 1) % nelem)
+            ;
+
+        tags[index]   = hm->tags[i];
+        keys[index]   = hm->keys[i];
+        values[index] = hm->values[i];
+    }
+
+    release_storage(hm);
+
+    hm->num_buckets = nelem;
+    hm->tags        = tags;
+    hm->keys        = keys;
+    hm->values      = values;
+    return 0;
+}
+
+/*
+ * Move everything in a keys-only map into a fresh block of `nelem` buckets,
+ * keeping only those accepted by `keep`, if given.
+ *
+ * Like resize_compact(), the old block is freed after the new one is allocated.
+ */
+static int rehash_keys(VscHashMap *hm, size_t nelem, int (*keep)(const VscHashMap *, size_t, void *), void *user)
+{
+    VscHashMapKeyBucket *bkts;
+    size_t               size = 0;
+
+    if(nelem >= SIZE_MAX / sizeof(VscHashMapKeyBucket))
+        return VSC_ERROR(ERANGE);
+
+    if((bkts = vsc_xalloc(hm->allocator, sizeof(VscHashMapKeyBucket) * nelem)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    for(size_t i = 0; i < nelem; ++i)
+        reset_key_bucket(bkts + i);
+
+    for(size_t i = 0; i < hm->num_buckets; ++i) {
+        const VscHashMapKeyBucket *bkt = hm->key_buckets + i;
+        size_t                     index;
+
+        if(bkt->hash == VSC_INVALID_HASH)
+            continue;
+
+        if(keep != NULL && !keep(hm, i, user))
+            continue;
+
+        for(index = bkt->hash % nelem; bkts[index].hash != VSC_INVALID_HASH; index = (index + 1) % nelem)
+            ;
+
+        bkts[index] = *bkt;
+        ++size;
+    }
+
+    release_storage(hm);
+
+    hm->size        = size;
+    hm->num_buckets = nelem;
+    hm->key_buckets = bkts;
+    return 0;
+}
+
+/*
+ * Shrink the bucket list down to `nelem` buckets.
+ *
+ * Everything is redistributed into a temp bucket list first, so the
+ * map is left untouched if that allocation fails. It's also freed
+ * before the realloc() to play nice with linear allocators.
+ */
+static int shrink_buckets(VscHashMap *hm, size_t nelem)
+{
+    VscHashMapBucket *bkts, *tmpbkts;
+    size_t            oldn = hm->num_buckets;
+
+    vsc_assert(nelem < hm->num_buckets);
+    vsc_assert(nelem >= hm->size);
+
+    tmpbkts = vsc_xalloc(hm->allocator, sizeof(VscHashMapBucket) * nelem);
+    if(tmpbkts == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    for(size_t i = 0; i < nelem; ++i)
+        reset_bucket(tmpbkts + i);
+
+    hm->num_buckets = nelem;
+
+    for(size_t i = 0; i < oldn; ++i) {
+        int               added;
+        VscHashMapBucket *bkt = hm->buckets + i;
+        if(bkt->hash == VSC_INVALID_HASH)
+            continue;
+
+        added = 0;
+        bkt   = add_or_replace_bucket(hm, tmpbkts, nelem, bkt, &added);
+        vsc_assert(bkt != NULL);
+    }
+
+    memcpy(hm->buckets, tmpbkts, sizeof(VscHashMapBucket) * nelem);
+    vsc_xfree(hm->allocator, tmpbkts);
+
+    /*
+     * If this fails, the old block is still valid and everything we
+     * need is at the start of it. Just waste the tail.
+     */
+    if((bkts = vsc_xrealloc(hm->allocator, hm->buckets, sizeof(VscHashMapBucket) * nelem)) != NULL)
+        hm->buckets = bkts;
+
+    return 0;
+}
+
+static int resize(VscHashMap *hm, size_t nelem)
+{
+    VscHashMapBucket *bkts, *tmpbkts;
+    int               r;
+
+    if(nelem == 0 || nelem < hm->size)
+        return VSC_ERROR(EINVAL);
+
+    /* Nothing to do. */
+    if(nelem == hm->num_buckets)
+        return 0;
+
+    /* These always move into a new block, so never need to unshare. */
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return resize_compact(hm, nelem);
+
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+        return rehash_keys(hm, nelem, NULL, NULL);
+
+    /* The buckets are redistributed in place. */
+    if((r = unshare(hm)) < 0)
+        return r;
+
+    if(nelem < hm->num_buckets)
+        return shrink_buckets(hm, nelem);
+
+    /* Make sure the realloc() size won't overflow. */
+    if(nelem >= (SIZE_MAX / sizeof(VscHashMapBucket)))
+        return VSC_ERROR(ERANGE);
+
+    /* Reallocate the buckets. */
+    bkts = vsc_xrealloc(hm->allocator, hm->buckets, sizeof(VscHashMapBucket) * nelem);
+    if(bkts == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    hm->buckets = bkts;
+
+    for(size_t i = hm->num_buckets; i < nelem; ++i)
+        reset_bucket(hm->buckets + i);
+
+    /* Shortcut - no items. no problem! */
+    if(hm->size == 0) {
+        hm->num_buckets = nelem;
+        return 0;
+    }
+
+    /*
+     * Allocate a temp bucket list (hue) to work with. Note that this
+     * needs to be done after the hm->buckets alloc to play nice to linear
+     * allocators.
+     */
+    tmpbkts = vsc_xcalloc(hm->allocator, nelem, sizeof(VscHashMapBucket));
+    if(tmpbkts == NULL) {
+
+        /*
+         * This is a bit of a sticky situation - allocation has failed,
+         * and now we have more buckets that we can't redistribute in to.
+         * This also means it's not safe to rely on another realloc to shrink
+         * it again.
+         *
+         * Our only safe option is to waste the new memory :(
+         */
+        return VSC_ERROR(ENOMEM);
+    }
+
+    hm->num_buckets = nelem;
+
+    for(size_t i = 0; i < nelem; ++i)
+        reset_bucket(tmpbkts + i);
+
+    /* Now redistribute everything. */
+    for(size_t i = 0; i < nelem; ++i) {
+        int               added;
+        VscHashMapBucket *bkt = hm->buckets + i;
+        if(bkt->hash == VSC_INVALID_HASH)
+            continue;
+
+        added = 0;
+        bkt   = add_or_replace_bucket(hm, tmpbkts, nelem, hm->buckets + i, &added);
+        vsc_assert(bkt != NULL);
+    }
+
+    memcpy(hm->buckets, tmpbkts, sizeof(VscHashMapBucket) * nelem);
+    vsc_xfree(hm->allocator, tmpbkts);
+
+    // fprintf(stderr, "Resizing to %zu\n", hm->num_buckets);
+    return 0;
+}
+
+int vsc_hashmap_resize(VscHashMap *hm, size_t nelem)
+{
+    size_t oldn;
+    int    r;
+
+    validate(hm);
+
+    oldn = hm->num_buckets;
+    if((r = resize(hm, nelem)) < 0)
+        return r;
+
+    if(hm->num_buckets != oldn) {
+        ++hm->num_resizes;
+        hm->num_rehashed += hm->size;
+    }
+
+    return 0;
+}
+
+static inline int intceil(size_t *result, size_t num, size_t den)
+{
+#if 1
+    *result = (num / den) + (size_t)((num % den) != 0);
+    return 0;
+#else
+    if(num >= SIZE_MAX - (den - 1))
+        return VSC_ERROR(ERANGE);
+
+    *result = (num + den - 1) / den;
+    return 0;
+#endif
+}
+
+/*
+ * Calculate floor(n * num / den) without overflowing.
+ */
+static inline size_t mulfrac(size_t n, uint32_t num, uint32_t den)
+{
+    return (n / den) * num + (size_t)(((uint64_t)(n % den) * num) / den);
+}
+
+static int maybe_resize(VscHashMap *hm)
+{
+    size_t thresh, minreq, tmp;
+    int    r;
+
+    /*
+     * Make sure the threshold calculation doesn't overflow.
+     *
+     * If this is actively limiting your required size then either:
+     * - resize it manually using vsc_hashmap_resize(), or
+     * - use a load factor where the numerator is 1.
+     */
+    if((r = intceil(&tmp, SIZE_MAX, hm->load_max.num)) < 0)
+        return r;
+
+    if(hm->num_buckets >= tmp)
+        return VSC_ERROR(ERANGE); /* or EOVERFLOW? */
+
+    /* Same as "n * load_factor" */
+    if((r = intceil(&thresh, hm->num_buckets * hm->load_max.num, hm->load_max.den)) < 0)
+        return r;
+
+    /* Nothing to do */
+    if(hm->size < thresh)
+        return 0;
+
+    /* Don't allow resize if explicitly disabled. */
+    if(hm->resize_policy == VSC_HASHMAP_RESIZE_NONE)
+        return VSC_ERROR(EPERM);
+
+    if((r = intceil(&tmp, SIZE_MAX, hm->load_max.den)) < 0)
+        return r;
+
+    if(hm->size + 1 >= tmp)
+        return VSC_ERROR(ERANGE); /* or EOVERFLOW? */
+
+    /*
+     * Determine the minimum number of buckets required to match
+     * the target load factor, then double it.
+     */
+    if((r = intceil(&minreq, (hm->size + 1) * hm->load_min.den, hm->load_min.num)) < 0)
+        return r;
+
+    return vsc_hashmap_resize(hm, VSC_MAX(minreq, VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION));
+}
+
+/*
+ * Shrink the map if its load factor has fallen below half of the minimum.
+ *
+ * The map is shrunk so that it sits at the minimum load factor afterwards,
+ * leaving plenty of room either side before another resize is triggered.
+ */
+static int maybe_shrink(VscHashMap *hm)
+{
+    size_t thresh, minreq;
+    int    r;
+
+    if(hm->resize_policy == VSC_HASHMAP_RESIZE_NONE)
+        return 0;
+
+    if(hm->num_buckets <= VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION)
+        return 0;
+
+    thresh = mulfrac(hm->num_buckets, hm->load_min.num, hm->load_min.den * 2u);
+
+    /* Nothing to do */
+    if(hm->size >= thresh)
+        return 0;
+
+    if(hm->size >= SIZE_MAX / hm->load_min.den)
+        return VSC_ERROR(ERANGE);
+
+    if((r = intceil(&minreq, hm->size * hm->load_min.den, hm->load_min.num)) < 0)
+        return r;
+
+    minreq = VSC_MAX(minreq, VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION);
+    if(minreq >= hm->num_buckets)
+        return 0;
+
+    return vsc_hashmap_resize(hm, minreq);
+}
+
+int vsc_hashmap_shrink_to_fit(VscHashMap *hm)
+{
+    size_t minreq;
+    int    r;
+
+    validate(hm);
+
+    if(hm->size == 0) {
+        vsc_hashmap_reset(hm);
+        return 0;
+    }
+
+    if(hm->size >= SIZE_MAX / hm->load_min.den)
+        return VSC_ERROR(ERANGE);
+
+    if((r = intceil(&minreq, hm->size * hm->load_min.den, hm->load_min.num)) < 0)
+        return r;
+
+    if(minreq >= hm->num_buckets)
+        return 0;
+
+    return vsc_hashmap_resize(hm, minreq);
+}
+
+int vsc_hashmap_insert(VscHashMap *hm, const void *key, void *value)
+{
+    validate(hm);
+
+    return vsc_hashmap_insert_with_hash(hm, key, vsc_hashmap_hash(hm, key), value);
+}
+
+int vsc_hashmap_insert_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash, void *value)
+{
+    int r;
+    int added;
+
+    validate(hm);
+
+    if(hash == VSC_INVALID_HASH)
+        return VSC_ERROR(ERANGE);
+
+    /* See if we need to resize. */
+    if((r = maybe_resize(hm)) < 0) {
+        /*
+         * Resize required, but not allowed.
+         * Not an error, assume the user knows what they're doing.
+         */
+        if(r != VSC_ERROR(EPERM))
+            return r;
+    }
+
+    if((r = filter_check(hm, key, hash)) < 0)
+        return r;
+
+    if((r = unshare(hm)) < 0)
+        return r;
+
+    added = 0;
+    if((r = add_or_replace(hm, probe_hash(hm, hash), key, value, &added)) < 0)
+        return r;
+
+    if(added) {
+        ++hm->size;
+        filter_add(hm, hash);
+    }
+
+    return 0;
+}
+
+/*
+ * Make sure there's enough room for `nelem` elements without triggering
+ * an automatic resize.
+ */
+static int reserve(VscHashMap *hm, size_t nelem)
+{
+    size_t minreq;
+    int    r;
+
+    if(hm->resize_policy == VSC_HASHMAP_RESIZE_NONE)
+        return 0;
+
+    if(nelem >= SIZE_MAX / hm->load_min.den)
+        return VSC_ERROR(ERANGE);
+
+    if((r = intceil(&minreq, nelem * hm->load_min.den, hm->load_min.num)) < 0)
+        return r;
+
+    minreq = VSC_MAX(minreq, VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION);
+    if(minreq <= hm->num_buckets)
+        return 0;
+
+    return vsc_hashmap_resize(hm, minreq);
+}
+
+int vsci_hashmap_reserve(VscHashMap *hm, size_t nelem)
+{
+    validate(hm);
+    return reserve(hm, nelem);
+}
+
+static int build_hashed(VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes, void *const *values,
+                        size_t n)
+{
+    int r;
+
+    if((r = unshare(hm)) < 0)
+        return r;
+
+    for(size_t i = 0; i < n; ++i) {
+        int added = 0;
+
+        if(hashes[i] == VSC_INVALID_HASH)
+            return VSC_ERROR(ERANGE);
+
+        if((r = filter_check(hm, keys[i], hashes[i])) < 0)
+            return r;
+
+        if((r = add_or_replace(hm, probe_hash(hm, hashes[i]), keys[i], values[i], &added)) < 0)
+            return r;
+
+        if(added) {
+            ++hm->size;
+            filter_add(hm, hashes[i]);
+        }
+    }
+
+    return 0;
+}
+
+int vsc_hashmap_build(VscHashMap *hm, const void *const *keys, void *const *values, size_t n)
+{
+    vsc_hash_t hashes[VSC_HASHMAP_BATCH_SIZE];
+    int        r;
+
+    validate(hm);
+
+    if(n > SIZE_MAX - hm->size)
+        return VSC_ERROR(ERANGE);
+
+    if((r = reserve(hm, hm->size + n)) < 0)
+        return r;
+
+    /* Hash in small batches, keeping the hash procedure hot. */
+    for(size_t i = 0; i < n; i += VSC_HASHMAP_BATCH_SIZE) {
+        size_t count = VSC_MIN(n - i, VSC_HASHMAP_BATCH_SIZE);
+
+        for(size_t j = 0; j < count; ++j)
+            hashes[j] = vsc_hashmap_hash(hm, keys[i + j]);
+
+        if((r = build_hashed(hm, keys + i, hashes, values + i, count)) < 0)
+            return r;
+    }
+
+    return 0;
+}
+
+typedef struct BuildParallel {
+    const VscHashMap  *hm;
+    const void *const *keys;
+    vsc_hash_t        *hashes;
+    size_t             n;
+} BuildParallel;
+
+static void build_parallel_task(size_t i, void *arg)
+{
+    BuildParallel *bp    = arg;
+    size_t         start = i * VSC_HASHMAP_BUILD_CHUNK_SIZE;
+    size_t         end   = VSC_MIN(start + VSC_HASHMAP_BUILD_CHUNK_SIZE, bp->n);
+
+    for(size_t j = start; j < end; ++j)
+        bp->hashes[j] = vsc_hashmap_hash(bp->hm, bp->keys[j]);
+}
+
+int vsc_hashmap_build_parallel(VscHashMap *hm, const void *const *keys, void *const *values, size_t n,
+                               VscParallelForProc proc, void *user)
+{
+    BuildParallel bp;
+    size_t        num_chunks;
+    int           r;
+
+    validate(hm);
+
+    num_chunks = (n + VSC_HASHMAP_BUILD_CHUNK_SIZE - 1) / VSC_HASHMAP_BUILD_CHUNK_SIZE;
+    if(proc == NULL || num_chunks <= 1)
+        return vsc_hashmap_build(hm, keys, values, n);
+
+    if(n > SIZE_MAX / sizeof(vsc_hash_t))
+        return VSC_ERROR(ERANGE);
+
+    bp = (BuildParallel){
+        .hm     = hm,
+        .keys   = keys,
+        .hashes = vsc_xalloc(hm->allocator, n * sizeof(vsc_hash_t)),
+        .n      = n,
+    };
+    if(bp.hashes == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    proc(build_parallel_task, &bp, num_chunks, user);
+
+    r = vsc_hashmap_build_with_hash(hm, keys, bp.hashes, values, n);
+    vsc_xfree(hm->allocator, bp.hashes);
+    return r;
+}
+
+int vsc_hashmap_build_with_hash(VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes,
+                                void *const *values, size_t n)
+{
+    int r;
+
+    validate(hm);
+
+    if(n > SIZE_MAX - hm->size)
+        return VSC_ERROR(ERANGE);
+
+    if((r = reserve(hm, hm->size + n)) < 0)
+        return r;
+
+    return build_hashed(hm, keys, hashes, values, n);
+}
+
+void *vsc_hashmap_find_by_hash(const VscHashMap *hm, vsc_hash_t hash)
+{
+    if(hash == VSC_INVALID_HASH)
+        return NULL;
+
+    validate(hm);
+
+    if(hm->num_buckets == 0 || filter_rejects(hm, hash))
+        return NULL;
+
+    hash = probe_hash(hm, hash);
+
+    LOOP_BUCKETS(hm, index, hash % hm->num_buckets)
+    {
+        if(slot_empty(hm, index))
+            break;
+
+        if(slot_hash(hm, index) == hash)
+            return slot_value(hm, index);
+    }
+
+    return NULL;
+}
+
+static int probe_slot(const VscHashMap *hm, const void *key, vsc_hash_t hash, size_t *outindex)
+{
+    if(hm->num_buckets == 0)
+        return 0;
+
+    hash = probe_hash(hm, hash);
+
+    /*
+     * Search for the key starting at index until we:
+     * 1. find it,
+     * 2. hit an empty bucket (not found),
+     * 3. do a complete loop  (not found)
+     *    - This is O(n), but should almost never happen if your
+     *      hash function is good enough and there's enough buckets.
+     */
+    LOOP_BUCKETS(hm, index, hash % hm->num_buckets)
+    {
+        /* Stop at first empty bucket, item isn't here. */
+        if(slot_empty(hm, index))
+            break;
+
+        if(slot_hash(hm, index) != hash)
+            continue;
+
+        /* In case of hash collision. */
+        if(!vsc_hashmap_compare(hm, key, slot_key(hm, index)))
+            continue;
+
+        *outindex = index;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int find_slot_hashed(const VscHashMap *hm, const void *key, vsc_hash_t hash, size_t *outindex)
+{
+    if(filter_rejects(hm, hash))
+        return 0;
+
+    return probe_slot(hm, key, hash, outindex);
+}
+
+static int find_slot(const VscHashMap *hm, const void *key, size_t *outindex)
+{
+    validate(hm);
+
+    return find_slot_hashed(hm, key, vsc_hashmap_hash(hm, key), outindex);
+}
+
+/*
+ * Look up a batch of at most VSC_HASHMAP_BATCH_SIZE keys.
+ *
+ * The home bucket of every key is prefetched before any of them are
+ * resolved, so the cache misses overlap instead of being taken one at a time.
+ */
+static size_t find_batch_hashed(const VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes, size_t n,
+                                void **values)
+{
+    size_t   found = 0;
+    uint32_t live  = 0;
+
+    vsc_assert(n <= VSC_HASHMAP_BATCH_SIZE);
+
+    for(size_t i = 0; i < n; ++i) {
+        size_t index;
+
+        if(hashes[i] == VSC_INVALID_HASH || filter_rejects(hm, hashes[i]))
+            continue;
+
+        live |= UINT32_C(1) << i;
+
+        index = probe_hash(hm, hashes[i]) % hm->num_buckets;
+
+        if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+            prefetch(hm->tags + index);
+        else if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS)
+            prefetch(hm->key_buckets + index);
+        else
+            prefetch(hm->buckets + index);
+    }
+
+    for(size_t i = 0; i < n; ++i) {
+        size_t index;
+
+        if(!(live & (UINT32_C(1) << i)) || !probe_slot(hm, keys[i], hashes[i], &index)) {
+            values[i] = NULL;
+            continue;
+        }
+
+        values[i] = slot_value(hm, index);
+        ++found;
+    }
+
+    return found;
+}
+
+size_t vsc_hashmap_find_batch(const VscHashMap *hm, const void *const *keys, size_t n, void **values)
+{
+    vsc_hash_t hashes[VSC_HASHMAP_BATCH_SIZE];
+    size_t     found = 0;
+
+    validate(hm);
+
+    if(hm->num_buckets == 0) {
+        for(size_t i = 0; i < n; ++i)
+            values[i] = NULL;
+        return 0;
+    }
+
+    for(size_t i = 0; i < n; i += VSC_HASHMAP_BATCH_SIZE) {
+        size_t count = VSC_MIN(n - i, VSC_HASHMAP_BATCH_SIZE);
+
+        for(size_t j = 0; j < count; ++j)
+            hashes[j] = vsc_hashmap_hash(hm, keys[i + j]);
+
+        found += find_batch_hashed(hm, keys + i, hashes, count, values + i);
+    }
+
+    return found;
+}
+
+size_t vsc_hashmap_find_batch_with_hash(const VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes,
+                                        size_t n, void **values)
+{
+    size_t found = 0;
+
+    validate(hm);
+
+    if(hm->num_buckets == 0) {
+        for(size_t i = 0; i < n; ++i)
+            values[i] = NULL;
+        return 0;
+    }
+
+    for(size_t i = 0; i < n; i += VSC_HASHMAP_BATCH_SIZE) {
+        size_t count = VSC_MIN(n - i, VSC_HASHMAP_BATCH_SIZE);
+        found += find_batch_hashed(hm, keys + i, hashes + i, count, values + i);
+    }
+
+    return found;
+}
+
+int vsci_hashmap_contains_with_hash(const VscHashMap *hm, const void *key, vsc_hash_t hash)
+{
+    size_t index;
+
+    validate(hm);
+
+    if(hash == VSC_INVALID_HASH)
+        return 0;
+
+    return find_slot_hashed(hm, key, hash, &index);
+}
+
+void *vsc_hashmap_find(const VscHashMap *hm, const void *key)
+{
+    size_t index;
+
+    if(!find_slot(hm, key, &index))
+        return NULL;
+
+    return slot_value(hm, index);
+}
+
+void *vsc_hashmap_find_with_hash(const VscHashMap *hm, const void *key, vsc_hash_t hash)
+{
+    size_t index;
+
+    validate(hm);
+
+    if(hash == VSC_INVALID_HASH)
+        return NULL;
+
+    if(!find_slot_hashed(hm, key, hash, &index))
+        return NULL;
 
-    // fprintf(stderr, "Resizing to %zu\n", hm->num_buckets);
-    return 0;
+    return slot_value(hm, index);
 }
 
-static inline int intceil(size_t *result, size_t num, size_t den)
+int vsc_hashmap_update(VscHashMap *hm, const void *key, void *value)
 {
-#if 1
-    *result = (num / den) + (size_t)((num % den) != 0);
-    return 0;
-#else
-    if(num >= SIZE_MAX - (den - 1))
-        return VSC_ERROR(ERANGE);
+    validate(hm);
 
-    *result = (num + den - 1) / den;
-    return 0;
-#endif
+    return vsc_hashmap_update_with_hash(hm, key, vsc_hashmap_hash(hm, key), value);
 }
 
-static int maybe_resize(VscHashMap *hm)
+int vsc_hashmap_update_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash, void *value)
 {
-    size_t thresh, minreq, tmp;
+    size_t index;
     int    r;
 
-    /*
-     * Make sure the threshold calculation doesn't overflow.
-     *
-     * If this is actively limiting your required size then either:
-     * - resize it manually using vsc_hashmap_resize(), or
-     * - use a load factor where the numerator is 1.
-     */
-    if((r = intceil(&tmp, SIZE_MAX, hm->load_max.num)) < 0)
-        return r;
+    validate(hm);
 
-    if(hm->num_buckets >= tmp)
-        return VSC_ERROR(ERANGE); /* or EOVERFLOW? */
+    if(hash == VSC_INVALID_HASH)
+        return 1;
 
-    /* Same as "n * load_factor" */
-    if((r = intceil(&thresh, hm->num_buckets * hm->load_max.num, hm->load_max.den)) < 0)
+    if(!find_slot_hashed(hm, key, hash, &index))
+        return 1;
+
+    /* The copy keeps every slot where it is, so `index` stays valid. */
+    if((r = unshare(hm)) < 0)
         return r;
 
-    /* Nothing to do */
-    if(hm->size < thresh)
-        return 0;
+    slot_set_value(hm, index, value);
+    return 0;
+}
 
-    /* Don't allow resize if explicitly disabled. */
-    if(hm->resize_policy == VSC_HASHMAP_RESIZE_NONE)
-        return VSC_ERROR(EPERM);
+void *vsc_hashmap_remove(VscHashMap *hm, const void *key)
+{
+    validate(hm);
 
-    if((r = intceil(&tmp, SIZE_MAX, hm->load_max.den)) < 0)
-        return r;
+    return vsc_hashmap_remove_with_hash(hm, key, vsc_hashmap_hash(hm, key));
+}
 
-    if(hm->size + 1 >= tmp)
-        return VSC_ERROR(ERANGE); /* or EOVERFLOW? */
+void *vsc_hashmap_remove_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash)
+{
+    void *val = NULL;
 
-    /*
-     * Determine the minimum number of buckets required to match
-     * the target load factor, then double it.
-     */
-    if((r = intceil(&minreq, (hm->size + 1) * hm->load_min.den, hm->load_min.num)) < 0)
-        return r;
+    validate(hm);
 
-    return vsc_hashmap_resize(hm, VSC_MAX(minreq, VSC_HASHMAP_MIN_BUCKET_AUTO_ALLOCATION));
+    if(vsc_hashmap_remove_ex(hm, key, hash, &val) != 0)
+        return NULL;
+
+    return val;
 }
 
-int vsc_hashmap_insert(VscHashMap *hm, const void *key, void *value)
+int vsc_hashmap_remove_ex(VscHashMap *hm, const void *key, vsc_hash_t hash, void **value)
 {
-    VscHashMapBucket tmpbkt;
-    int              r;
-    int              added;
+    size_t index;
+    void  *val;
+    int    r;
 
     validate(hm);
 
-    tmpbkt.hash  = vsc_hashmap_hash(hm, key);
-    tmpbkt.key   = key;
-    tmpbkt.value = value;
+    if(hash == VSC_INVALID_HASH)
+        return 1;
 
-    if(tmpbkt.hash == VSC_INVALID_HASH)
-        return VSC_ERROR(ERANGE);
+    if(!find_slot_hashed(hm, key, hash, &index))
+        return 1;
+
+    /* The copy keeps every slot where it is, so `index` stays valid. */
+    if((r = unshare(hm)) < 0)
+        return r;
+
+    val = slot_value(hm, index);
+    slot_reset(hm, index);
+
+    /* Search through the remaining buckets, to see if we can fill the gap. */
+    LOOP_BUCKETS(hm, cidx, index + 1)
+    {
+        size_t nidx;
+
+        /* Have an empty bucket, we're done here! */
+        if(slot_empty(hm, cidx))
+            break;
 
-    /* See if we need to resize. */
-    if((r = maybe_resize(hm)) < 0) {
         /*
-         * Resize required, but not allowed.
-         * Not an error, assume the user knows what they're doing.
+         * If our hash can be moved back, do it.
+         * It can't if its home bucket lies (circularly) within (index, cidx].
          */
-        if(r != VSC_ERROR(EPERM))
-            return r;
+        nidx = slot_hash(hm, cidx) % hm->num_buckets;
+        if(index <= cidx ? (index < nidx && nidx <= cidx) : (index < nidx || nidx <= cidx))
+            continue;
+
+        slot_move(hm, index, cidx);
+        index = cidx;
     }
 
-    added = 0;
-    if(add_or_replace_bucket(hm, hm->buckets, hm->num_buckets, &tmpbkt, &added) == NULL)
-        return VSC_ERROR(ENOSPC);
+    --hm->size;
+    filter_remove(hm, hash);
 
-    if(added) {
-        ++hm->size;
-    }
+    /* Not fatal, the map is still perfectly usable. */
+    (void)maybe_shrink(hm);
+
+    if(value != NULL)
+        *value = val;
 
     return 0;
 }
 
-void *vsc_hashmap_find_by_hash(const VscHashMap *hm, vsc_hash_t hash)
+/*
+ * The full hash of a slot. The compact layout only has the tag, so it has to be recalculated.
+ */
+static inline vsc_hash_t slot_full_hash(const VscHashMap *hm, size_t i)
 {
-    if(hash == VSC_INVALID_HASH)
-        return NULL;
-
-    validate(hm);
-
-    if(hm->num_buckets == 0)
-        return NULL;
-
-    LOOP_BUCKETS(hm, index, hash % hm->num_buckets)
-    {
-        const VscHashMapBucket *bkt = hm->buckets + index;
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        return vsc_hashmap_hash(hm, hm->keys[i]);
 
-        if(bkt->hash == VSC_INVALID_HASH)
-            break;
+    return slot_hash(hm, i);
+}
 
-        if(bkt->hash == hash)
-            return bkt->value;
-    }
+/*
+ * Do two maps produce the same hash for the same key?
+ */
+static inline int same_hash(const VscHashMap *a, const VscHashMap *b)
+{
+    if(a->seeded_hash_proc != NULL)
+        return a->seeded_hash_proc == b->seeded_hash_proc && a->seed == b->seed;
 
-    return NULL;
+    return b->seeded_hash_proc == NULL && a->hash_proc == b->hash_proc;
 }
 
-static const VscHashMapBucket *find_bucket(const VscHashMap *hm, const void *key, size_t *outindex)
+int vsci_hashmap_merge(VscHashMap *hm, const VscHashMap *other)
 {
-    vsc_hash_t hash;
+    int r;
 
     validate(hm);
+    validate(other);
 
-    hash = vsc_hashmap_hash(hm, key);
+    if(!same_hash(hm, other))
+        return VSC_ERROR(EINVAL);
 
-    if(hm->num_buckets == 0)
-        return NULL;
+    if(hm == other || other->size == 0)
+        return 0;
 
-    /*
-     * Search for the key starting at index until we:
-     * 1. find it,
-     * 2. hit an empty bucket (not found),
-     * 3. do a complete loop  (not found)
-     *    - This is O(n), but should almost never happen if your
-     *      hash function is good enough and there's enough buckets.
-     */
-    LOOP_BUCKETS(hm, index, hash % hm->num_buckets)
-    {
-        const VscHashMapBucket *bkt = hm->buckets + index;
+    if(other->size > SIZE_MAX - hm->size)
+        return VSC_ERROR(ERANGE);
 
-        /* Stop at first empty bucket, item isn't here. */
-        if(bkt->hash == VSC_INVALID_HASH)
-            break;
+    /* Assume no overlap, so the worst case is only one resize. */
+    if((r = reserve(hm, hm->size + other->size)) < 0)
+        return r;
 
-        if(bkt->hash != hash)
-            continue;
+    if((r = unshare(hm)) < 0)
+        return r;
 
-        /* In case of hash collision. */
-        if(!vsc_hashmap_compare(hm, key, bkt->key))
+    for(size_t i = 0; i < other->num_buckets; ++i) {
+        vsc_hash_t hash;
+        int        added = 0;
+
+        if(slot_empty(other, i))
             continue;
 
-        if(outindex != NULL)
-            *outindex = index;
-        return bkt;
+        hash = slot_full_hash(other, i);
+        if((r = filter_check(hm, slot_key(other, i), hash)) < 0)
+            return r;
+
+        if((r = add_or_replace(hm, probe_hash(hm, hash), slot_key(other, i), slot_value(other, i), &added)) < 0)
+            return r;
+
+        if(added) {
+            ++hm->size;
+            filter_add(hm, hash);
+        }
     }
 
-    return NULL;
+    return 0;
 }
 
-void *vsc_hashmap_find(const VscHashMap *hm, const void *key)
+typedef struct RetainState {
+    const VscHashMap *other;
+    int               present;
+} RetainState;
+
+static int retain_proc(const VscHashMap *hm, size_t i, void *user)
 {
-    const VscHashMapBucket *bkt;
+    const RetainState *state = user;
+    size_t             index;
 
-    if((bkt = find_bucket(hm, key, NULL)) == NULL)
-        return NULL;
+    return find_slot_hashed(state->other, slot_key(hm, i), slot_hash(hm, i), &index) == state->present;
+}
+
+int vsci_hashmap_retain(VscHashMap *hm, const VscHashMap *other, int present)
+{
+    RetainState state = {.other = other, .present = present != 0};
+    int         r;
+
+    validate(hm);
+    validate(other);
+    vsc_assert(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS);
+    vsc_assert(hm->bloom == NULL && hm->cuckoo == NULL);
+
+    if(!same_hash(hm, other))
+        return VSC_ERROR(EINVAL);
+
+    if(hm->size == 0)
+        return 0;
+
+    /*
+     * Removing in place would need a backward shift for every element dropped,
+     * so filter everything into a new block in a single pass instead.
+     */
+    if((r = rehash_keys(hm, hm->num_buckets, retain_proc, &state)) < 0)
+        return r;
 
-    return bkt->value;
+    /* Not fatal, the map is still perfectly usable. */
+    (void)maybe_shrink(hm);
+    return 0;
 }
 
-int vsc_hashmap_update(const VscHashMap *hm, const void *key, void *value)
+int vsc_hashmap_attach_bloom_filter(VscHashMap *hm, VscBloomFilter *bf)
 {
-    VscHashMapBucket *bkt;
+    validate(hm);
+    vsc_assert(bf != NULL);
 
-    /* NB: Safe const-away cast. We're not changing the map, we're changing the bucket. */
-    if((bkt = (VscHashMapBucket *)find_bucket(hm, key, NULL)) == NULL)
-        return 1;
+    if(hm->bloom != NULL || hm->cuckoo != NULL)
+        return VSC_ERROR(EBUSY);
+
+    for(size_t i = 0; i < hm->num_buckets; ++i) {
+        if(!slot_empty(hm, i))
+            vsc_bloom_filter_insert_hash(bf, slot_full_hash(hm, i));
+    }
 
-    bkt->value = value;
+    hm->bloom = bf;
     return 0;
 }
 
-void *vsc_hashmap_remove(VscHashMap *hm, const void *key)
+int vsc_hashmap_attach_cuckoo_filter(VscHashMap *hm, VscCuckooFilter *cf)
 {
-    VscHashMapBucket *bkt;
-    size_t            index;
-    void             *val;
+    size_t i;
+    int    r = 0;
 
-    bkt = (VscHashMapBucket *)find_bucket(hm, key, &index);
-    if(bkt == NULL)
-        return NULL;
+    validate(hm);
+    vsc_assert(cf != NULL);
 
-    val = bkt->value;
-    reset_bucket(bkt);
+    if(hm->bloom != NULL || hm->cuckoo != NULL)
+        return VSC_ERROR(EBUSY);
 
-    /* Search through the remaining buckets, to see if we can fill the gap. */
-    LOOP_BUCKETS(hm, cidx, index + 1)
-    {
-        size_t            nidx;
-        VscHashMapBucket *bkt2 = hm->buckets + cidx;
+    for(i = 0; i < hm->num_buckets; ++i) {
+        if(slot_empty(hm, i))
+            continue;
 
-        /* Have an empty bucket, we're done here! */
-        if(bkt2->hash == VSC_INVALID_HASH)
+        /* The last insertion may leave it full, that's fine. */
+        if((r = vsc_cuckoo_filter_insert_hash(cf, slot_full_hash(hm, i))) < 0)
             break;
+    }
 
-        /* If our hash can be moved back, do it. */
-        nidx = bkt2->hash % hm->num_buckets;
-        if(nidx <= index) {
-            *bkt = *bkt2;
-            reset_bucket(bkt2);
-            index = cidx;
-            bkt   = bkt2;
+    if(r < 0) {
+        /* Take back everything that was added. */
+        while(i-- > 0) {
+            if(!slot_empty(hm, i))
+                (void)vsc_cuckoo_filter_remove_hash(cf, slot_full_hash(hm, i));
         }
+
+        return r;
     }
 
-    --hm->size;
-    return val;
+    hm->cuckoo = cf;
+    return 0;
+}
+
+void vsc_hashmap_detach_filter(VscHashMap *hm)
+{
+    validate(hm);
+
+    hm->bloom  = NULL;
+    hm->cuckoo = NULL;
 }
 
 size_t vsc_hashmap_size(const VscHashMap *hm)
@@ -533,6 +1855,86 @@ VscHashMapResizePolicy vsc_hashmap_set_resize_policy(VscHashMap *hm, VscHashMapR
     return old;
 }
 
+int vsc_hashmap_stats(const VscHashMap *hm, VscHashMapStats *stats)
+{
+    size_t n, start, run, total_probe;
+
+    validate(hm);
+
+    if(stats == NULL)
+        return VSC_ERROR(EINVAL);
+
+    n      = hm->num_buckets;
+    *stats = (VscHashMapStats){
+        .size         = hm->size,
+        .num_buckets  = n,
+        .load_factor  = n > 0 ? (double)hm->size / (double)n : 0.0,
+        .num_resizes  = hm->num_resizes,
+        .num_rehashed = hm->num_rehashed,
+    };
+
+    if(hm->size == 0)
+        return 0;
+
+    total_probe = 0;
+    for(size_t i = 0; i < n; ++i) {
+        vsc_hash_t phash;
+        size_t     home, dist;
+
+        if(slot_empty(hm, i))
+            continue;
+
+        phash = slot_hash(hm, i);
+        home  = phash % n;
+        dist  = (i + n - home) % n;
+
+        total_probe += dist;
+        stats->max_probe_length = VSC_MAX(stats->max_probe_length, dist);
+        ++stats->probe_histogram[VSC_MIN(dist, VSC_HASHMAP_STATS_HISTOGRAM_SIZE - 1)];
+
+        /*
+         * If anything between our home and us has the same hash,
+         * looking us up has to go through compare_proc.
+         */
+        for(size_t j = home; j != i; j = (j + 1) % n) {
+            if(slot_hash(hm, j) == phash) {
+                ++stats->hash_collisions;
+                break;
+            }
+        }
+    }
+
+    stats->mean_probe_length = (double)total_probe / (double)hm->size;
+
+    /* Clusters are runs of occupied slots. Start counting just after an empty one. */
+    if(hm->size == n) {
+        stats->num_clusters    = 1;
+        stats->longest_cluster = n;
+        return 0;
+    }
+
+    for(start = 0; !slot_empty(hm, start); ++start)
+        ;
+
+    run = 0;
+    for(size_t k = 1; k <= n; ++k) {
+        size_t i = (start + k) % n;
+
+        if(!slot_empty(hm, i)) {
+            ++run;
+            continue;
+        }
+
+        if(run > 0) {
+            ++stats->num_clusters;
+            stats->longest_cluster = VSC_MAX(stats->longest_cluster, run);
+        }
+        run = 0;
+    }
+
+    return 0;
+}
+
 const VscHashMapBucket *vsc_hashmap_first(const VscHashMap *hm)
 {
     validate(hm);
@@ -544,12 +1946,63 @@ const VscHashMapBucket *vsc_hashmap_first(const VscHashMap *hm)
     return hm->buckets;
 }
 
+int vsc_hashmap_get_bucket(const VscHashMap *hm, size_t index, VscHashMapBucket *bucket)
+{
+    validate(hm);
+
+    if(bucket == NULL || index >= hm->num_buckets)
+        return VSC_ERROR(EINVAL);
+
+    if(slot_empty(hm, index)) {
+        reset_bucket(bucket);
+        return 0;
+    }
+
+    bucket->key   = slot_key(hm, index);
+    bucket->value = slot_value(hm, index);
+
+    /* Only the tag is stored, the full hash needs to be recalculated. */
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT)
+        bucket->hash = vsc_hashmap_hash(hm, bucket->key);
+    else
+        bucket->hash = slot_hash(hm, index);
+
+    return 0;
+}
+
 int vsc_hashmap_enumerate(const VscHashMap *hm, VscHashMapEnumProc proc, void *user)
 {
     int r;
 
     validate(hm);
 
+    if(hm->layout == VSC_HASHMAP_LAYOUT_COMPACT) {
+        for(size_t i = 0; i < hm->num_buckets; ++i) {
+            if(hm->tags[i] == 0)
+                continue;
+
+            /* Only the tag is stored, the full hash needs to be recalculated. */
+            if((r = proc(hm->keys[i], hm->values[i], vsc_hashmap_hash(hm, hm->keys[i]), user)) != 0)
+                return r;
+        }
+
+        return 0;
+    }
+
+    if(hm->layout == VSCI_HASHMAP_LAYOUT_KEYS) {
+        for(size_t i = 0; i < hm->num_buckets; ++i) {
+            const VscHashMapKeyBucket *bkt = hm->key_buckets + i;
+
+            if(bkt->hash == VSC_INVALID_HASH)
+                continue;
+
+            if((r = proc(bkt->key, NULL, bkt->hash, user)) != 0)
+                return r;
+        }
+
+        return 0;
+    }
+
     for(size_t i = 0; i < hm->num_buckets; ++i) {
         const VscHashMapBucket *bkt = hm->buckets + i;
 
@@ -578,6 +2031,17 @@ vsc_hash_t vsc_hashmap_string_hash(const void *s)
     return vsc_hash_string(s);
 }
 
+vsc_hash_t vsc_hashmap_string_hash_random(const void *s)
+{
+    /* There's no map to get a seed from, so at least vary it per process. */
+    return vsc_hash_string_seeded(s, vsci_random_process_key());
+}
+
+vsc_hash_t vsc_hashmap_string_hash_seeded(const void *s, uint64_t seed)
+{
+    return vsc_hash_string_seeded(s, seed);
+}
+
 int vsc_hashmap_string_compare(const void *a, const void *b)
 {
     if(a == b)
@@ -0,0 +1,122 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_HASHMAP_INTERNAL_H
+#define _VSCLIB_HASHMAP_INTERNAL_H
+
+#include <vsclib/hashmap.h>
+
+/*
+ * Keys-only layout, used by VscHashSet. Each bucket is a VscHashMapKeyBucket.
+ * Values are never stored, and always read as NULL.
+ *
+ * This can't be selected with vsc_hashmap_set_layout().
+ */
+#define VSCI_HASHMAP_LAYOUT_KEYS ((VscHashMapLayout)2)
+
+typedef struct VscHashMapKeyBucket {
+    vsc_hash_t  hash;
+    const void *key;
+} VscHashMapKeyBucket;
+
+struct VscHashMap {
+    size_t           size;
+    size_t           num_buckets;
+    VscHashMapLayout layout;
+
+    /* Lifetime statistics, see vsc_hashmap_stats(). */
+    size_t num_resizes;
+    size_t num_rehashed;
+
+    /* VSC_HASHMAP_LAYOUT_BUCKETS */
+    VscHashMapBucket *buckets;
+
+    /* VSCI_HASHMAP_LAYOUT_KEYS */
+    VscHashMapKeyBucket *key_buckets;
+
+    /*
+     * VSC_HASHMAP_LAYOUT_COMPACT
+     * These are all a single allocation, owned by tags.
+     */
+    uint32_t    *tags;
+    const void **keys;
+    void       **values;
+
+    VscHashMapResizePolicy resize_policy;
+    struct {
+        uint16_t num, den;
+    } load_min;
+    struct {
+        uint16_t num, den;
+    } load_max;
+    VscHashMapHashProc    hash_proc;
+    /* If set, used instead of hash_proc. */
+    VscHashMapSeededHashProc seeded_hash_proc;
+    uint64_t                 seed;
+    VscHashMapCompareProc compare_proc;
+    const VscAllocator   *allocator;
+
+    /*
+     * If set, the storage above is shared with maps created by
+     * vsc_hashmap_clone_shared(), and this is its reference count.
+     * It's copied before any write.
+     */
+    size_t *refs;
+
+    /*
+     * Optional membership filters, see vsc_hashmap_attach_bloom_filter().
+     * At most one is set. These aren't owned by the map.
+     */
+    VscBloomFilter  *bloom;
+    VscCuckooFilter *cuckoo;
+};
+
+/*
+ * Initialise a map in place.
+ */
+void vsci_hashmap_init(VscHashMap *hm, VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                       VscHashMapLayout layout, const VscAllocator *a);
+
+/*
+ * Switch a freshly-initialised map to a seeded hash procedure, giving it its own
+ * random seed. Maps without one never need a seed, so they don't get one.
+ */
+void vsci_hashmap_init_seeded(VscHashMap *hm, VscHashMapSeededHashProc hash);
+
+/*
+ * Make sure there's enough room for `nelem` elements without triggering an
+ * automatic resize. Does nothing if resizing is disabled.
+ */
+int vsci_hashmap_reserve(VscHashMap *hm, size_t nelem);
+
+int vsci_hashmap_contains_with_hash(const VscHashMap *hm, const void *key, vsc_hash_t hash);
+
+/*
+ * Add everything in `other` to `hm`, replacing duplicates.
+ * Stored hashes are reused, so both maps must use the same hash procedure and seed.
+ */
+int vsci_hashmap_merge(VscHashMap *hm, const VscHashMap *other);
+
+/*
+ * Keep only the elements of `hm` whose presence in `other` matches `present`.
+ * `hm` must be VSCI_HASHMAP_LAYOUT_KEYS.
+ */
+int vsci_hashmap_retain(VscHashMap *hm, const VscHashMap *other, int present);
+
+#endif /* _VSCLIB_HASHMAP_INTERNAL_H */
@@ -0,0 +1,497 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Read-only hash map snapshots.
+ *
+ * Everything is little-endian, and all offsets are relative to the start of the snapshot.
+ *
+ * Header (64 bytes):
+ *   [ 0] char[8]  magic, "VSCHMSNP"
+ *   [ 8] uint32_t version, 1
+ *   [12] uint32_t reserved, 0
+ *   [16] uint64_t number of buckets, a power-of-two
+ *   [24] uint64_t number of entries
+ *   [32] uint64_t offset of the bucket table
+ *   [40] uint64_t total size of the snapshot
+ *   [48] uint8_t[16] reserved, 0
+ *
+ * Entries (8-byte aligned), immediately following the header:
+ *   [0] uint32_t key size
+ *   [4] uint32_t value size
+ *   [8] key, padded to 8 bytes
+ *   [.] value, padded to 8 bytes
+ *
+ * Bucket table (8-byte aligned), 16 bytes per bucket:
+ *   [0] uint64_t vsc_hash64() of the key, seed 0
+ *   [8] uint64_t offset of the entry, or 0 if empty
+ *
+ * The buckets are linearly probed, starting at (hash % number of buckets).
+ */
+#if defined(_WIN32)
+#include "util_win32.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/hash.h>
+#include <vsclib/hashmap.h>
+#include <vsclib/hashmap_snapshot.h>
+#include <vsclib/io.h>
+#include <vsclib/mem.h>
+#include <vsclib/string.h>
+
+#define SNAPSHOT_MAGIC         "VSCHMSNP"
+#define SNAPSHOT_VERSION       1
+#define SNAPSHOT_HEADER_SIZE   64
+#define SNAPSHOT_BUCKET_SIZE   16
+#define SNAPSHOT_ENTRY_SIZE    8
+#define SNAPSHOT_MIN_BUCKETS   16
+#define SNAPSHOT_PAD8(x)       (((x) + 7) & ~(uint64_t)7)
+
+struct VscHashMapSnapshot {
+    const uint8_t      *data;
+    uint64_t            size;
+    uint64_t            num_buckets;
+    uint64_t            count;
+    const uint8_t      *buckets;
+    void               *mapping;
+    size_t              mapping_size;
+    const VscAllocator *allocator;
+};
+
+typedef struct WriteState {
+    FILE                        *f;
+    VscHashMapSnapshotEncodeProc proc;
+    void                        *user;
+    uint8_t                     *buckets;
+    uint64_t                     num_buckets;
+    uint64_t                     offset;
+    int                          err;
+} WriteState;
+
+static int write_padded(FILE *f, const void *data, size_t size)
+{
+    static const uint8_t zero[8] = {0};
+    size_t               pad     = (size_t)(SNAPSHOT_PAD8(size) - size);
+
+    if(size > 0 && fwrite(data, size, 1, f) != 1)
+        return VSC_ERROR(EIO);
+
+    if(pad > 0 && fwrite(zero, pad, 1, f) != 1)
+        return VSC_ERROR(EIO);
+
+    return 0;
+}
+
+static int write_entry(const void *key, void *value, vsc_hash_t hash, void *user)
+{
+    WriteState            *ws = user;
+    VscHashMapSnapshotItem item;
+    uint8_t                hdr[SNAPSHOT_ENTRY_SIZE];
+    uint64_t               h, mask, i;
+    int                    r;
+
+    (void)hash;
+
+    item = (VscHashMapSnapshotItem){.key = NULL, .key_size = 0, .value = NULL, .value_size = 0};
+    if(ws->proc(key, value, &item, ws->user) != 0) {
+        ws->err = VSC_ERROR(ECANCELED);
+        return 1;
+    }
+
+    if(item.key_size > UINT32_MAX || item.value_size > UINT32_MAX) {
+        ws->err = VSC_ERROR(ERANGE);
+        return 1;
+    }
+
+    vsc_write_leu32(hdr + 0, (uint32_t)item.key_size);
+    vsc_write_leu32(hdr + 4, (uint32_t)item.value_size);
+
+    if(fwrite(hdr, sizeof(hdr), 1, ws->f) != 1) {
+        ws->err = VSC_ERROR(EIO);
+        return 1;
+    }
+
+    if((r = write_padded(ws->f, item.key, item.key_size)) < 0 ||
+       (r = write_padded(ws->f, item.value, item.value_size)) < 0) {
+        ws->err = r;
+        return 1;
+    }
+
+    h    = vsc_hash64(item.key, item.key_size, 0);
+    mask = ws->num_buckets - 1;
+    for(i = h & mask; vsc_read_leu64(ws->buckets + i * SNAPSHOT_BUCKET_SIZE + 8) != 0; i = (i + 1) & mask)
+        ;
+
+    vsc_write_leu64(ws->buckets + i * SNAPSHOT_BUCKET_SIZE + 0, h);
+    vsc_write_leu64(ws->buckets + i * SNAPSHOT_BUCKET_SIZE + 8, ws->offset);
+
+    ws->offset += SNAPSHOT_ENTRY_SIZE + SNAPSHOT_PAD8(item.key_size) + SNAPSHOT_PAD8(item.value_size);
+    return 0;
+}
+
+int vsc_hashmap_snapshot_writea(const VscHashMap *hm, FILE *f, VscHashMapSnapshotEncodeProc proc, void *user,
+                                const VscAllocator *a)
+{
+    WriteState ws;
+    uint8_t    hdr[SNAPSHOT_HEADER_SIZE];
+    vsc_off_t  start;
+    uint64_t   num_buckets, buckets_offset, total_size;
+    size_t     count;
+    int        r;
+
+    if(hm == NULL || f == NULL || proc == NULL || a == NULL)
+        return VSC_ERROR(EINVAL);
+
+    if((start = vsc_ftello(f)) < 0)
+        return (int)start;
+
+    /* Keep the load factor at or below 1/2. */
+    count       = vsc_hashmap_size(hm);
+    num_buckets = SNAPSHOT_MIN_BUCKETS;
+    while(num_buckets / 2 < count)
+        num_buckets *= 2;
+
+    if(num_buckets > SIZE_MAX / SNAPSHOT_BUCKET_SIZE)
+        return VSC_ERROR(ERANGE);
+
+    ws = (WriteState){
+        .f           = f,
+        .proc        = proc,
+        .user        = user,
+        .buckets     = NULL,
+        .num_buckets = num_buckets,
+        .offset      = SNAPSHOT_HEADER_SIZE,
+        .err         = 0,
+    };
+
+    if((ws.buckets = vsc_xcalloc(a, (size_t)num_buckets, SNAPSHOT_BUCKET_SIZE)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    /* Leave room for the header, it's filled in at the end. */
+    memset(hdr, 0, sizeof(hdr));
+    if(fwrite(hdr, sizeof(hdr), 1, f) != 1) {
+        r = VSC_ERROR(EIO);
+        goto done;
+    }
+
+    if(vsc_hashmap_enumerate(hm, write_entry, &ws) != 0) {
+        r = ws.err;
+        goto done;
+    }
+
+    buckets_offset = ws.offset;
+    total_size     = buckets_offset + num_buckets * SNAPSHOT_BUCKET_SIZE;
+
+    if(fwrite(ws.buckets, (size_t)(num_buckets * SNAPSHOT_BUCKET_SIZE), 1, f) != 1) {
+        r = VSC_ERROR(EIO);
+        goto done;
+    }
+
+    memcpy(hdr + 0, SNAPSHOT_MAGIC, 8);
+    vsc_write_leu32(hdr + 8, SNAPSHOT_VERSION);
+    vsc_write_leu32(hdr + 12, 0);
+    vsc_write_leu64(hdr + 16, num_buckets);
+    vsc_write_leu64(hdr + 24, count);
+    vsc_write_leu64(hdr + 32, buckets_offset);
+    vsc_write_leu64(hdr + 40, total_size);
+
+    if((r = vsc_fseeko(f, start, SEEK_SET)) < 0)
+        goto done;
+
+    if(fwrite(hdr, sizeof(hdr), 1, f) != 1) {
+        r = VSC_ERROR(EIO);
+        goto done;
+    }
+
+    r = vsc_fseeko(f, start + (vsc_off_t)total_size, SEEK_SET);
+
+done:
+    vsc_xfree(a, ws.buckets);
+    return r;
+}
+
+int vsc_hashmap_snapshot_write(const VscHashMap *hm, FILE *f, VscHashMapSnapshotEncodeProc proc, void *user)
+{
+    return vsc_hashmap_snapshot_writea(hm, f, proc, user, vsclib_system_allocator);
+}
+
+/* Validate the header. Entries are bounds-checked as they're used. */
+static int parse_header(VscHashMapSnapshot *snap, const uint8_t *data, size_t size)
+{
+    uint64_t num_buckets, count, buckets_offset, total_size;
+
+    if(data == NULL || size < SNAPSHOT_HEADER_SIZE || !VSC_IS_ALIGNED(data, 8))
+        return VSC_ERROR(EINVAL);
+
+    if(memcmp(data, SNAPSHOT_MAGIC, 8) != 0 || vsc_read_leu32(data + 8) != SNAPSHOT_VERSION)
+        return VSC_ERROR(EINVAL);
+
+    num_buckets    = vsc_read_leu64(data + 16);
+    count          = vsc_read_leu64(data + 24);
+    buckets_offset = vsc_read_leu64(data + 32);
+    total_size     = vsc_read_leu64(data + 40);
+
+    if(!VSC_IS_POT(num_buckets) || count >= num_buckets)
+        return VSC_ERROR(EINVAL);
+
+    if(total_size > size || buckets_offset < SNAPSHOT_HEADER_SIZE || buckets_offset % 8 != 0)
+        return VSC_ERROR(EINVAL);
+
+    if(num_buckets > (total_size - VSC_MIN(buckets_offset, total_size)) / SNAPSHOT_BUCKET_SIZE)
+        return VSC_ERROR(EINVAL);
+
+    snap->data        = data;
+    snap->size        = total_size;
+    snap->num_buckets = num_buckets;
+    snap->count       = count;
+    snap->buckets     = data + buckets_offset;
+    return 0;
+}
+
+int vsc_hashmap_snapshot_loada(VscHashMapSnapshot **snap, const void *data, size_t size, const VscAllocator *a)
+{
+    VscHashMapSnapshot *s;
+    int                 r;
+
+    if(snap == NULL || a == NULL)
+        return VSC_ERROR(EINVAL);
+
+    if((s = vsc_xalloc(a, sizeof(VscHashMapSnapshot))) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    *s = (VscHashMapSnapshot){
+        .mapping      = NULL,
+        .mapping_size = 0,
+        .allocator    = a,
+    };
+
+    if((r = parse_header(s, data, size)) < 0) {
+        vsc_xfree(a, s);
+        return r;
+    }
+
+    *snap = s;
+    return 0;
+}
+
+int vsc_hashmap_snapshot_load(VscHashMapSnapshot **snap, const void *data, size_t size)
+{
+    return vsc_hashmap_snapshot_loada(snap, data, size, vsclib_system_allocator);
+}
+
+static void unmap_file(void *p, size_t size)
+{
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(p);
+#else
+    munmap(p, size);
+#endif
+}
+
+static int map_file(const char *path, void **ptr, size_t *size, const VscAllocator *a)
+{
+#if defined(_WIN32)
+    wchar_t      *wpath = NULL;
+    HANDLE        hFile, hMapping;
+    LARGE_INTEGER fsize;
+    void         *p;
+    int           r;
+
+    if((r = vsc_cstrtowstra(path, CP_UTF8, &wpath, NULL, a)) < 0)
+        return r;
+
+    hFile = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    vsc_xfree(a, wpath);
+
+    if(hFile == INVALID_HANDLE_VALUE)
+        return vsci_map_win32err(GetLastError());
+
+    if(!GetFileSizeEx(hFile, &fsize)) {
+        r = vsci_map_win32err(GetLastError());
+        CloseHandle(hFile);
+        return r;
+    }
+
+    if(fsize.QuadPart == 0 || (uint64_t)fsize.QuadPart > SIZE_MAX) {
+        CloseHandle(hFile);
+        return VSC_ERROR(EINVAL);
+    }
+
+    if((hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL) {
+        r = vsci_map_win32err(GetLastError());
+        CloseHandle(hFile);
+        return r;
+    }
+
+    p = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    r = p == NULL ? vsci_map_win32err(GetLastError()) : 0;
+
+    /* The view keeps the mapping alive. */
+    CloseHandle(hMapping);
+    CloseHandle(hFile);
+
+    if(r < 0)
+        return r;
+
+    *ptr  = p;
+    *size = (size_t)fsize.QuadPart;
+    return 0;
+#else
+    struct stat st;
+    void       *p;
+    int         fd, r;
+
+    (void)a;
+
+    if((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+        return VSC_ERROR(errno);
+
+    if(fstat(fd, &st) < 0) {
+        r = VSC_ERROR(errno);
+        close(fd);
+        return r;
+    }
+
+    if(st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        return VSC_ERROR(EINVAL);
+    }
+
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    r = p == MAP_FAILED ? VSC_ERROR(errno) : 0;
+
+    /* The mapping keeps the file alive. */
+    close(fd);
+
+    if(r < 0)
+        return r;
+
+    *ptr  = p;
+    *size = (size_t)st.st_size;
+    return 0;
+#endif
+}
+
+int vsc_hashmap_snapshot_opena(VscHashMapSnapshot **snap, const char *path, const VscAllocator *a)
+{
+    VscHashMapSnapshot *s;
+    void               *p    = NULL;
+    size_t              size = 0;
+    int                 r;
+
+    if(snap == NULL || path == NULL || a == NULL)
+        return VSC_ERROR(EINVAL);
+
+    if((s = vsc_xalloc(a, sizeof(VscHashMapSnapshot))) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    if((r = map_file(path, &p, &size, a)) < 0) {
+        vsc_xfree(a, s);
+        return r;
+    }
+
+    *s = (VscHashMapSnapshot){
+        .mapping      = p,
+        .mapping_size = size,
+        .allocator    = a,
+    };
+
+    if((r = parse_header(s, p, size)) < 0) {
+        unmap_file(p, size);
+        vsc_xfree(a, s);
+        return r;
+    }
+
+    *snap = s;
+    return 0;
+}
+
+int vsc_hashmap_snapshot_open(VscHashMapSnapshot **snap, const char *path)
+{
+    return vsc_hashmap_snapshot_opena(snap, path, vsclib_system_allocator);
+}
+
+void vsc_hashmap_snapshot_close(VscHashMapSnapshot *snap)
+{
+    if(snap == NULL)
+        return;
+
+    if(snap->mapping != NULL)
+        unmap_file(snap->mapping, snap->mapping_size);
+
+    vsc_xfree(snap->allocator, snap);
+}
+
+size_t vsc_hashmap_snapshot_size(const VscHashMapSnapshot *snap)
+{
+    vsc_assert(snap != NULL);
+    return (size_t)snap->count;
+}
+
+const void *vsc_hashmap_snapshot_find(const VscHashMapSnapshot *snap, const void *key, size_t key_size,
+                                      size_t *value_size)
+{
+    uint64_t h, mask, i;
+
+    vsc_assert(snap != NULL);
+
+    h    = vsc_hash64(key, key_size, 0);
+    mask = snap->num_buckets - 1;
+    i    = h & mask;
+
+    for(uint64_t n = 0; n < snap->num_buckets; ++n, i = (i + 1) & mask) {
+        const uint8_t *bkt = snap->buckets + i * SNAPSHOT_BUCKET_SIZE;
+        uint64_t       off, ksize, vsize;
+
+        if((off = vsc_read_leu64(bkt + 8)) == 0)
+            return NULL;
+
+        if(vsc_read_leu64(bkt + 0) != h)
+            continue;
+
+        /* Don't trust the file. */
+        if(off > snap->size - SNAPSHOT_ENTRY_SIZE)
+            return NULL;
+
+        ksize = vsc_read_leu32(snap->data + off + 0);
+        vsize = vsc_read_leu32(snap->data + off + 4);
+
+        if(SNAPSHOT_PAD8(ksize) + SNAPSHOT_PAD8(vsize) > snap->size - off - SNAPSHOT_ENTRY_SIZE)
+            return NULL;
+
+        if(ksize != key_size || memcmp(snap->data + off + SNAPSHOT_ENTRY_SIZE, key, key_size) != 0)
+            continue;
+
+        if(value_size != NULL)
+            *value_size = (size_t)vsize;
+
+        return snap->data + off + SNAPSHOT_ENTRY_SIZE + SNAPSHOT_PAD8(ksize);
+    }
+
+    return NULL;
+}
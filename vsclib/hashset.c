@@ -0,0 +1,188 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/hashmap.h>
+#include <vsclib/hashset.h>
+#include "hashmap_internal.h"
+
+/*
+ * A set is a keys-only map. Embedding it saves an indirection on every lookup.
+ */
+struct VscHashSet {
+    VscHashMap map;
+};
+
+typedef struct EnumState {
+    VscHashSetEnumProc proc;
+    void              *user;
+} EnumState;
+
+VscHashSet *vsc_hashset_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a)
+{
+    VscHashSet *set;
+
+    vsc_assert(a != NULL);
+
+    if((set = vsc_xalloc(a, sizeof(VscHashSet))) == NULL)
+        return NULL;
+
+    vsci_hashmap_init(&set->map, hash, compare, VSCI_HASHMAP_LAYOUT_KEYS, a);
+    return set;
+}
+
+VscHashSet *vsc_hashset_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare)
+{
+    return vsc_hashset_alloca(hash, compare, vsclib_system_allocator);
+}
+
+void vsc_hashset_free(VscHashSet *set)
+{
+    const VscAllocator *a;
+
+    vsc_assert(set != NULL);
+
+    a = set->map.allocator;
+    vsc_hashmap_reset(&set->map);
+    vsc_xfree(a, set);
+}
+
+void vsc_hashset_clear(VscHashSet *set)
+{
+    vsc_assert(set != NULL);
+    (void)vsc_hashmap_clear(&set->map);
+}
+
+void vsc_hashset_reset(VscHashSet *set)
+{
+    vsc_assert(set != NULL);
+    vsc_hashmap_reset(&set->map);
+}
+
+int vsc_hashset_configure(VscHashSet *set, uint16_t min_num, uint16_t min_den, uint16_t max_num, uint16_t max_den)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_configure(&set->map, min_num, min_den, max_num, max_den);
+}
+
+int vsc_hashset_resize(VscHashSet *set, size_t nelem)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_resize(&set->map, nelem);
+}
+
+vsc_hash_t vsc_hashset_hash(const VscHashSet *set, const void *key)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_hash(&set->map, key);
+}
+
+int vsc_hashset_insert(VscHashSet *set, const void *key)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_insert_with_hash(&set->map, key, vsc_hashmap_hash(&set->map, key), NULL);
+}
+
+int vsc_hashset_insert_with_hash(VscHashSet *set, const void *key, vsc_hash_t hash)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_insert_with_hash(&set->map, key, hash, NULL);
+}
+
+int vsc_hashset_contains(const VscHashSet *set, const void *key)
+{
+    vsc_assert(set != NULL);
+    return vsci_hashmap_contains_with_hash(&set->map, key, vsc_hashmap_hash(&set->map, key));
+}
+
+int vsc_hashset_contains_with_hash(const VscHashSet *set, const void *key, vsc_hash_t hash)
+{
+    vsc_assert(set != NULL);
+    return vsci_hashmap_contains_with_hash(&set->map, key, hash);
+}
+
+int vsc_hashset_remove(VscHashSet *set, const void *key)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashset_remove_with_hash(set, key, vsc_hashmap_hash(&set->map, key));
+}
+
+int vsc_hashset_remove_with_hash(VscHashSet *set, const void *key, vsc_hash_t hash)
+{
+    size_t size;
+
+    vsc_assert(set != NULL);
+
+    /* There's no value to return, so go by the size. */
+    size = set->map.size;
+    (void)vsc_hashmap_remove_with_hash(&set->map, key, hash);
+    return set->map.size < size ? 0 : 1;
+}
+
+size_t vsc_hashset_size(const VscHashSet *set)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_size(&set->map);
+}
+
+size_t vsc_hashset_capacity(const VscHashSet *set)
+{
+    vsc_assert(set != NULL);
+    return vsc_hashmap_capacity(&set->map);
+}
+
+static int enum_proc(const void *key, void *value, vsc_hash_t hash, void *user)
+{
+    const EnumState *state = user;
+    (void)value;
+    return state->proc(key, hash, state->user);
+}
+
+int vsc_hashset_enumerate(const VscHashSet *set, VscHashSetEnumProc proc, void *user)
+{
+    EnumState state = {.proc = proc, .user = user};
+
+    vsc_assert(set != NULL);
+    vsc_assert(proc != NULL);
+
+    return vsc_hashmap_enumerate(&set->map, enum_proc, &state);
+}
+
+int vsc_hashset_union(VscHashSet *set, const VscHashSet *other)
+{
+    vsc_assert(set != NULL);
+    vsc_assert(other != NULL);
+    return vsci_hashmap_merge(&set->map, &other->map);
+}
+
+int vsc_hashset_intersect(VscHashSet *set, const VscHashSet *other)
+{
+    vsc_assert(set != NULL);
+    vsc_assert(other != NULL);
+    return vsci_hashmap_retain(&set->map, &other->map, 1);
+}
+
+int vsc_hashset_difference(VscHashSet *set, const VscHashSet *other)
+{
+    vsc_assert(set != NULL);
+    vsc_assert(other != NULL);
+    return vsci_hashmap_retain(&set->map, &other->map, 0);
+}
@@ -45,6 +45,18 @@
 #include "vsclib/hash.h"
 #include "vsclib/wav.h"
 #include "vsclib/hashmap.h"
+#include "vsclib/hashset.h"
+#include "vsclib/ordered_hashmap.h"
+#include "vsclib/bloom_filter.h"
+#include "vsclib/cuckoo_filter.h"
+#include "vsclib/lru_cache.h"
+#include "vsclib/clock_cache.h"
+#include "vsclib/string_table.h"
+#include "vsclib/concurrent_hashmap.h"
+#include "vsclib/rcu_hashmap.h"
+#include "vsclib/hashmap_typed.h"
+#include "vsclib/hashmap_snapshot.h"
+#include "vsclib/perfect_hash.h"
 #include "vsclib/time.h"
 #include "vsclib/colour.h"
 #include "vsclib/uuid.h"
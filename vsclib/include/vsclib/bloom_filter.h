@@ -0,0 +1,126 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_BLOOM_FILTER_H
+#define _VSCLIB_BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "bloom_filterdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a Bloom filter.
+ *
+ * A Bloom filter answers "definitely not present" or "possibly present" using a
+ * few bits per element. Elements can't be removed.
+ *
+ * The filter is split into 256-bit blocks. Each element sets one bit in each of
+ * the eight 32-bit words of a single block, so every operation touches one
+ * cache line, and the eight words are independent of each other.
+ *
+ * At 10 bits per element, about 1.3% of lookups for absent elements are false
+ * positives. At 16 bits per element, it's about 0.15%.
+ *
+ * @param capacity     The expected number of elements.
+ * @param bits_per_key The number of bits to allocate per element. Must not be 0.
+ * @param a            The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new filter. On failure, returns NULL.
+ */
+VscBloomFilter *vsc_bloom_filter_alloca(size_t capacity, size_t bits_per_key, const VscAllocator *a);
+VscBloomFilter *vsc_bloom_filter_alloc(size_t capacity, size_t bits_per_key);
+void            vsc_bloom_filter_free(VscBloomFilter *bf);
+
+/**
+ * @brief Remove every element.
+ */
+void vsc_bloom_filter_clear(VscBloomFilter *bf);
+
+/**
+ * @brief Add an element, identified by its hash.
+ *
+ * Any hash may be used, but the same one must be used for lookups.
+ *
+ * @param bf   The Bloom filter instance. Must not be NULL.
+ * @param hash The hash of the element.
+ */
+void vsc_bloom_filter_insert_hash(VscBloomFilter *bf, vsc_hash_t hash);
+
+/**
+ * @brief Check if an element, identified by its hash, may have been added.
+ *
+ * @param bf   The Bloom filter instance. Must not be NULL.
+ * @param hash The hash of the element.
+ *
+ * @return If the element may be present, returns 1. If it definitely isn't, returns 0.
+ */
+int vsc_bloom_filter_contains_hash(const VscBloomFilter *bf, vsc_hash_t hash);
+
+/**
+ * @brief Add an element, hashed with vsc_hash().
+ */
+void vsc_bloom_filter_insert(VscBloomFilter *bf, const void *data, size_t size);
+
+/**
+ * @brief Check if an element, hashed with vsc_hash(), may have been added.
+ */
+int vsc_bloom_filter_contains(const VscBloomFilter *bf, const void *data, size_t size);
+
+/**
+ * @brief Get the size of the filter, in bits.
+ */
+size_t vsc_bloom_filter_bits(const VscBloomFilter *bf);
+
+/**
+ * @brief Serialise a Bloom filter.
+ *
+ * The filter is written at the current position of \p f.
+ *
+ * @param bf The Bloom filter instance. Must not be NULL.
+ * @param f  The stream to write to. Must not be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ */
+int vsc_bloom_filter_write(const VscBloomFilter *bf, FILE *f);
+
+/**
+ * @brief Load a Bloom filter written by vsc_bloom_filter_write().
+ *
+ * The data is copied, and may be freed afterwards.
+ *
+ * @param bf   A pointer to receive the filter. Must not be NULL.
+ * @param data The serialised filter.
+ * @param size The size of \p data, in bytes.
+ * @param a    The allocator to use.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the data isn't a valid filter, `VSC_ERROR(EINVAL)` is returned.
+ */
+int vsc_bloom_filter_loada(VscBloomFilter **bf, const void *data, size_t size, const VscAllocator *a);
+int vsc_bloom_filter_load(VscBloomFilter **bf, const void *data, size_t size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_BLOOM_FILTER_H */
@@ -0,0 +1,164 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_CLOCK_CACHE_H
+#define _VSCLIB_CLOCK_CACHE_H
+
+#include <stddef.h>
+#include "clock_cachedef.h"
+#include "timedef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief The default number of shards, used if zero is passed to vsc_clock_cache_alloca().
+ */
+#define VSC_CLOCK_CACHE_DEFAULT_SHARDS 16
+
+/**
+ * @brief Allocate a thread-safe, bounded cache using CLOCK eviction.
+ *
+ * Keys are partitioned across a power-of-two number of shards by the high bits of
+ * their hash, as with #VscConcurrentHashMap. Each shard has its own lock, index,
+ * and fixed array of entries swept by a clock hand.
+ *
+ * Unlike #VscLruCache, a hit doesn't reorder anything, it only sets the entry's
+ * reference bit. Lookups never take the lock. They only count themselves in one of
+ * several per-shard stripes, picked per thread, so hits on different threads don't
+ * contend with each other or with writers. When room is needed, the hand clears
+ * reference bits until it finds an entry without one, or one that has expired.
+ *
+ * A dropped entry isn't reused or handed to the eviction procedure until no lookup
+ * can still be comparing against its key. Writers don't wait for this, it's checked
+ * in passing and done in batches, so the eviction procedure may be invoked a little
+ * later, from another call on the same shard.
+ *
+ * All memory is allocated up front.
+ *
+ * @param hash        The hash procedure. May not be NULL.
+ * @param compare     The key comparison procedure. May not be NULL.
+ * @param capacity    The maximum number of entries. This is divided evenly between the shards,
+ *                    rounding up. Must be nonzero.
+ * @param num_shards  The number of shards. Must be a power-of-two. If 0,
+ *                    #VSC_CLOCK_CACHE_DEFAULT_SHARDS is used.
+ * @param flags       A combination of #VscClockCacheFlags.
+ * @param evict       The eviction procedure. May be NULL. This is never called with a shard locked,
+ *                    so it may use the cache.
+ * @param user        A user-provided pointer passed to `evict`.
+ * @param a           The allocator to use. May not be NULL. Must be thread-safe.
+ *
+ * @return On success, returns the new cache. On failure, returns NULL.
+ */
+VscClockCache *vsc_clock_cache_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t capacity,
+                                      size_t num_shards, uint32_t flags, VscClockCacheEvictProc evict, void *user,
+                                      const VscAllocator *a);
+VscClockCache *vsc_clock_cache_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t capacity,
+                                     size_t num_shards, uint32_t flags, VscClockCacheEvictProc evict, void *user);
+
+/**
+ * @brief Free a cache. The eviction procedure is invoked for each remaining entry.
+ */
+void vsc_clock_cache_free(VscClockCache *cache);
+
+/**
+ * @brief Get the total number of entries the cache can hold.
+ */
+size_t vsc_clock_cache_capacity(const VscClockCache *cache);
+
+/**
+ * @brief Look up a key.
+ *
+ * This doesn't lock, unless the key has expired. Then it's dropped, the eviction procedure
+ * is invoked, and this counts as a miss.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ *
+ * @return If the key is present, returns its value. Otherwise, returns NULL.
+ *
+ * @remark The value may be evicted by another thread as soon as this returns. If the eviction
+ *         procedure releases values, they need to be reference counted.
+ */
+void *vsc_clock_cache_get(VscClockCache *cache, const void *key);
+
+/**
+ * @brief Insert or replace an entry.
+ *
+ * If the key's shard is full, an entry is evicted. If the key is already present,
+ * the eviction procedure is invoked on the replaced entry, unless both the key and
+ * value pointers are the ones being inserted. A replaced pointer the cache still
+ * holds, i.e. equal to `key` or `value`, is passed as NULL. If the key pointer
+ * changes, this waits until no lookup is using the old one.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ * @param value The value.
+ * @param ttl   The time-to-live of the entry, in nanoseconds. If 0, the entry never expires.
+ *
+ * @return If the entry was inserted, returns 0. If it was refused by admission control, returns 1.
+ *         On failure, returns a negative error value.
+ */
+int vsc_clock_cache_put(VscClockCache *cache, const void *key, void *value, vsc_counter_t ttl);
+
+/**
+ * @brief Remove an entry. The eviction procedure is not invoked.
+ *
+ * Once this returns, no lookup is still using the key, so it may be released.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ *
+ * @return If the key was present, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_clock_cache_remove(VscClockCache *cache, const void *key);
+
+/**
+ * @brief Remove every entry. The eviction procedure is invoked for each of them,
+ *        and any evicted earlier that are still pending, before this returns.
+ *
+ * @remark This isn't atomic with respect to other operations.
+ */
+void vsc_clock_cache_clear(VscClockCache *cache);
+
+/**
+ * @brief Get the number of entries in the cache.
+ *
+ * @remark This isn't atomic with respect to other operations.
+ */
+size_t vsc_clock_cache_size(VscClockCache *cache);
+
+/**
+ * @brief Get the lifetime counters of a cache, summed over every shard.
+ *
+ * The hit ratio is `hits / (hits + misses)`.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param stats A pointer to receive the counters. Must not be NULL.
+ *
+ * @remark This isn't atomic with respect to other operations.
+ */
+void vsc_clock_cache_stats(VscClockCache *cache, VscClockCacheStats *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_CLOCK_CACHE_H */
@@ -0,0 +1,62 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_CLOCK_CACHEDEF_H
+#define _VSCLIB_CLOCK_CACHEDEF_H
+
+#include "hashmapdef.h"
+
+typedef struct VscClockCache VscClockCache;
+
+typedef enum VscClockCacheFlags {
+    /**
+     * @brief Only let a new key displace an existing one the second time it's offered.
+     *
+     * Keys that are only ever requested once then never get to flush out the working set.
+     */
+    VSC_CLOCK_CACHE_DOORKEEPER = 1 << 0,
+} VscClockCacheFlags;
+
+/**
+ * @brief Called whenever a #VscClockCache drops an entry the caller hasn't taken back.
+ */
+typedef void (*VscClockCacheEvictProc)(const void *key, void *value, void *user);
+
+/**
+ * @brief Lifetime counters of a #VscClockCache, as reported by vsc_clock_cache_stats().
+ */
+typedef struct VscClockCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t insertions;
+    /**
+     * @brief The number of entries dropped to make room for another.
+     */
+    size_t evictions;
+    /**
+     * @brief The number of entries dropped because their time-to-live elapsed.
+     */
+    size_t expirations;
+    /**
+     * @brief The number of insertions refused by admission control.
+     */
+    size_t rejections;
+} VscClockCacheStats;
+
+#endif /* _VSCLIB_CLOCK_CACHEDEF_H */
@@ -0,0 +1,105 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_CONCURRENT_HASHMAP_H
+#define _VSCLIB_CONCURRENT_HASHMAP_H
+
+#include <stddef.h>
+#include "concurrent_hashmapdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief The default number of shards, used if zero is passed to vsc_concurrent_hashmap_alloca().
+ */
+#define VSC_CONCURRENT_HASHMAP_DEFAULT_SHARDS 16
+
+/**
+ * @brief Allocate a thread-safe hash map.
+ *
+ * Keys are partitioned across a power-of-two number of shards by the high bits of
+ * their hash. The hash is mixed first, so procs whose high bits are always zero
+ * (e.g. vsc_hashmap_default_hash()) still spread evenly. Each shard is an
+ * independent #VscHashMap with its own lock, so operations on different shards
+ * never contend.
+ *
+ * The hash and compare procedures are the same as for #VscHashMap.
+ *
+ * @param hash       The hash procedure. May not be NULL.
+ * @param compare    The key comparison procedure. May not be NULL.
+ * @param num_shards The number of shards. Must be a power-of-two. If 0,
+ *                   #VSC_CONCURRENT_HASHMAP_DEFAULT_SHARDS is used.
+ * @param a          The allocator to use. May not be NULL. Must be thread-safe.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ */
+VscConcurrentHashMap *vsc_concurrent_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                                    size_t num_shards, const VscAllocator *a);
+VscConcurrentHashMap *vsc_concurrent_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                                   size_t num_shards);
+void                  vsc_concurrent_hashmap_free(VscConcurrentHashMap *chm);
+
+size_t vsc_concurrent_hashmap_shard_count(const VscConcurrentHashMap *chm);
+
+/**
+ * @brief Configure the minimum and maximum load factors of every shard.
+ * @sa vsc_hashmap_configure()
+ */
+int vsc_concurrent_hashmap_configure(VscConcurrentHashMap *chm, uint16_t min_num, uint16_t min_den, uint16_t max_num,
+                                     uint16_t max_den);
+
+vsc_hash_t vsc_concurrent_hashmap_hash(const VscConcurrentHashMap *chm, const void *key);
+
+int   vsc_concurrent_hashmap_insert(VscConcurrentHashMap *chm, const void *key, void *value);
+void *vsc_concurrent_hashmap_find(VscConcurrentHashMap *chm, const void *key);
+int   vsc_concurrent_hashmap_update(VscConcurrentHashMap *chm, const void *key, void *value);
+void *vsc_concurrent_hashmap_remove(VscConcurrentHashMap *chm, const void *key);
+
+int   vsc_concurrent_hashmap_insert_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash, void *value);
+void *vsc_concurrent_hashmap_find_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash);
+int   vsc_concurrent_hashmap_update_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash, void *value);
+void *vsc_concurrent_hashmap_remove_with_hash(VscConcurrentHashMap *chm, const void *key, vsc_hash_t hash);
+
+/**
+ * @brief Get the number of elements in the map.
+ *
+ * @remark Shards are counted one at a time, so if the map is being concurrently
+ *         modified, this is only an approximation.
+ */
+size_t vsc_concurrent_hashmap_size(VscConcurrentHashMap *chm);
+
+void vsc_concurrent_hashmap_clear(VscConcurrentHashMap *chm);
+
+/**
+ * @brief Enumerate the map, one shard at a time.
+ *
+ * Each shard is locked while it is being enumerated.
+ *
+ * @remark \p proc must not call back into the map, it will deadlock.
+ * @sa vsc_hashmap_enumerate()
+ */
+int vsc_concurrent_hashmap_enumerate(VscConcurrentHashMap *chm, VscHashMapEnumProc proc, void *user);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_CONCURRENT_HASHMAP_H */
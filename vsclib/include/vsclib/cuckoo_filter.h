@@ -0,0 +1,133 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_CUCKOO_FILTER_H
+#define _VSCLIB_CUCKOO_FILTER_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "cuckoo_filterdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a cuckoo filter.
+ *
+ * Like a Bloom filter, this answers "definitely not present" or "possibly present",
+ * but elements can also be removed. Each element is a 16-bit fingerprint stored in
+ * one of two buckets of four. Each bucket is a single 64-bit word, so a lookup
+ * reads at most two words. About 0.01% of lookups for absent elements are
+ * false positives.
+ *
+ * The filter holds at least \p capacity elements. It can usually fit a few more,
+ * up to about 95% of its slots, before insertion fails.
+ *
+ * @param capacity The number of elements to hold.
+ * @param a        The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new filter. On failure, returns NULL.
+ */
+VscCuckooFilter *vsc_cuckoo_filter_alloca(size_t capacity, const VscAllocator *a);
+VscCuckooFilter *vsc_cuckoo_filter_alloc(size_t capacity);
+void             vsc_cuckoo_filter_free(VscCuckooFilter *cf);
+
+/**
+ * @brief Remove every element.
+ */
+void vsc_cuckoo_filter_clear(VscCuckooFilter *cf);
+
+/**
+ * @brief Add an element, identified by its hash.
+ *
+ * Adding the same element twice stores it twice, and it must then be removed twice.
+ *
+ * @param cf   The cuckoo filter instance. Must not be NULL.
+ * @param hash The hash of the element.
+ *
+ * @return On success, returns 0. If the filter is full, returns `VSC_ERROR(ENOSPC)`.
+ */
+int vsc_cuckoo_filter_insert_hash(VscCuckooFilter *cf, vsc_hash_t hash);
+
+/**
+ * @brief Check if an element, identified by its hash, may be present.
+ *
+ * @param cf   The cuckoo filter instance. Must not be NULL.
+ * @param hash The hash of the element.
+ *
+ * @return If the element may be present, returns 1. If it definitely isn't, returns 0.
+ */
+int vsc_cuckoo_filter_contains_hash(const VscCuckooFilter *cf, vsc_hash_t hash);
+
+/**
+ * @brief Remove an element, identified by its hash.
+ *
+ * Only remove elements that are known to have been added, otherwise another
+ * element with the same fingerprint may be removed instead.
+ *
+ * @param cf   The cuckoo filter instance. Must not be NULL.
+ * @param hash The hash of the element.
+ *
+ * @return If the element was removed, returns 0. If it wasn't found, returns 1.
+ */
+int vsc_cuckoo_filter_remove_hash(VscCuckooFilter *cf, vsc_hash_t hash);
+
+/**
+ * @brief Add an element, hashed with vsc_hash().
+ */
+int vsc_cuckoo_filter_insert(VscCuckooFilter *cf, const void *data, size_t size);
+
+/**
+ * @brief Check if an element, hashed with vsc_hash(), may be present.
+ */
+int vsc_cuckoo_filter_contains(const VscCuckooFilter *cf, const void *data, size_t size);
+
+/**
+ * @brief Remove an element, hashed with vsc_hash().
+ */
+int vsc_cuckoo_filter_remove(VscCuckooFilter *cf, const void *data, size_t size);
+
+size_t vsc_cuckoo_filter_size(const VscCuckooFilter *cf);
+
+/**
+ * @brief Check if the filter is full.
+ *
+ * Once full, every insertion fails until an element is removed.
+ */
+int vsc_cuckoo_filter_full(const VscCuckooFilter *cf);
+
+/**
+ * @brief Serialise a cuckoo filter.
+ * @sa vsc_bloom_filter_write()
+ */
+int vsc_cuckoo_filter_write(const VscCuckooFilter *cf, FILE *f);
+
+/**
+ * @brief Load a cuckoo filter written by vsc_cuckoo_filter_write().
+ * @sa vsc_bloom_filter_loada()
+ */
+int vsc_cuckoo_filter_loada(VscCuckooFilter **cf, const void *data, size_t size, const VscAllocator *a);
+int vsc_cuckoo_filter_load(VscCuckooFilter **cf, const void *data, size_t size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_CUCKOO_FILTER_H */
@@ -23,6 +23,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "hashdef.h"
+#include "memdef.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -31,9 +32,190 @@ extern "C" {
 vsc_hash_t vsc_hash(const void *data, size_t size);
 vsc_hash_t vsc_hash_string(const char *s);
 
+/**
+ * @brief Same as vsc_hash(), but with a seed.
+ *
+ * Use a secret, random seed when hashing untrusted input, so that colliding
+ * keys can't be precomputed.
+ */
+vsc_hash_t vsc_hash_seeded(const void *data, size_t size, uint64_t seed);
+vsc_hash_t vsc_hash_string_seeded(const char *s, uint64_t seed);
+
+/**
+ * @brief Calculate a 64-bit hash, regardless of the platform's word size.
+ *
+ * Unlike vsc_hash(), the result is the same on every platform,
+ * so it's suitable for persisting.
+ */
+uint64_t vsc_hash64(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief Begin a streaming hash.
+ *
+ * Feed the data in with vsc_hash_state_update(), in as many pieces as is convenient.
+ * vsc_hash_state_digest() then returns the same value vsc_hash() would for
+ * the concatenation of every piece.
+ */
+void vsc_hash_state_init(VscHashState *state);
+
+/**
+ * @brief Same as vsc_hash_state_init(), but the digest matches vsc_hash_seeded() instead.
+ */
+void vsc_hash_state_init_seeded(VscHashState *state, uint64_t seed);
+
+/**
+ * @brief Append data to a streaming hash.
+ *
+ * @return 0 on success, or `VSC_ERROR(EINVAL)` if \p data is NULL and \p size isn't 0.
+ */
+int vsc_hash_state_update(VscHashState *state, const void *data, size_t size);
+
+/**
+ * @brief Get the hash of everything appended so far.
+ *
+ * The state isn't modified, so more data may be appended afterwards.
+ */
+vsc_hash_t vsc_hash_state_digest(const VscHashState *state);
+
+/**
+ * @brief Copy a streaming hash, e.g. to hash several keys sharing a common prefix.
+ *
+ * This is the same as `*dst = *src`.
+ */
+void vsc_hash_state_copy(VscHashState *dst, const VscHashState *src);
+
+/**
+ * @brief Calculate a 128-bit hash.
+ *
+ * This is intended for content addressing, where even 64-bit collisions are
+ * too likely. Like vsc_hash64(), the result is the same on every platform.
+ *
+ * @return The hash, or one with every bit set if \p data is NULL and \p size isn't 0.
+ */
+VscHash128 vsc_hash128(const void *data, size_t size);
+VscHash128 vsc_hash128_seeded(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief The 128-bit equivalents of vsc_hash_state_init(), et al.
+ *
+ * The digest matches vsc_hash128() or vsc_hash128_seeded() of the concatenated data.
+ */
+void       vsc_hash128_state_init(VscHash128State *state);
+void       vsc_hash128_state_init_seeded(VscHash128State *state, uint64_t seed);
+int        vsc_hash128_state_update(VscHash128State *state, const void *data, size_t size);
+VscHash128 vsc_hash128_state_digest(const VscHash128State *state);
+void       vsc_hash128_state_copy(VscHash128State *dst, const VscHash128State *src);
+
+/**
+ * @brief Compare two 128-bit hashes numerically.
+ *
+ * @return <0, 0, or >0 if \p a is less than, equal to, or greater than \p b.
+ */
+int vsc_hash128_compare(const VscHash128 *a, const VscHash128 *b);
+
+/**
+ * @brief Format a 128-bit hash as 32 lower-case hex digits, most-significant first.
+ *
+ * This is the same as `xxhsum -H2`.
+ *
+ * @param dst A buffer of at least #VSC_HASH128_STRING_SIZE bytes.
+ * @return \p dst
+ */
+char *vsc_hash128_format(char *dst, const VscHash128 *hash);
+
+/**
+ * @brief Parse a 128-bit hash as formatted by vsc_hash128_format(). Either case is accepted.
+ *
+ * @return 0 on success, or `VSC_ERROR(EINVAL)` if \p s isn't exactly 32 hex digits.
+ */
+int vsc_hash128_parse(VscHash128 *hash, const char *s);
+
 uint32_t vsc_crc32(const void *data, size_t size);
 uint32_t vsc_crc32c(const void *data, size_t size);
 
+/**
+ * @brief Continue a CRC with more data.
+ *
+ * Start with a \p crc of 0. `vsc_crc32_update(vsc_crc32(a, n), b, m)` is the
+ * CRC of `a` followed by `b`.
+ */
+uint32_t vsc_crc32_update(uint32_t crc, const void *data, size_t size);
+uint32_t vsc_crc32c_update(uint32_t crc, const void *data, size_t size);
+
+/**
+ * @brief Combine the CRCs of two adjacent pieces of data, without the data.
+ *
+ * @param crc1  The CRC of the first piece.
+ * @param crc2  The CRC of the second piece.
+ * @param size2 The size of the second piece, in bytes.
+ *
+ * @return The CRC of the first piece followed by the second.
+ */
+uint32_t vsc_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t size2);
+uint32_t vsc_crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t size2);
+
+/**
+ * @brief Calculate a CRC by splitting the data into pieces, checksumming them
+ *        in parallel, and combining the results.
+ *
+ * vsclib doesn't create threads itself, \p proc is expected to spread the pieces
+ * across them. If it's NULL, they're done serially.
+ *
+ * @param num_chunks The number of pieces to split the data into, usually the number of threads.
+ *                   This is clamped to #VSC_CRC_PARALLEL_MAX_CHUNKS, and pieces are
+ *                   never smaller than #VSC_CRC_PARALLEL_MIN_CHUNK_SIZE.
+ *
+ * @return The same as vsc_crc32() or vsc_crc32c().
+ */
+uint32_t vsc_crc32_parallel(const void *data, size_t size, size_t num_chunks, VscParallelForProc proc, void *user);
+uint32_t vsc_crc32c_parallel(const void *data, size_t size, size_t num_chunks, VscParallelForProc proc, void *user);
+
+extern const VscCrcModel vsc_crc_model_crc32;
+extern const VscCrcModel vsc_crc_model_crc32c;
+extern const VscCrcModel vsc_crc_model_crc32_bzip2;
+/** \brief Also known as CRC-16/CCITT. */
+extern const VscCrcModel vsc_crc_model_crc16_kermit;
+/** \brief Also known as CRC-16/CCITT-FALSE. */
+extern const VscCrcModel vsc_crc_model_crc16_ibm_3740;
+extern const VscCrcModel vsc_crc_model_crc64_xz;
+extern const VscCrcModel vsc_crc_model_crc64_ecma_182;
+
+/**
+ * @brief Allocate a CRC engine for an arbitrary model.
+ *
+ * The lookup tables and folding constants are generated here, and the
+ * engine uses the same accelerated kernels as vsc_crc32() where the CPU
+ * supports them. It's immutable, so may be shared between threads.
+ *
+ * @param model The model. Is copied, so needn't outlive the engine.
+ * @param a     The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new engine. On failure, returns NULL.
+ *         This includes if \p model has an invalid width, or a polynomial
+ *         without the x^0 term.
+ */
+VscCrc *vsc_crc_alloca(const VscCrcModel *model, const VscAllocator *a);
+VscCrc *vsc_crc_alloc(const VscCrcModel *model);
+void    vsc_crc_free(VscCrc *crc);
+
+/**
+ * @brief Calculate a CRC in one go.
+ *
+ * @return The CRC, in the low `width` bits.
+ */
+uint64_t vsc_crc_calc(const VscCrc *crc, const void *data, size_t size);
+
+/**
+ * @brief Calculate a CRC incrementally.
+ *
+ * vsc_crc_begin() returns the initial state, which is passed through
+ * vsc_crc_update() for each piece of data. vsc_crc_end() then converts
+ * it into the CRC. The state is opaque, and isn't the CRC.
+ */
+uint64_t vsc_crc_begin(const VscCrc *crc);
+uint64_t vsc_crc_update(const VscCrc *crc, uint64_t state, const void *data, size_t size);
+uint64_t vsc_crc_end(const VscCrc *crc, uint64_t state);
+
 #if defined(__cplusplus)
 }
 #endif
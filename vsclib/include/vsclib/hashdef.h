@@ -21,9 +21,85 @@
 #define _VSCLIB_HASHDEF_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
 
 typedef size_t vsc_hash_t;
 
 #define VSC_INVALID_HASH (~(vsc_hash_t)0)
 
+/**
+ * @brief A 128-bit hash, as calculated by vsc_hash128().
+ */
+typedef struct VscHash128 {
+    uint64_t low;
+    uint64_t high;
+} VscHash128;
+
+/** \brief The size of a formatted #VscHash128, including the NUL terminator. */
+#define VSC_HASH128_STRING_SIZE 33 /* (16 * 2) + 1 */
+
+/** \brief The alignment of #VscHashState and #VscHash128State. */
+#define VSC_HASH_STATE_ALIGN 64
+
+/**
+ * @brief The state of a streaming hash. See vsc_hash_state_init().
+ *
+ * This is opaque, but may be copied by value. If allocated dynamically,
+ * the allocation must be aligned to #VSC_HASH_STATE_ALIGN.
+ */
+typedef struct VscHashState {
+    VSC_ALIGNAS(VSC_HASH_STATE_ALIGN) uint64_t opaque[80];
+} VscHashState;
+
+/**
+ * @brief The state of a streaming 128-bit hash. See vsc_hash128_state_init().
+ *
+ * Like #VscHashState, this may be copied by value.
+ */
+typedef struct VscHash128State {
+    VSC_ALIGNAS(VSC_HASH_STATE_ALIGN) uint64_t opaque[80];
+} VscHash128State;
+
+/**
+ * @brief The parameters of a CRC algorithm, as per the Rocksoft model used by the
+ *        catalogue at https://reveng.sourceforge.io/crc-catalogue/all.htm
+ *
+ * vsclib provides the common ones as `vsc_crc_model_*`.
+ */
+typedef struct VscCrcModel {
+    /** \brief The width of the CRC, in bits. Must be between 1 and 64. */
+    unsigned int width;
+    /** \brief The generator polynomial, unreflected and without the x^width term. */
+    uint64_t     poly;
+    /** \brief The initial register value, unreflected. */
+    uint64_t     init;
+    /** \brief Are the input bytes processed least-significant bit first? */
+    int          refin;
+    /** \brief Is the register reflected before xorout is applied? */
+    int          refout;
+    uint64_t     xorout;
+    /** \brief The CRC of the ASCII string "123456789". Not used in calculations. */
+    uint64_t     check;
+    const char  *name;
+} VscCrcModel;
+
+/**
+ * @brief A CRC engine for a specific #VscCrcModel. See vsc_crc_alloca().
+ */
+typedef struct VscCrc VscCrc;
+
+/**
+ * @brief Run `task(i, arg)` for every `i` in `[0, count)`, returning once they've all finished.
+ *
+ * The tasks are independent, so they may be run concurrently, e.g. on a thread pool.
+ */
+typedef void (*VscParallelForProc)(void (*task)(size_t i, void *arg), void *arg, size_t count, void *user);
+
+/** \brief The maximum number of pieces vsc_crc32_parallel() splits a buffer into. */
+#define VSC_CRC_PARALLEL_MAX_CHUNKS     64
+
+/** \brief The smallest piece vsc_crc32_parallel() splits a buffer into. */
+#define VSC_CRC_PARALLEL_MIN_CHUNK_SIZE (256 * 1024)
+
 #endif /* _VSCLIB_HASHDEF_H */
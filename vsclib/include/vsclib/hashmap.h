@@ -22,6 +22,8 @@
 
 #include <stddef.h>
 #include "hashmapdef.h"
+#include "bloom_filterdef.h"
+#include "cuckoo_filterdef.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -50,6 +52,129 @@ VscHashMap *vsc_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc co
 VscHashMap *vsc_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare);
 void        vsc_hashmap_free(VscHashMap *hm);
 
+/**
+ * @brief Allocate a hash map with a seeded hash procedure.
+ *
+ * Each map is given its own random seed, which is passed to `hash`. Use this when
+ * keys come from untrusted input, so an attacker can't precompute a set of keys that
+ * collide and turn every operation into a linear scan.
+ *
+ * @param hash    The seeded hash procedure. May not be NULL.
+ * @param compare The key comparison procedure. May not be NULL.
+ * @param a       The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ *
+ * @remark Hashes from vsc_hashmap_hash() are only valid for the map that produced them,
+ *         unless the seeds are made to match with vsc_hashmap_set_seed().
+ */
+VscHashMap *vsc_hashmap_alloca_seeded(VscHashMapSeededHashProc hash, VscHashMapCompareProc compare,
+                                      const VscAllocator *a);
+VscHashMap *vsc_hashmap_alloc_seeded(VscHashMapSeededHashProc hash, VscHashMapCompareProc compare);
+
+/**
+ * @brief Get the seed passed to the seeded hash procedure.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ * @return The map's seed. If the map doesn't have a seeded hash procedure, it's never
+ *         given one, so this is 0 unless set with vsc_hashmap_set_seed().
+ */
+uint64_t vsc_hashmap_seed(const VscHashMap *hm);
+
+/**
+ * @brief Set the seed passed to the seeded hash procedure.
+ *
+ * This may only be done while the map is empty.
+ *
+ * @param hm   The hash map instance. Must not be NULL.
+ * @param seed The new seed.
+ * @return On success, returns 0. If the map isn't empty, returns `VSC_ERROR(EBUSY)`.
+ */
+int vsc_hashmap_set_seed(VscHashMap *hm, uint64_t seed);
+
+/**
+ * @brief Create a copy of a hash map.
+ *
+ * The copy has the same elements, capacity, configuration and seed. The buckets
+ * are copied as-is, so nothing is rehashed or compared. Keys and values are
+ * shallow-copied.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ * @param a  The allocator the copy should use. May not be NULL.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ *
+ * @remark vsc_hashmap_clone() uses the allocator of \p hm.
+ */
+VscHashMap *vsc_hashmap_clonea(const VscHashMap *hm, const VscAllocator *a);
+VscHashMap *vsc_hashmap_clone(const VscHashMap *hm);
+
+/**
+ * @brief Create a copy-on-write copy of a hash map.
+ *
+ * Both maps share the same buckets until one of them is modified, at which point
+ * it takes its own copy. Taking a snapshot is then O(1), and only maps that are
+ * written to after it pay for the copy.
+ *
+ * The copy uses the allocator of \p hm. Maps sharing buckets may be used and freed
+ * from different threads.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ *
+ * @remark Modifying a map that shares its buckets can fail with `VSC_ERROR(ENOMEM)`,
+ *         this includes vsc_hashmap_update() and vsc_hashmap_clear().
+ *         If vsc_hashmap_remove() can't copy the buckets, it returns NULL
+ *         and nothing is removed. Use vsc_hashmap_remove_ex() to tell this
+ *         apart from the key not being present.
+ */
+VscHashMap *vsc_hashmap_clone_shared(VscHashMap *hm);
+
+/**
+ * @brief Attach a Bloom filter to a hash map.
+ *
+ * Every key in the map is added to the filter, and lookups of keys the filter
+ * rejects return without touching the buckets. This helps maps where most
+ * lookups are misses, as a miss otherwise probes until it finds an empty bucket.
+ *
+ * The filter is indexed with the hashes from vsc_hashmap_hash(). It isn't owned by
+ * the map, but must be dedicated to it and outlive the attachment. Removed keys
+ * stay in the filter, so if many are removed, false positives increase until the
+ * map is cleared.
+ *
+ * Clearing or resetting the map also clears the filter, but freeing it doesn't.
+ * Clones don't inherit the filter.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ * @param bf The filter. Must not be NULL.
+ *
+ * @return On success, returns 0. If a filter is already attached, returns `VSC_ERROR(EBUSY)`.
+ */
+int vsc_hashmap_attach_bloom_filter(VscHashMap *hm, VscBloomFilter *bf);
+
+/**
+ * @brief Attach a cuckoo filter to a hash map.
+ *
+ * The same as vsc_hashmap_attach_bloom_filter(), but removed keys are also removed
+ * from the filter.
+ *
+ * Once the filter is full, insertions into the map fail with `VSC_ERROR(ENOSPC)`.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ * @param cf The filter. Must not be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value, and
+ *         the filter is left as it was. If a filter is already attached, returns
+ *         `VSC_ERROR(EBUSY)`. If the filter can't hold every key, returns `VSC_ERROR(ENOSPC)`.
+ */
+int vsc_hashmap_attach_cuckoo_filter(VscHashMap *hm, VscCuckooFilter *cf);
+
+/**
+ * @brief Detach any filter from a hash map.
+ */
+void vsc_hashmap_detach_filter(VscHashMap *hm);
+
 int vsc_hashmap_clear(VscHashMap *hm);
 
 /**
@@ -79,6 +204,29 @@ int vsc_hashmap_configure(VscHashMap *hm, uint16_t min_num, uint16_t min_den, ui
  */
 void vsc_hashmap_reset(VscHashMap *hm);
 
+/**
+ * @brief Get the bucket layout of a hash map.
+ *
+ * @param hm The hash map instance. Must not be NULL.
+ * @return The bucket layout of the map.
+ */
+VscHashMapLayout vsc_hashmap_layout(const VscHashMap *hm);
+
+/**
+ * @brief Set the bucket layout of a hash map.
+ *
+ * This may only be done while the map has no buckets, i.e. immediately after
+ * allocation, or after vsc_hashmap_reset().
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param layout The new layout.
+ * @return On success, returns 0. If the function fails, it returns a negative error value.
+ *         The function can fail under the following conditions:
+ *         - `layout` is invalid.
+ *         - The map already has buckets allocated, in which case `VSC_ERROR(EBUSY)` is returned.
+ */
+int vsc_hashmap_set_layout(VscHashMap *hm, VscHashMapLayout layout);
+
 /**
  * @brief Resize a hash map so it can hold `nelem` elements.
  *
@@ -89,11 +237,147 @@ void vsc_hashmap_reset(VscHashMap *hm);
  *
  * @remark  This is *not* affected by the current resize policy.
  */
-int    vsc_hashmap_resize(VscHashMap *hm, size_t nelem);
+int vsc_hashmap_resize(VscHashMap *hm, size_t nelem);
+
+/**
+ * @brief Shrink a hash map to the capacity its load factor policy would choose for its current size.
+ *
+ * If the map is empty, all memory is released, as with vsc_hashmap_reset().
+ *
+ * @param   hm The hash map instance. Must not be NULL.
+ * @return  On success, returns 0. If the function fails, it returns a negative error value.
+ *          On failure, the map is left untouched.
+ *
+ * @remark  This is *not* affected by the current resize policy.
+ */
+int vsc_hashmap_shrink_to_fit(VscHashMap *hm);
+
 int    vsc_hashmap_insert(VscHashMap *hm, const void *key, void *value);
 void  *vsc_hashmap_find_by_hash(const VscHashMap *hm, vsc_hash_t hash);
 void  *vsc_hashmap_find(const VscHashMap *hm, const void *key);
 
+/**
+ * @brief Same as vsc_hashmap_insert(), but use a caller-supplied hash.
+ *
+ * This allows a key to be hashed once and reused across several operations,
+ * or maps sharing the same hash procedure.
+ *
+ * @param hm    The hash map instance. Must not be NULL.
+ * @param key   The key to insert.
+ * @param hash  The hash of \p key, as returned by vsc_hashmap_hash().
+ * @param value The value.
+ *
+ * @return On success, returns 0. If the function fails, it returns a negative error value.
+ *
+ * @remark Unlike vsc_hashmap_find_by_hash(), keys are still compared using the map's compare procedure.
+ */
+int vsc_hashmap_insert_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash, void *value);
+
+/**
+ * @brief Insert many key/value pairs at once.
+ *
+ * This is equivalent to calling vsc_hashmap_insert() for each pair, but the map is
+ * resized once up-front to fit everything, instead of growing incrementally.
+ * Duplicate keys behave as they would with vsc_hashmap_insert(), the last one wins.
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param keys   An array of \p n keys.
+ * @param values An array of \p n values.
+ * @param n      The number of pairs.
+ *
+ * @return On success, returns 0. If the function fails, it returns a negative error value.
+ *         On failure, some of the pairs may have been inserted.
+ *
+ * @remark If the resize policy is #VSC_HASHMAP_RESIZE_NONE, the map isn't resized.
+ */
+int vsc_hashmap_build(VscHashMap *hm, const void *const *keys, void *const *values, size_t n);
+
+/**
+ * @brief Same as vsc_hashmap_build(), but hash the keys in parallel first.
+ *
+ * Hashing is usually the most expensive part of building a large map, and is independent
+ * for each key. The keys are split into chunks, which \p proc is expected to spread across
+ * threads. The hash procedure must be safe to call concurrently. The insertion itself is serial.
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param keys   An array of \p n keys.
+ * @param values An array of \p n values.
+ * @param n      The number of pairs.
+ * @param proc   The procedure used to run the hashing tasks. If NULL, or if there's
+ *               too few keys to be worth it, this behaves like vsc_hashmap_build().
+ * @param user   A user-provided pointer passed to \p proc.
+ *
+ * @return On success, returns 0. If the function fails, it returns a negative error value.
+ *         On failure, some of the pairs may have been inserted.
+ */
+int vsc_hashmap_build_parallel(VscHashMap *hm, const void *const *keys, void *const *values, size_t n,
+                               VscParallelForProc proc, void *user);
+
+/**
+ * @brief Same as vsc_hashmap_build(), but use caller-supplied hashes.
+ *
+ * This allows the caller to compute the hashes beforehand, or to reuse them.
+ * See also vsc_hashmap_build_parallel().
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param keys   An array of \p n keys.
+ * @param hashes An array of \p n hashes. `hashes[i]` must be the hash of `keys[i]`,
+ *               as returned by vsc_hashmap_hash().
+ * @param values An array of \p n values.
+ * @param n      The number of pairs.
+ *
+ * @return On success, returns 0. If the function fails, it returns a negative error value.
+ *         On failure, some of the pairs may have been inserted.
+ */
+int vsc_hashmap_build_with_hash(VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes,
+                                void *const *values, size_t n);
+
+/**
+ * @brief Same as vsc_hashmap_find(), but use a caller-supplied hash.
+ *
+ * @param hm   The hash map instance. Must not be NULL.
+ * @param key  The key to find.
+ * @param hash The hash of \p key, as returned by vsc_hashmap_hash().
+ *
+ * @return If the key exists, returns its value. Otherwise, returns NULL.
+ *
+ * @remark Unlike vsc_hashmap_find_by_hash(), keys are still compared using the map's compare procedure.
+ */
+void *vsc_hashmap_find_with_hash(const VscHashMap *hm, const void *key, vsc_hash_t hash);
+
+/**
+ * @brief Find the values of many keys at once.
+ *
+ * This is equivalent to calling vsc_hashmap_find() for each key, but all the keys in a
+ * batch are hashed and have their buckets prefetched before any are resolved.
+ * For large maps this hides much of the memory latency of each lookup.
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param keys   An array of \p n keys to look up.
+ * @param n      The number of keys.
+ * @param values An array of \p n pointers to receive the values. If a key isn't found,
+ *               its value is set to NULL.
+ *
+ * @return The number of keys that were found.
+ */
+size_t vsc_hashmap_find_batch(const VscHashMap *hm, const void *const *keys, size_t n, void **values);
+
+/**
+ * @brief Same as vsc_hashmap_find_batch(), but use caller-supplied hashes.
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param keys   An array of \p n keys to look up.
+ * @param hashes An array of \p n hashes. `hashes[i]` must be the hash of `keys[i]`,
+ *               as returned by vsc_hashmap_hash().
+ * @param n      The number of keys.
+ * @param values An array of \p n pointers to receive the values. If a key isn't found,
+ *               its value is set to NULL.
+ *
+ * @return The number of keys that were found.
+ */
+size_t vsc_hashmap_find_batch_with_hash(const VscHashMap *hm, const void *const *keys, const vsc_hash_t *hashes,
+                                        size_t n, void **values);
+
 /**
  * @brief Update an existing value in the hash map.
  *
@@ -106,17 +390,79 @@ void  *vsc_hashmap_find(const VscHashMap *hm, const void *key);
  * @param key   The key to update.
  * @param value The new value.
  *
- * @return If the key exists, the value is set to \p value, returns 1.
- *         If the key doesn't exist, returns 0.
+ * @return If the key exists, the value is set to \p value, returns 0.
+ *         If the key doesn't exist, returns 1.
+ *         If the map shares its buckets and they can't be copied, returns a negative
+ *         error value, and nothing is changed. See vsc_hashmap_clone_shared().
  */
-int    vsc_hashmap_update(const VscHashMap *hm, const void *key, void *value);
-void  *vsc_hashmap_remove(VscHashMap *hm, const void *key);
+int vsc_hashmap_update(VscHashMap *hm, const void *key, void *value);
+
+/**
+ * @brief Same as vsc_hashmap_update(), but use a caller-supplied hash.
+ *
+ * @param hm    The hash map instance. Must not be NULL.
+ * @param key   The key to update.
+ * @param hash  The hash of \p key, as returned by vsc_hashmap_hash().
+ * @param value The new value.
+ */
+int vsc_hashmap_update_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash, void *value);
+
+/**
+ * @brief Remove a key from the hash map.
+ *
+ * If the resize policy is #VSC_HASHMAP_RESIZE_LOAD_FACTOR and the load factor drops
+ * below half of the configured minimum, the map is shrunk back to the minimum load factor.
+ *
+ * @param hm  The hash map instance. Must not be NULL.
+ * @param key The key to remove.
+ *
+ * @return If the key exists, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_hashmap_remove(VscHashMap *hm, const void *key);
+
+/**
+ * @brief Same as vsc_hashmap_remove(), but use a caller-supplied hash.
+ *
+ * @param hm   The hash map instance. Must not be NULL.
+ * @param key  The key to remove.
+ * @param hash The hash of \p key, as returned by vsc_hashmap_hash().
+ *
+ * @return If the key exists, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_hashmap_remove_with_hash(VscHashMap *hm, const void *key, vsc_hash_t hash);
+
+/**
+ * @brief Same as vsc_hashmap_remove_with_hash(), but report failure separately.
+ *
+ * @param hm    The hash map instance. Must not be NULL.
+ * @param key   The key to remove.
+ * @param hash  The hash of \p key, as returned by vsc_hashmap_hash().
+ * @param value A pointer to receive the removed value. May be NULL.
+ *
+ * @return If the key was removed, returns 0. If it isn't present, returns 1.
+ *         On failure, returns a negative error value, and nothing is removed.
+ *         This can only fail if the map shares its buckets, see vsc_hashmap_clone_shared().
+ */
+int vsc_hashmap_remove_ex(VscHashMap *hm, const void *key, vsc_hash_t hash, void **value);
+
 size_t vsc_hashmap_size(const VscHashMap *hm);
 size_t vsc_hashmap_capacity(const VscHashMap *hm);
 
 VscHashMapResizePolicy vsc_hashmap_resize_policy(const VscHashMap *hm);
 VscHashMapResizePolicy vsc_hashmap_set_resize_policy(VscHashMap *hm, VscHashMapResizePolicy policy);
 
+/**
+ * @brief Gather statistics about a hash map, to help diagnose poor hash procedures.
+ *
+ * @param hm    The hash map instance. Must not be NULL.
+ * @param stats A pointer to receive the statistics. Must not be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *
+ * @remark This walks every bucket, so isn't cheap.
+ */
+int vsc_hashmap_stats(const VscHashMap *hm, VscHashMapStats *stats);
+
 /**
  * @brief Get a pointer to the first bucket. This may be empty.
  *
@@ -124,15 +470,49 @@ VscHashMapResizePolicy vsc_hashmap_set_resize_policy(VscHashMap *hm, VscHashMapR
  *
  * @return If map is empty, i.e. if vsc_hashmap_capacity() returns 0, this will return NULL.
  *         Otherwise, returns a pointer to the first (possibly empty), bucket.
+ *
+ * @remark Maps using #VSC_HASHMAP_LAYOUT_COMPACT have no buckets, and always return NULL.
+ *         Use vsc_hashmap_get_bucket() to walk the buckets of a map of any layout.
  */
 const VscHashMapBucket *vsc_hashmap_first(const VscHashMap *hm);
 
+/**
+ * @brief Copy out a bucket, regardless of the map's layout.
+ *
+ * Iterating \p index from 0 to vsc_hashmap_capacity() visits the same buckets as
+ * indexing the result of vsc_hashmap_first(). For #VSC_HASHMAP_LAYOUT_COMPACT,
+ * the hash is recalculated.
+ *
+ * @param hm     The hash map instance. Must not be NULL.
+ * @param index  The bucket index.
+ * @param bucket A pointer to receive the bucket. If it's empty, its hash
+ *               is VSC_INVALID_HASH and its key and value are NULL.
+ *
+ * @return On success, returns 0. If \p index is out of range, or \p bucket is NULL,
+ *         returns `VSC_ERROR(EINVAL)`.
+ */
+int vsc_hashmap_get_bucket(const VscHashMap *hm, size_t index, VscHashMapBucket *bucket);
+
 int vsc_hashmap_enumerate(const VscHashMap *hm, VscHashMapEnumProc proc, void *user);
 
 vsc_hash_t vsc_hashmap_default_hash(const void *k);
 int        vsc_hashmap_default_compare(const void *a, const void *b);
 
+/**
+ * @brief Hash a C string. This is the same as vsc_hash_string(), so is stable between runs.
+ */
 vsc_hash_t vsc_hashmap_string_hash(const void *s);
+
+/**
+ * @brief Hash a C string, seeded with a random value chosen once per process.
+ *
+ * Unlike vsc_hashmap_string_hash(), the hash will differ between runs, so it
+ * mustn't be persisted or compared across processes. Prefer
+ * vsc_hashmap_string_hash_seeded() with vsc_hashmap_alloca_seeded(), which
+ * gives each map its own seed.
+ */
+vsc_hash_t vsc_hashmap_string_hash_random(const void *s);
+vsc_hash_t vsc_hashmap_string_hash_seeded(const void *s, uint64_t seed);
 int        vsc_hashmap_string_compare(const void *a, const void *b);
 
 #if defined(__cplusplus)
@@ -0,0 +1,100 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_HASHMAP_SNAPSHOT_H
+#define _VSCLIB_HASHMAP_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "hashmap_snapshotdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Serialise a hash map into a read-only, position-independent snapshot.
+ *
+ * Each pair is converted to bytes by \p proc. Keys are looked up by their encoded
+ * bytes, so the encoding of a key must be unique and deterministic.
+ *
+ * The snapshot is written at the current position of \p f, which must be seekable.
+ * All values are 8-byte aligned relative to the start of the snapshot.
+ *
+ * @param hm   The hash map. Must not be NULL.
+ * @param f    The stream to write to. Must not be NULL.
+ * @param proc The encoding procedure. Must not be NULL. If it returns nonzero,
+ *             writing stops and `VSC_ERROR(ECANCELED)` is returned.
+ * @param user A user-provided pointer passed to \p proc.
+ * @param a    The allocator to use for temporary storage.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ */
+int vsc_hashmap_snapshot_writea(const VscHashMap *hm, FILE *f, VscHashMapSnapshotEncodeProc proc, void *user,
+                                const VscAllocator *a);
+int vsc_hashmap_snapshot_write(const VscHashMap *hm, FILE *f, VscHashMapSnapshotEncodeProc proc, void *user);
+
+/**
+ * @brief Memory-map a snapshot file.
+ *
+ * Only the header is validated, nothing is parsed or copied. Lookups
+ * are served directly from the mapping.
+ *
+ * @param snap A pointer to receive the snapshot. Must not be NULL.
+ * @param path The path of the snapshot file. Must not be NULL.
+ * @param a    The allocator to use.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the file isn't a valid snapshot, `VSC_ERROR(EINVAL)` is returned.
+ */
+int vsc_hashmap_snapshot_opena(VscHashMapSnapshot **snap, const char *path, const VscAllocator *a);
+int vsc_hashmap_snapshot_open(VscHashMapSnapshot **snap, const char *path);
+
+/**
+ * @brief Use a snapshot already in memory.
+ *
+ * The data isn't copied, and must outlive the snapshot. It must be at least 8-byte aligned.
+ *
+ * @sa vsc_hashmap_snapshot_opena()
+ */
+int vsc_hashmap_snapshot_loada(VscHashMapSnapshot **snap, const void *data, size_t size, const VscAllocator *a);
+int vsc_hashmap_snapshot_load(VscHashMapSnapshot **snap, const void *data, size_t size);
+
+void vsc_hashmap_snapshot_close(VscHashMapSnapshot *snap);
+
+size_t vsc_hashmap_snapshot_size(const VscHashMapSnapshot *snap);
+
+/**
+ * @brief Find the value of an encoded key.
+ *
+ * @param snap       The snapshot. Must not be NULL.
+ * @param key        The encoded key.
+ * @param key_size   The size of \p key, in bytes.
+ * @param value_size A pointer to receive the size of the value. May be NULL.
+ *
+ * @return If found, returns a pointer to the value within the snapshot. Otherwise, returns NULL.
+ */
+const void *vsc_hashmap_snapshot_find(const VscHashMapSnapshot *snap, const void *key, size_t key_size,
+                                      size_t *value_size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_HASHMAP_SNAPSHOT_H */
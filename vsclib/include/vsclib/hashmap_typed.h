@@ -0,0 +1,264 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_HASHMAP_TYPED_H
+#define _VSCLIB_HASHMAP_TYPED_H
+
+/*
+ * Generator for typed hash maps.
+ *
+ * VSC_HASHMAP_DECLARE(name, K, V, hashfn, eqfn) emits a map type `name`, storing K and V
+ * inline, and a set of static inline functions prefixed with `name_`:
+ *
+ *   void    name_init(name *m, const VscAllocator *a);
+ *   void    name_reset(name *m);
+ *   void    name_clear(name *m);
+ *   size_t  name_size(const name *m);
+ *   int     name_resize(name *m, size_t nelem);
+ *   int     name_insert(name *m, K key, V value);
+ *   V      *name_find(const name *m, K key);
+ *   int     name_remove(name *m, K key, V *value);
+ *   int     name_enumerate(name *m, int (*proc)(const K *key, V *value, void *user), void *user);
+ *
+ * - `vsc_hash_t hashfn(K key)` hashes a key. The low bits must be well-mixed,
+ *   as the bucket count is always a power-of-two. See vsc_hashmap_mix64().
+ * - `int eqfn(K a, K b)` returns nonzero if the keys are equal, as with #VscHashMapCompareProc.
+ *
+ * Both may be functions or function-like macros. As they're called directly,
+ * they can be inlined.
+ *
+ * The probing scheme is the same as #VscHashMap: linear probing, with
+ * #VSC_INVALID_HASH marking an empty bucket.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+#include "hashdef.h"
+#include "mem.h"
+
+/**
+ * @brief Mix a 64-bit integer into a hash. Suitable for integer keys.
+ */
+static inline vsc_hash_t vsc_hashmap_mix64(uint64_t x)
+{
+    /* splitmix64 finaliser */
+    x ^= x >> 30;
+    x *= UINT64_C(0xBF58476D1CE4E5B9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94D049BB133111EB);
+    x ^= x >> 31;
+    return (vsc_hash_t)x;
+}
+
+#define VSC_HASHMAP_TYPED_MIN_BUCKETS 16
+
+#define VSC_HASHMAP_DECLARE(name, K, V, hashfn, eqfn)                                                       \
+    typedef struct name##_slot {                                                                             \
+        vsc_hash_t hash;                                                                                     \
+        K          key;                                                                                      \
+        V          value;                                                                                    \
+    } name##_slot;                                                                                           \
+                                                                                                             \
+    typedef struct name {                                                                                    \
+        size_t              size;                                                                            \
+        size_t              num_buckets;                                                                     \
+        name##_slot        *slots;                                                                           \
+        const VscAllocator *allocator;                                                                       \
+    } name;                                                                                                  \
+                                                                                                             \
+    static inline vsc_hash_t name##__hash(K key)                                                             \
+    {                                                                                                        \
+        vsc_hash_t h = hashfn(key);                                                                          \
+        return h == VSC_INVALID_HASH ? h - 1 : h;                                                            \
+    }                                                                                                        \
+                                                                                                             \
+    /* Returns the index of the key, or num_buckets if not found. */                                         \
+    static inline size_t name##__lookup(const name *m, K key, vsc_hash_t hash)                               \
+    {                                                                                                        \
+        size_t mask, i;                                                                                      \
+                                                                                                             \
+        if(m->num_buckets == 0)                                                                              \
+            return 0;                                                                                        \
+                                                                                                             \
+        mask = m->num_buckets - 1;                                                                           \
+        for(i = hash & mask;; i = (i + 1) & mask) {                                                          \
+            const name##_slot *s = m->slots + i;                                                             \
+                                                                                                             \
+            if(s->hash == VSC_INVALID_HASH)                                                                  \
+                return m->num_buckets;                                                                       \
+                                                                                                             \
+            if(s->hash == hash && eqfn(s->key, key))                                                         \
+                return i;                                                                                    \
+        }                                                                                                    \
+    }                                                                                                        \
+                                                                                                             \
+    /* Add a key that is known not to be present. There must be an empty bucket. */                         \
+    static inline void name##__add(name##_slot *slots, size_t num_buckets, vsc_hash_t hash, K key, V value)  \
+    {                                                                                                        \
+        size_t mask = num_buckets - 1, i;                                                                    \
+                                                                                                             \
+        for(i = hash & mask; slots[i].hash != VSC_INVALID_HASH; i = (i + 1) & mask)                          \
+            ;                                                                                                \
+                                                                                                             \
+        slots[i].hash  = hash;                                                                               \
+        slots[i].key   = key;                                                                                \
+        slots[i].value = value;                                                                              \
+    }                                                                                                        \
+                                                                                                             \
+    static inline void name##_init(name *m, const VscAllocator *a)                                           \
+    {                                                                                                        \
+        m->size        = 0;                                                                                  \
+        m->num_buckets = 0;                                                                                  \
+        m->slots       = NULL;                                                                               \
+        m->allocator   = a != NULL ? a : vsclib_system_allocator;                                            \
+    }                                                                                                        \
+                                                                                                             \
+    static inline void name##_reset(name *m)                                                                 \
+    {                                                                                                        \
+        vsc_xfree(m->allocator, m->slots);                                                                   \
+        m->size        = 0;                                                                                  \
+        m->num_buckets = 0;                                                                                  \
+        m->slots       = NULL;                                                                               \
+    }                                                                                                        \
+                                                                                                             \
+    static inline void name##_clear(name *m)                                                                 \
+    {                                                                                                        \
+        for(size_t i = 0; i < m->num_buckets; ++i)                                                           \
+            m->slots[i].hash = VSC_INVALID_HASH;                                                             \
+        m->size = 0;                                                                                         \
+    }                                                                                                        \
+                                                                                                             \
+    static inline size_t name##_size(const name *m)                                                          \
+    {                                                                                                        \
+        return m->size;                                                                                      \
+    }                                                                                                        \
+                                                                                                             \
+    /* Resize so that nelem elements fit under a 3/4 load factor. Never shrinks below size. */               \
+    static inline int name##_resize(name *m, size_t nelem)                                                   \
+    {                                                                                                        \
+        name##_slot *slots;                                                                                  \
+        size_t       num_buckets = VSC_HASHMAP_TYPED_MIN_BUCKETS;                                            \
+                                                                                                             \
+        if(nelem < m->size)                                                                                  \
+            nelem = m->size;                                                                                 \
+                                                                                                             \
+        while(num_buckets - num_buckets / 4 < nelem) {                                                       \
+            if(num_buckets > SIZE_MAX / 2 / sizeof(name##_slot))                                             \
+                return VSC_ERROR(ERANGE);                                                                    \
+            num_buckets *= 2;                                                                                \
+        }                                                                                                    \
+                                                                                                             \
+        if(num_buckets == m->num_buckets)                                                                    \
+            return 0;                                                                                        \
+                                                                                                             \
+        if((slots = (name##_slot *)vsc_xalloc(m->allocator, num_buckets * sizeof(name##_slot))) == NULL)     \
+            return VSC_ERROR(ENOMEM);                                                                        \
+                                                                                                             \
+        for(size_t i = 0; i < num_buckets; ++i)                                                              \
+            slots[i].hash = VSC_INVALID_HASH;                                                                \
+                                                                                                             \
+        for(size_t i = 0; i < m->num_buckets; ++i) {                                                         \
+            const name##_slot *s = m->slots + i;                                                             \
+            if(s->hash != VSC_INVALID_HASH)                                                                  \
+                name##__add(slots, num_buckets, s->hash, s->key, s->value);                                  \
+        }                                                                                                    \
+                                                                                                             \
+        vsc_xfree(m->allocator, m->slots);                                                                   \
+        m->slots       = slots;                                                                              \
+        m->num_buckets = num_buckets;                                                                        \
+        return 0;                                                                                            \
+    }                                                                                                        \
+                                                                                                             \
+    /* Insert a key, replacing it if it already exists. */                                                   \
+    static inline int name##_insert(name *m, K key, V value)                                                 \
+    {                                                                                                        \
+        vsc_hash_t hash = name##__hash(key);                                                                 \
+        size_t     i    = name##__lookup(m, key, hash);                                                      \
+        int        r;                                                                                        \
+                                                                                                             \
+        if(i < m->num_buckets) {                                                                             \
+            m->slots[i].value = value;                                                                       \
+            return 0;                                                                                        \
+        }                                                                                                    \
+                                                                                                             \
+        if(m->size + 1 > m->num_buckets - m->num_buckets / 4) {                                              \
+            if((r = name##_resize(m, m->size + 1)) < 0)                                                      \
+                return r;                                                                                    \
+        }                                                                                                    \
+                                                                                                             \
+        name##__add(m->slots, m->num_buckets, hash, key, value);                                             \
+        ++m->size;                                                                                           \
+        return 0;                                                                                            \
+    }                                                                                                        \
+                                                                                                             \
+    /* Returns a pointer to the value, or NULL if not found. Invalidated by insert/remove. */                \
+    static inline V *name##_find(const name *m, K key)                                                       \
+    {                                                                                                        \
+        size_t i = name##__lookup(m, key, name##__hash(key));                                                \
+        return i < m->num_buckets ? &m->slots[i].value : NULL;                                               \
+    }                                                                                                        \
+                                                                                                             \
+    /* Returns 0 if removed, storing the old value in *value if not NULL. Returns 1 if not found. */         \
+    static inline int name##_remove(name *m, K key, V *value)                                                \
+    {                                                                                                        \
+        size_t i = name##__lookup(m, key, name##__hash(key)), j, mask;                                       \
+                                                                                                             \
+        if(i >= m->num_buckets)                                                                              \
+            return 1;                                                                                        \
+                                                                                                             \
+        if(value != NULL)                                                                                    \
+            *value = m->slots[i].value;                                                                      \
+                                                                                                             \
+        /* Backward-shift deletion, no tombstones. */                                                        \
+        mask = m->num_buckets - 1;                                                                           \
+        for(j = (i + 1) & mask; m->slots[j].hash != VSC_INVALID_HASH; j = (j + 1) & mask) {                  \
+            size_t home = m->slots[j].hash & mask;                                                           \
+                                                                                                             \
+            /* Leave it if its home is cyclically within (i, j]. */                                          \
+            if(i <= j ? (i < home && home <= j) : (i < home || home <= j))                                   \
+                continue;                                                                                    \
+                                                                                                             \
+            m->slots[i] = m->slots[j];                                                                       \
+            i           = j;                                                                                 \
+        }                                                                                                    \
+                                                                                                             \
+        m->slots[i].hash = VSC_INVALID_HASH;                                                                 \
+        --m->size;                                                                                           \
+        return 0;                                                                                            \
+    }                                                                                                        \
+                                                                                                             \
+    /* Stops and returns the first nonzero value returned by proc. */                                        \
+    static inline int name##_enumerate(name *m, int (*proc)(const K *key, V *value, void *user), void *user) \
+    {                                                                                                        \
+        for(size_t i = 0; i < m->num_buckets; ++i) {                                                         \
+            int r;                                                                                           \
+                                                                                                             \
+            if(m->slots[i].hash == VSC_INVALID_HASH)                                                         \
+                continue;                                                                                    \
+                                                                                                             \
+            if((r = proc(&m->slots[i].key, &m->slots[i].value, user)) != 0)                                  \
+                return r;                                                                                    \
+        }                                                                                                    \
+                                                                                                             \
+        return 0;                                                                                            \
+    }
+
+#endif /* _VSCLIB_HASHMAP_TYPED_H */
@@ -29,7 +29,26 @@ typedef enum VscHashMapResizePolicy {
     VSC_HASHMAP_RESIZE_NONE        = 1,
 } VscHashMapResizePolicy;
 
+/**
+ * @brief The in-memory layout of a hash map's buckets.
+ */
+typedef enum VscHashMapLayout {
+    /**
+     * @brief Each bucket is a #VscHashMapBucket.
+     */
+    VSC_HASHMAP_LAYOUT_BUCKETS = 0,
+    /**
+     * @brief Structure-of-arrays layout.
+     *
+     * Truncated 32-bit hash tags, keys and values are stored in separate, parallel arrays.
+     * Probing only touches the tags until a match is found, so far fewer cache lines are
+     * scanned. The full hash isn't stored, so it's recalculated where needed.
+     */
+    VSC_HASHMAP_LAYOUT_COMPACT = 1,
+} VscHashMapLayout;
+
 typedef vsc_hash_t (*VscHashMapHashProc)(const void *key);
+typedef vsc_hash_t (*VscHashMapSeededHashProc)(const void *key, uint64_t seed);
 typedef int (*VscHashMapCompareProc)(const void *a, const void *b);
 typedef int (*VscHashMapEnumProc)(const void *key, void *value, vsc_hash_t hash, void *user);
 
@@ -42,6 +61,55 @@ typedef struct VscHashMapBucket {
     void       *value;
 } VscHashMapBucket;
 
+/**
+ * @brief The number of bins in VscHashMapStats::probe_histogram.
+ */
+#define VSC_HASHMAP_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * @brief Hash map statistics, as reported by vsc_hashmap_stats().
+ *
+ * The probe length of an element is its distance from its home bucket,
+ * i.e. 0 if it's in its home bucket.
+ */
+typedef struct VscHashMapStats {
+    size_t size;
+    size_t num_buckets;
+    double load_factor;
+
+    double mean_probe_length;
+    size_t max_probe_length;
+    /**
+     * @brief The number of elements with each probe length. The last bin
+     *        also counts everything longer.
+     */
+    size_t probe_histogram[VSC_HASHMAP_STATS_HISTOGRAM_SIZE];
+
+    /**
+     * @brief The number of runs of occupied buckets.
+     */
+    size_t num_clusters;
+    size_t longest_cluster;
+
+    /**
+     * @brief The number of elements that share their hash with an element
+     *        earlier in their probe sequence. Looking these up requires
+     *        calling the compare procedure on a non-matching key.
+     *
+     * For #VSC_HASHMAP_LAYOUT_COMPACT, this compares the 32-bit tags.
+     */
+    size_t hash_collisions;
+
+    /**
+     * @brief The number of times the map has been resized.
+     */
+    size_t num_resizes;
+    /**
+     * @brief The total number of elements moved by resizes.
+     */
+    size_t num_rehashed;
+} VscHashMapStats;
+
 typedef struct VscHashMap VscHashMap;
 
 #endif /* _VSCLIB_HASHMAPDEF_H */
@@ -0,0 +1,170 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_HASHSET_H
+#define _VSCLIB_HASHSET_H
+
+#include <stddef.h>
+#include "hashsetdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a hash set.
+ *
+ * This is a #VscHashMap without values. It uses the same probing and resizing,
+ * but each bucket is only a hash and key pointer, a third smaller than a
+ * #VscHashMapBucket, so membership tests touch less memory.
+ *
+ * The hash and compare procedures are the same as for #VscHashMap.
+ *
+ * @param hash    The hash procedure. May not be NULL.
+ * @param compare The key comparison procedure. May not be NULL.
+ * @param a       The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new set. On failure, returns NULL.
+ */
+VscHashSet *vsc_hashset_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a);
+VscHashSet *vsc_hashset_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare);
+void        vsc_hashset_free(VscHashSet *set);
+
+/**
+ * @brief Remove every key, keeping the buckets.
+ */
+void vsc_hashset_clear(VscHashSet *set);
+
+/**
+ * @brief Remove every key, releasing all memory.
+ */
+void vsc_hashset_reset(VscHashSet *set);
+
+/**
+ * @brief Configure the minimum and maximum load factors of the set.
+ * @sa vsc_hashmap_configure()
+ */
+int vsc_hashset_configure(VscHashSet *set, uint16_t min_num, uint16_t min_den, uint16_t max_num, uint16_t max_den);
+
+/**
+ * @brief Resize a set so it has `nelem` buckets.
+ * @sa vsc_hashmap_resize()
+ */
+int vsc_hashset_resize(VscHashSet *set, size_t nelem);
+
+vsc_hash_t vsc_hashset_hash(const VscHashSet *set, const void *key);
+
+/**
+ * @brief Add a key to the set. If an equal key is already present, it is replaced.
+ *
+ * @param set The hash set instance. Must not be NULL.
+ * @param key The key.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ */
+int vsc_hashset_insert(VscHashSet *set, const void *key);
+int vsc_hashset_insert_with_hash(VscHashSet *set, const void *key, vsc_hash_t hash);
+
+/**
+ * @brief Check if a key is in the set.
+ *
+ * @param set The hash set instance. Must not be NULL.
+ * @param key The key.
+ *
+ * @return If the key is present, returns 1. Otherwise, returns 0.
+ */
+int vsc_hashset_contains(const VscHashSet *set, const void *key);
+int vsc_hashset_contains_with_hash(const VscHashSet *set, const void *key, vsc_hash_t hash);
+
+/**
+ * @brief Remove a key from the set.
+ *
+ * @param set The hash set instance. Must not be NULL.
+ * @param key The key.
+ *
+ * @return If the key was removed, returns 0. If it wasn't present, returns 1.
+ */
+int vsc_hashset_remove(VscHashSet *set, const void *key);
+int vsc_hashset_remove_with_hash(VscHashSet *set, const void *key, vsc_hash_t hash);
+
+size_t vsc_hashset_size(const VscHashSet *set);
+size_t vsc_hashset_capacity(const VscHashSet *set);
+
+/**
+ * @brief Invoke a procedure for each key in the set.
+ *
+ * The set must not be modified during enumeration.
+ *
+ * @param set  The hash set instance. Must not be NULL.
+ * @param proc The procedure to invoke. If it returns nonzero, enumeration
+ *             stops and that value is returned.
+ * @param user A user-provided pointer passed to `proc`.
+ *
+ * @return If enumeration completes, returns 0. Otherwise, returns the value
+ *         returned by `proc`.
+ */
+int vsc_hashset_enumerate(const VscHashSet *set, VscHashSetEnumProc proc, void *user);
+
+/**
+ * @brief Add every key in `other` to `set`.
+ *
+ * The set is grown at most once, up front, and the hashes stored in `other`
+ * are reused, so no keys are rehashed.
+ *
+ * @param set   The hash set instance. Must not be NULL.
+ * @param other The set to merge. Must not be NULL. Must use the same hash procedure as `set`.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the hash procedures differ, `VSC_ERROR(EINVAL)` is returned.
+ */
+int vsc_hashset_union(VscHashSet *set, const VscHashSet *other);
+
+/**
+ * @brief Remove every key from `set` that isn't in `other`.
+ *
+ * The surviving keys are moved into a new bucket block in a single pass, which
+ * is then shrunk if required by the load factor policy. On failure, `set` is
+ * left untouched.
+ *
+ * @param set   The hash set instance. Must not be NULL.
+ * @param other The set to intersect with. Must not be NULL. Must use the same hash procedure as `set`.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the hash procedures differ, `VSC_ERROR(EINVAL)` is returned.
+ */
+int vsc_hashset_intersect(VscHashSet *set, const VscHashSet *other);
+
+/**
+ * @brief Remove every key from `set` that is in `other`.
+ *
+ * This behaves the same way as vsc_hashset_intersect().
+ *
+ * @param set   The hash set instance. Must not be NULL.
+ * @param other The set of keys to remove. Must not be NULL. Must use the same hash procedure as `set`.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the hash procedures differ, `VSC_ERROR(EINVAL)` is returned.
+ */
+int vsc_hashset_difference(VscHashSet *set, const VscHashSet *other);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_HASHSET_H */
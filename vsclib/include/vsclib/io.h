@@ -62,7 +62,8 @@ int vsc_freadall_ex(void **ptr, size_t *size, FILE *f, VscFreadallInitProc init_
  * \param init_proc  A initialisation callback that may used to inspect and modify stream parameters
  *                   before reading commences. Only the `file_size` and `blk_size` fields of #VscFreadallState
  *                   may be modified.
- * \param chunk_proc A callback used to report progress. This is invoked after each internal read.
+ * \param chunk_proc A callback used to report progress. This is invoked after each internal read,
+ *                   which is available in the `chunk` and `chunk_size` fields of #VscFreadallState.
  * \param user       A user-provided pointer to be passed to \p init_proc and \p chunk_proc
  * \param a          The allocator to use.
  *
@@ -56,6 +56,15 @@ typedef struct VscFreadallState {
      */
     size_t bytes_read;
 
+    /**
+     * @brief The data read by the most recent internal read.
+     *
+     * Only valid for the duration of the chunk callback, the buffer may move afterwards.
+     * This is NULL during the init callback.
+     */
+    const void *chunk;
+    size_t      chunk_size;
+
     /**
      * @brief A `struct stat` of the file.
      */
@@ -0,0 +1,118 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_LRU_CACHE_H
+#define _VSCLIB_LRU_CACHE_H
+
+#include <stddef.h>
+#include "lru_cachedef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a bounded, least-recently-used cache.
+ *
+ * All memory is allocated up front. The recency list lives in a single array of
+ * `max_entries` nodes linked by index, and the key index is a #VscHashMap sized so
+ * it never resizes. Every operation is O(1) and, after this, allocation-free.
+ *
+ * The hash and compare procedures are the same as for #VscHashMap.
+ *
+ * @param hash        The hash procedure. May not be NULL.
+ * @param compare     The key comparison procedure. May not be NULL.
+ * @param max_entries The maximum number of entries. Must be nonzero and less than `UINT32_MAX`.
+ * @param max_cost    The maximum total cost of all entries. If 0, only the entry count is limited.
+ * @param evict       The eviction procedure. May be NULL.
+ * @param user        A user-provided pointer passed to `evict`.
+ * @param a           The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new cache. On failure, returns NULL.
+ */
+VscLruCache *vsc_lru_cache_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t max_entries,
+                                  size_t max_cost, VscLruCacheEvictProc evict, void *user, const VscAllocator *a);
+VscLruCache *vsc_lru_cache_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t max_entries,
+                                 size_t max_cost, VscLruCacheEvictProc evict, void *user);
+
+/**
+ * @brief Free a cache. The eviction procedure is invoked for each remaining entry.
+ */
+void vsc_lru_cache_free(VscLruCache *cache);
+
+/**
+ * @brief Look up a key, marking it as the most recently used.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ *
+ * @return If the key is present, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_lru_cache_get(VscLruCache *cache, const void *key);
+
+/**
+ * @brief Insert or replace an entry, making it the most recently used.
+ *
+ * The least recently used entries are evicted until the new one fits. If the key
+ * is already present, the eviction procedure is invoked on the replaced entry,
+ * unless both the key and value pointers are the ones being inserted. A replaced
+ * pointer the cache still holds, i.e. equal to `key` or `value`, is passed as NULL.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ * @param value The value.
+ * @param cost  The cost of the entry. Ignored if the cache has no maximum cost.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If `cost` exceeds the maximum cost, `VSC_ERROR(ERANGE)` is returned and
+ *         the cache is left untouched.
+ */
+int vsc_lru_cache_put(VscLruCache *cache, const void *key, void *value, size_t cost);
+
+/**
+ * @brief Remove an entry. The eviction procedure is not invoked.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param key   The key.
+ *
+ * @return If the key was present, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_lru_cache_remove(VscLruCache *cache, const void *key);
+
+/**
+ * @brief Remove every entry. The eviction procedure is invoked for each of them.
+ */
+void vsc_lru_cache_clear(VscLruCache *cache);
+
+size_t vsc_lru_cache_size(const VscLruCache *cache);
+size_t vsc_lru_cache_cost(const VscLruCache *cache);
+
+/**
+ * @brief Get the lifetime hit, miss and eviction counters of a cache.
+ *
+ * @param cache The cache instance. Must not be NULL.
+ * @param stats A pointer to receive the counters. Must not be NULL.
+ */
+void vsc_lru_cache_stats(const VscLruCache *cache, VscLruCacheStats *stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_LRU_CACHE_H */
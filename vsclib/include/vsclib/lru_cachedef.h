@@ -0,0 +1,44 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_LRU_CACHEDEF_H
+#define _VSCLIB_LRU_CACHEDEF_H
+
+#include "hashmapdef.h"
+
+typedef struct VscLruCache VscLruCache;
+
+/**
+ * @brief Called whenever a #VscLruCache drops an entry the caller hasn't taken back.
+ */
+typedef void (*VscLruCacheEvictProc)(const void *key, void *value, void *user);
+
+/**
+ * @brief Lifetime counters of a #VscLruCache, as reported by vsc_lru_cache_stats().
+ */
+typedef struct VscLruCacheStats {
+    size_t hits;
+    size_t misses;
+    /**
+     * @brief The number of entries dropped to make room for another.
+     */
+    size_t evictions;
+} VscLruCacheStats;
+
+#endif /* _VSCLIB_LRU_CACHEDEF_H */
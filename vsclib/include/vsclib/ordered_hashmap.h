@@ -0,0 +1,152 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_ORDERED_HASHMAP_H
+#define _VSCLIB_ORDERED_HASHMAP_H
+
+#include <stddef.h>
+#include "ordered_hashmapdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate an insertion-ordered hash map.
+ *
+ * Elements are kept in a dense array in the order they were inserted, and found
+ * through a separate index table of small integers, sized 1, 2, 4 or 8 bytes per
+ * slot depending on the capacity. Iteration only touches the live elements, and
+ * the index table is far smaller than a bucket array.
+ *
+ * Removed elements leave a hole in the array, which is compacted the next
+ * time it fills up.
+ *
+ * The hash and compare procedures are the same as for #VscHashMap.
+ *
+ * @param hash    The hash procedure. May not be NULL.
+ * @param compare The key comparison procedure. May not be NULL.
+ * @param a       The allocator to use. May not be NULL.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ */
+VscOrderedHashMap *vsc_ordered_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                              const VscAllocator *a);
+VscOrderedHashMap *vsc_ordered_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare);
+void               vsc_ordered_hashmap_free(VscOrderedHashMap *om);
+
+/**
+ * @brief Remove every element, keeping the storage.
+ */
+void vsc_ordered_hashmap_clear(VscOrderedHashMap *om);
+
+/**
+ * @brief Remove every element, releasing all memory.
+ */
+void vsc_ordered_hashmap_reset(VscOrderedHashMap *om);
+
+/**
+ * @brief Make sure there's enough room for `nelem` elements without reallocating.
+ *
+ * @param om    The ordered hash map instance. Must not be NULL.
+ * @param nelem The number of elements.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ */
+int vsc_ordered_hashmap_reserve(VscOrderedHashMap *om, size_t nelem);
+
+/**
+ * @brief Insert a key/value pair.
+ *
+ * If an equal key is already present, its key and value are replaced, but it
+ * keeps its position.
+ *
+ * @param om    The ordered hash map instance. Must not be NULL.
+ * @param key   The key.
+ * @param value The value.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the key hashes to #VSC_INVALID_HASH, returns `VSC_ERROR(ERANGE)`.
+ */
+int vsc_ordered_hashmap_insert(VscOrderedHashMap *om, const void *key, void *value);
+
+/**
+ * @brief Find the value of a key.
+ *
+ * @param om  The ordered hash map instance. Must not be NULL.
+ * @param key The key.
+ *
+ * @return If the key exists, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_ordered_hashmap_find(const VscOrderedHashMap *om, const void *key);
+
+/**
+ * @brief Remove a key.
+ *
+ * The order of the remaining elements is unchanged.
+ *
+ * @param om  The ordered hash map instance. Must not be NULL.
+ * @param key The key.
+ *
+ * @return If the key exists, returns its value. Otherwise, returns NULL.
+ */
+void *vsc_ordered_hashmap_remove(VscOrderedHashMap *om, const void *key);
+
+size_t vsc_ordered_hashmap_size(const VscOrderedHashMap *om);
+
+/**
+ * @brief Get the number of elements that can be stored without reallocating.
+ */
+size_t vsc_ordered_hashmap_capacity(const VscOrderedHashMap *om);
+
+/**
+ * @brief Get the element array, in insertion order.
+ *
+ * Removed elements are still in the array until it's compacted, and have a hash
+ * of #VSC_INVALID_HASH. These must be skipped.
+ *
+ * @param om    The ordered hash map instance. Must not be NULL.
+ * @param count Receives the number of entries in the array, including removed ones.
+ *              Must not be NULL.
+ *
+ * @return A pointer to the first element, or NULL if the array is empty.
+ *         This is invalidated by any modification of the map.
+ */
+const VscHashMapBucket *vsc_ordered_hashmap_entries(const VscOrderedHashMap *om, size_t *count);
+
+/**
+ * @brief Invoke a procedure for each element, in insertion order.
+ *
+ * The map must not be modified during enumeration.
+ *
+ * @param om   The ordered hash map instance. Must not be NULL.
+ * @param proc The procedure to invoke. If it returns nonzero, enumeration
+ *             stops and that value is returned.
+ * @param user A user-provided pointer passed to `proc`.
+ *
+ * @return If enumeration completes, returns 0. Otherwise, returns the value
+ *         returned by `proc`.
+ */
+int vsc_ordered_hashmap_enumerate(const VscOrderedHashMap *om, VscHashMapEnumProc proc, void *user);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_ORDERED_HASHMAP_H */
@@ -0,0 +1,110 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_PERFECT_HASH_H
+#define _VSCLIB_PERFECT_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "memdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Build a minimal perfect hash function over a static set of keys.
+ *
+ * The keys are mapped, without collisions, onto [0, nkeys). The resulting table is
+ * a flat array of `uint32_t`s in native byte order, and needs no further processing
+ * to be used. It may be saved as-is, or emitted as C source with vsc_perfect_hash_write_c().
+ *
+ * Keys are split into buckets of about four keys each, and a seed is searched for
+ * each bucket that places all of its keys into free slots (CHD, "compress, hash, and displace").
+ * The keys are placed at a load factor of about 0.99, and the table costs about 1.04 bytes per key.
+ *
+ * Building is roughly linear in the number of keys, at under a second per million keys
+ * in an optimised build. Sets of tens of millions of keys are practical; beyond that,
+ * the per-key scratch memory (about 20 bytes per key) is likely to be the limit.
+ *
+ * @param table     A pointer to receive the table. Free it with vsc_xfree().
+ * @param table_len A pointer to receive the number of elements in the table. May be NULL.
+ * @param keys      The keys. May only be NULL if \p nkeys is 0.
+ * @param key_sizes The sizes of each key, in bytes. May only be NULL if \p nkeys is 0.
+ * @param nkeys     The number of keys. Must be less than `UINT32_MAX`.
+ * @param a         The allocator to use. Must not be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the keys contain duplicates, `VSC_ERROR(EEXIST)` is returned.
+ *         If no placement could be found, `VSC_ERROR(ENOSPC)` is returned. This is not
+ *         expected to happen for distinct keys, short of pathological hash collisions.
+ */
+int vsc_perfect_hash_builda(uint32_t **table, size_t *table_len, const void *const *keys, const size_t *key_sizes,
+                            size_t nkeys, const VscAllocator *a);
+int vsc_perfect_hash_build(uint32_t **table, size_t *table_len, const void *const *keys, const size_t *key_sizes,
+                           size_t nkeys);
+
+/**
+ * @brief Validate a table, i.e. one that was loaded from disk.
+ *
+ * @return If \p table is a valid table of \p table_len elements, returns 0.
+ *         Otherwise, returns `VSC_ERROR(EINVAL)`.
+ */
+int vsc_perfect_hash_validate(const uint32_t *table, size_t table_len);
+
+/**
+ * @brief Get the number of keys in a table.
+ */
+size_t vsc_perfect_hash_count(const uint32_t *table);
+
+/**
+ * @brief Get the number of elements in a table.
+ */
+size_t vsc_perfect_hash_table_len(const uint32_t *table);
+
+/**
+ * @brief Look up the index of a key.
+ *
+ * @param table    The table. Must not be NULL.
+ * @param key      The key.
+ * @param key_size The size of \p key, in bytes.
+ *
+ * @return The index of \p key, in [0, count). If \p key wasn't in the original set,
+ *         an arbitrary index is returned, so the caller must verify the key itself.
+ *         If the table is empty, returns 0.
+ */
+size_t vsc_perfect_hash_lookup(const uint32_t *table, const void *key, size_t key_size);
+
+/**
+ * @brief Write a table as a C array definition, for embedding.
+ *
+ * @param table The table. Must not be NULL.
+ * @param f     The stream to write to. Must not be NULL.
+ * @param name  The name of the array. Must not be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ */
+int vsc_perfect_hash_write_c(const uint32_t *table, FILE *f, const char *name);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_PERFECT_HASH_H */
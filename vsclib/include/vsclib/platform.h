@@ -66,4 +66,16 @@
 #error Cannot determine how to get type alignment, please fix your system
 #endif
 
+#if defined(__cplusplus)
+#define VSC_ALIGNAS(a) alignas(a)
+#elif __STDC_VERSION__ >= 201112L
+#define VSC_ALIGNAS(a) _Alignas(a)
+#elif defined(_MSC_VER)
+#define VSC_ALIGNAS(a) __declspec(align(a))
+#elif defined(__GNUC__)
+#define VSC_ALIGNAS(a) __attribute__((aligned(a)))
+#else
+#error Cannot determine how to set type alignment, please fix your system
+#endif
+
 #endif /* _VSCLIB_PLATFORM_H */
@@ -0,0 +1,133 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_RCU_HASHMAP_H
+#define _VSCLIB_RCU_HASHMAP_H
+
+#include <stddef.h>
+#include "rcu_hashmapdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a read-mostly hash map.
+ *
+ * Readers never take a lock, and never write to memory shared with other readers.
+ * Each write builds a new, immutable snapshot of the table and publishes it
+ * atomically, so readers always see a consistent map. Old snapshots are freed
+ * once no reader can still be using them (epoch-based reclamation).
+ *
+ * Writes are O(n) and serialised, so this is only suitable for maps that are
+ * read far more often than they are written.
+ *
+ * @param hash    The hash procedure. May not be NULL.
+ * @param compare The key comparison procedure. May not be NULL.
+ * @param a       The allocator to use. May not be NULL. Must be thread-safe.
+ *
+ * @return On success, returns the new map. On failure, returns NULL.
+ */
+VscRcuHashMap *vsc_rcu_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a);
+VscRcuHashMap *vsc_rcu_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare);
+
+/**
+ * @brief Free a read-mostly hash map.
+ *
+ * @remark There must be no concurrent readers or writers.
+ *         Any registered readers are invalidated.
+ */
+void vsc_rcu_hashmap_free(VscRcuHashMap *map);
+
+/**
+ * @brief Register a reader.
+ *
+ * Each reading thread needs its own reader. A reader may only be used by
+ * one thread at a time.
+ *
+ * @param map The map instance. Must not be NULL.
+ *
+ * @return On success, returns the new reader. On failure, returns NULL.
+ */
+VscRcuHashMapReader *vsc_rcu_hashmap_register_reader(VscRcuHashMap *map);
+
+/**
+ * @brief Unregister a reader. The reader may not be used afterwards.
+ *
+ * @param reader The reader to unregister. If NULL, this is a no-op.
+ */
+void vsc_rcu_hashmap_unregister_reader(VscRcuHashMapReader *reader);
+
+/**
+ * @brief Find the value of a key.
+ *
+ * This takes no locks, and is safe to call concurrently with writers.
+ *
+ * @param reader The reader. Must not be NULL.
+ * @param key    The key to search for.
+ *
+ * @return If found, returns the value associated with \p key. Otherwise, returns NULL.
+ */
+void *vsc_rcu_hashmap_find(VscRcuHashMapReader *reader, const void *key);
+
+/**
+ * @brief Insert or replace a key.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         On failure, the map is left untouched.
+ */
+int vsc_rcu_hashmap_insert(VscRcuHashMap *map, const void *key, void *value);
+
+/**
+ * @brief Update the value of an existing key.
+ *
+ * @return If the key was updated, returns 0. If the key wasn't found, returns 1.
+ *         On failure, returns a negative error value.
+ */
+int vsc_rcu_hashmap_update(VscRcuHashMap *map, const void *key, void *value);
+
+/**
+ * @brief Remove a key.
+ *
+ * @param map   The map instance. Must not be NULL.
+ * @param key   The key to remove.
+ * @param value A pointer to receive the removed value. May be NULL.
+ *
+ * @return If the key was removed, returns 0. If the key wasn't found, returns 1.
+ *         On failure, returns a negative error value, and nothing is removed.
+ */
+int vsc_rcu_hashmap_remove(VscRcuHashMap *map, const void *key, void **value);
+
+void vsc_rcu_hashmap_clear(VscRcuHashMap *map);
+
+size_t vsc_rcu_hashmap_size(VscRcuHashMap *map);
+
+/**
+ * @brief Free any retired snapshots that are no longer in use.
+ *
+ * This is done automatically on each write, but may be called to reclaim
+ * memory sooner if writes are infrequent.
+ */
+void vsc_rcu_hashmap_reclaim(VscRcuHashMap *map);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_RCU_HASHMAP_H */
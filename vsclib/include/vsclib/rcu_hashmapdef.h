@@ -0,0 +1,28 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_RCU_HASHMAPDEF_H
+#define _VSCLIB_RCU_HASHMAPDEF_H
+
+#include "hashmapdef.h"
+
+typedef struct VscRcuHashMap       VscRcuHashMap;
+typedef struct VscRcuHashMapReader VscRcuHashMapReader;
+
+#endif /* _VSCLIB_RCU_HASHMAPDEF_H */
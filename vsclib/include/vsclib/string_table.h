@@ -0,0 +1,141 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_STRING_TABLE_H
+#define _VSCLIB_STRING_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "memdef.h"
+#include "stringdef.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Allocate a string table.
+ *
+ * A string table interns strings: each distinct string is copied once into an
+ * arena and given a pointer and a 32-bit atom, both of which are stable for the
+ * life of the table. Interned strings can be compared by pointer, so they can be
+ * used as keys with vsc_hashmap_default_hash() and vsc_hashmap_default_compare().
+ *
+ * Strings may contain embedded NULs, and are always NUL-terminated.
+ *
+ * @param flags A combination of #VscStringTableFlags.
+ * @param a     The allocator to use. May not be NULL. If the table is concurrent,
+ *              this must be thread-safe.
+ *
+ * @return On success, returns the new table. On failure, returns NULL.
+ */
+VscStringTable *vsc_string_table_alloca(uint32_t flags, const VscAllocator *a);
+VscStringTable *vsc_string_table_alloc(uint32_t flags);
+
+/**
+ * @brief Free a string table. All interned strings are invalidated.
+ */
+void vsc_string_table_free(VscStringTable *st);
+
+/**
+ * @brief Intern a string.
+ *
+ * @param st   The string table instance. Must not be NULL.
+ * @param s    The string. May only be NULL if `len` is 0.
+ * @param len  The length of the string, in bytes.
+ * @param str  A pointer to receive the interned string. May be NULL.
+ * @param atom A pointer to receive the string's atom. May be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         If the string is longer than `UINT32_MAX - 1` bytes, `VSC_ERROR(ERANGE)` is returned.
+ */
+int vsc_string_table_intern(VscStringTable *st, const char *s, size_t len, const char **str, uint32_t *atom);
+
+/**
+ * @brief Same as vsc_string_table_intern(), but with a NUL-terminated string.
+ */
+int vsc_string_table_intern_cstr(VscStringTable *st, const char *s, const char **str, uint32_t *atom);
+
+/**
+ * @brief Intern many strings at once.
+ *
+ * Lookups are done in batches so their cache misses overlap, and the index and
+ * arena are grown at most once per batch. In concurrent mode, the lock is only
+ * taken once.
+ *
+ * @param st    The string table instance. Must not be NULL.
+ * @param s     An array of `n` strings.
+ * @param lens  An array of `n` lengths. If NULL, the strings are NUL-terminated.
+ * @param n     The number of strings.
+ * @param strs  An array of `n` pointers to receive the interned strings. May be NULL.
+ * @param atoms An array of `n` atoms to receive the string's atoms. May be NULL.
+ *
+ * @return On success, returns 0. On failure, returns a negative error value.
+ *         On failure, some of the strings may have been interned.
+ */
+int vsc_string_table_intern_bulk(VscStringTable *st, const char *const *s, const size_t *lens, size_t n,
+                                 const char **strs, uint32_t *atoms);
+
+/**
+ * @brief Look up a string without interning it.
+ *
+ * @param st   The string table instance. Must not be NULL.
+ * @param s    The string. May only be NULL if `len` is 0.
+ * @param len  The length of the string, in bytes.
+ * @param atom A pointer to receive the string's atom. May be NULL.
+ *
+ * @return If the string is interned, returns the interned string. Otherwise, returns NULL.
+ */
+const char *vsc_string_table_find(VscStringTable *st, const char *s, size_t len, uint32_t *atom);
+
+/**
+ * @brief Get the interned string for an atom.
+ *
+ * @param st   The string table instance. Must not be NULL.
+ * @param atom The atom.
+ * @param len  A pointer to receive the length of the string. May be NULL.
+ *
+ * @return If the atom is valid, returns its string. Otherwise, returns NULL.
+ */
+const char *vsc_string_table_string(VscStringTable *st, uint32_t atom, size_t *len);
+
+/**
+ * @brief Get the atom of an interned string. This doesn't need the table.
+ *
+ * @param str A string returned by a #VscStringTable. Must not be NULL.
+ */
+uint32_t vsc_string_table_atom(const char *str);
+
+/**
+ * @brief Get the length of an interned string. This doesn't need the table.
+ *
+ * @param str A string returned by a #VscStringTable. Must not be NULL.
+ */
+size_t vsc_string_table_length(const char *str);
+
+/**
+ * @brief Get the number of strings in the table.
+ */
+size_t vsc_string_table_size(VscStringTable *st);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _VSCLIB_STRING_TABLE_H */
@@ -20,6 +20,22 @@
 #ifndef _VSCLIB_STRINGDEF_H
 #define _VSCLIB_STRINGDEF_H
 
+#include <stdint.h>
+
 typedef int (*VscForEachDelimProc)(const char *s, const char *e, void *user);
 
+typedef struct VscStringTable VscStringTable;
+
+typedef enum VscStringTableFlags {
+    /**
+     * @brief Make the table safe to use from multiple threads.
+     */
+    VSC_STRING_TABLE_CONCURRENT = 1 << 0,
+} VscStringTableFlags;
+
+/**
+ * @brief An atom that's never returned by a #VscStringTable.
+ */
+#define VSC_STRING_TABLE_INVALID_ATOM UINT32_MAX
+
 #endif /* _VSCLIB_STRINGDEF_H */
@@ -0,0 +1,86 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Based on "mutex3" from Ulrich Drepper's "Futexes Are Tricky".
+ * https://www.akkadia.org/drepper/futex.pdf
+ */
+#include "lock_internal.h"
+
+#if VSC_HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <sched.h>
+#endif
+
+/*
+ * How many times to spin before going to sleep.
+ * Critical sections in vsclib are short, so this should usually be enough.
+ */
+#define VSC_LOCK_SPIN_COUNT 100
+
+static void lock_wait(VscLock *lock, uint32_t val)
+{
+#if VSC_HAVE_LINUX_FUTEX_H
+    (void)syscall(SYS_futex, &lock->state, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#elif defined(_WIN32)
+    (void)lock;
+    (void)val;
+    (void)SwitchToThread();
+#else
+    (void)lock;
+    (void)val;
+    (void)sched_yield();
+#endif
+}
+
+static void lock_wake(VscLock *lock)
+{
+#if VSC_HAVE_LINUX_FUTEX_H
+    (void)syscall(SYS_futex, &lock->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    /* Waiters are yielding, they'll notice on their own. */
+    (void)lock;
+#endif
+}
+
+void vsci_lock_acquire_slow(VscLock *lock)
+{
+    for(int i = 0; i < VSC_LOCK_SPIN_COUNT; ++i) {
+        if(vsci_atomic_load_u32(&lock->state) == 0 && vsci_lock_try_acquire(lock))
+            return;
+
+        vsci_cpu_relax();
+    }
+
+    /*
+     * Mark the lock as contended. If it was unlocked in the meantime,
+     * we've acquired it (albeit marked as contended, which is harmless).
+     */
+    while(vsci_atomic_xchg_u32(&lock->state, 2) != 0)
+        lock_wait(lock, 2);
+}
+
+void vsci_lock_release_slow(VscLock *lock)
+{
+    lock_wake(lock);
+}
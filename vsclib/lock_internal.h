@@ -0,0 +1,66 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_LOCK_INTERNAL_H
+#define _VSCLIB_LOCK_INTERNAL_H
+
+#include "atomic_internal.h"
+
+/*
+ * A small, non-recursive mutex.
+ *
+ * Spins briefly, then sleeps on a futex (Linux), or yields (everywhere else).
+ * State values:
+ * - 0: unlocked
+ * - 1: locked, no waiters
+ * - 2: locked, possibly with waiters
+ */
+typedef struct VscLock {
+    volatile uint32_t state;
+} VscLock;
+
+#define VSC_LOCK_INIT {0}
+
+void vsci_lock_acquire_slow(VscLock *lock);
+void vsci_lock_release_slow(VscLock *lock);
+
+static inline int vsci_lock_try_acquire(VscLock *lock)
+{
+    uint32_t expected = 0;
+    return vsci_atomic_cas_u32(&lock->state, &expected, 1);
+}
+
+static inline void vsci_lock_acquire(VscLock *lock)
+{
+    if(vsci_lock_try_acquire(lock))
+        return;
+
+    vsci_lock_acquire_slow(lock);
+}
+
+static inline void vsci_lock_release(VscLock *lock)
+{
+    /* Fast path, nobody's waiting. */
+    if(vsci_atomic_xchg_u32(&lock->state, 0) == 1)
+        return;
+
+    vsci_lock_release_slow(lock);
+}
+
+#endif /* _VSCLIB_LOCK_INTERNAL_H */
@@ -0,0 +1,357 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/hashmap.h>
+#include <vsclib/lru_cache.h>
+#include "hashmap_internal.h"
+
+#define VSC_LRU_CACHE_NIL UINT32_MAX
+
+/*
+ * Nodes are linked by index, most recently used at the head.
+ * Unused nodes are chained through `next` on the free list.
+ */
+typedef struct VscLruCacheNode {
+    vsc_hash_t  hash;
+    const void *key;
+    void       *value;
+    size_t      cost;
+    uint32_t    prev;
+    uint32_t    next;
+} VscLruCacheNode;
+
+struct VscLruCache {
+    /* Maps keys to node index + 1, so that node 0 isn't NULL. */
+    VscHashMap map;
+
+    VscLruCacheNode *nodes;
+    uint32_t         max_entries;
+    uint32_t         size;
+    uint32_t         head;
+    uint32_t         tail;
+    uint32_t         free_list;
+
+    size_t max_cost;
+    size_t cost;
+
+    VscLruCacheEvictProc evict_proc;
+    void                *user;
+    VscLruCacheStats     stats;
+};
+
+/* This should be optimised out in Release builds. */
+static inline void validate(const VscLruCache *cache)
+{
+    vsc_assert(cache != NULL);
+    vsc_assert(cache->nodes != NULL);
+    vsc_assert(cache->size <= cache->max_entries);
+    vsc_assert(cache->max_cost == 0 || cache->cost <= cache->max_cost);
+    (void)cache;
+}
+
+static inline void *index_to_value(uint32_t index)
+{
+    return (void *)((uintptr_t)index + 1);
+}
+
+static inline uint32_t value_to_index(const void *value)
+{
+    return (uint32_t)((uintptr_t)value - 1);
+}
+
+static void unlink_node(VscLruCache *cache, uint32_t index)
+{
+    VscLruCacheNode *node = cache->nodes + index;
+
+    if(node->prev != VSC_LRU_CACHE_NIL)
+        cache->nodes[node->prev].next = node->next;
+    else
+        cache->head = node->next;
+
+    if(node->next != VSC_LRU_CACHE_NIL)
+        cache->nodes[node->next].prev = node->prev;
+    else
+        cache->tail = node->prev;
+
+    node->prev = VSC_LRU_CACHE_NIL;
+    node->next = VSC_LRU_CACHE_NIL;
+}
+
+static void push_front(VscLruCache *cache, uint32_t index)
+{
+    VscLruCacheNode *node = cache->nodes + index;
+
+    node->prev = VSC_LRU_CACHE_NIL;
+    node->next = cache->head;
+
+    if(cache->head != VSC_LRU_CACHE_NIL)
+        cache->nodes[cache->head].prev = index;
+    else
+        cache->tail = index;
+
+    cache->head = index;
+}
+
+/*
+ * Unlink a node and return it to the free list. Its contents are left intact.
+ */
+static void release_node(VscLruCache *cache, uint32_t index)
+{
+    VscLruCacheNode *node = cache->nodes + index;
+
+    (void)vsc_hashmap_remove_with_hash(&cache->map, node->key, node->hash);
+    unlink_node(cache, index);
+
+    cache->cost -= node->cost;
+    --cache->size;
+
+    node->next       = cache->free_list;
+    cache->free_list = index;
+}
+
+static void evict_tail(VscLruCache *cache)
+{
+    uint32_t         index = cache->tail;
+    VscLruCacheNode *node  = cache->nodes + index;
+
+    vsc_assert(index != VSC_LRU_CACHE_NIL);
+
+    release_node(cache, index);
+    ++cache->stats.evictions;
+
+    if(cache->evict_proc != NULL)
+        cache->evict_proc(node->key, node->value, cache->user);
+}
+
+static int find_node(const VscLruCache *cache, const void *key, vsc_hash_t hash, uint32_t *index)
+{
+    void *v = vsc_hashmap_find_with_hash(&cache->map, key, hash);
+
+    if(v == NULL)
+        return 0;
+
+    *index = value_to_index(v);
+    return 1;
+}
+
+VscLruCache *vsc_lru_cache_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t max_entries,
+                                  size_t max_cost, VscLruCacheEvictProc evict, void *user, const VscAllocator *a)
+{
+    VscLruCache *cache;
+    void        *ptrs[2];
+
+    vsc_assert(a != NULL);
+
+    if(max_entries == 0 || max_entries >= VSC_LRU_CACHE_NIL)
+        return NULL;
+
+    VscBlockAllocInfo bai[2] = {
+        {1,           sizeof(VscLruCache),     VSC_ALIGNOF(VscLruCache),     NULL},
+        {max_entries, sizeof(VscLruCacheNode), VSC_ALIGNOF(VscLruCacheNode), NULL},
+    };
+
+    if(vsc_block_xalloc(a, ptrs, bai, 2, 0) < 0)
+        return NULL;
+
+    cache = ptrs[0];
+    *cache = (VscLruCache){
+        .nodes       = ptrs[1],
+        .max_entries = (uint32_t)max_entries,
+        .size        = 0,
+        .head        = VSC_LRU_CACHE_NIL,
+        .tail        = VSC_LRU_CACHE_NIL,
+        .free_list   = 0,
+        .max_cost    = max_cost,
+        .cost        = 0,
+        .evict_proc  = evict,
+        .user        = user,
+        .stats       = {0, 0, 0},
+    };
+
+    for(uint32_t i = 0; i < cache->max_entries; ++i) {
+        cache->nodes[i] = (VscLruCacheNode){
+            .hash  = VSC_INVALID_HASH,
+            .key   = NULL,
+            .value = NULL,
+            .cost  = 0,
+            .prev  = VSC_LRU_CACHE_NIL,
+            .next  = i + 1 < cache->max_entries ? i + 1 : VSC_LRU_CACHE_NIL,
+        };
+    }
+
+    /*
+     * Size the index for the default minimum load factor when full, then pin it.
+     * It never needs to grow, and shrinking would just mean growing again.
+     */
+    vsci_hashmap_init(&cache->map, hash, compare, VSC_HASHMAP_LAYOUT_BUCKETS, a);
+    if(vsc_hashmap_resize(&cache->map, max_entries * 2) < 0) {
+        vsc_xfree(a, cache);
+        return NULL;
+    }
+    (void)vsc_hashmap_set_resize_policy(&cache->map, VSC_HASHMAP_RESIZE_NONE);
+
+    return cache;
+}
+
+VscLruCache *vsc_lru_cache_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare, size_t max_entries,
+                                 size_t max_cost, VscLruCacheEvictProc evict, void *user)
+{
+    return vsc_lru_cache_alloca(hash, compare, max_entries, max_cost, evict, user, vsclib_system_allocator);
+}
+
+void vsc_lru_cache_free(VscLruCache *cache)
+{
+    const VscAllocator *a;
+
+    validate(cache);
+
+    vsc_lru_cache_clear(cache);
+
+    a = cache->map.allocator;
+    vsc_hashmap_reset(&cache->map);
+    vsc_xfree(a, cache);
+}
+
+void *vsc_lru_cache_get(VscLruCache *cache, const void *key)
+{
+    uint32_t index;
+
+    validate(cache);
+
+    if(!find_node(cache, key, vsc_hashmap_hash(&cache->map, key), &index)) {
+        ++cache->stats.misses;
+        return NULL;
+    }
+
+    ++cache->stats.hits;
+
+    if(cache->head != index) {
+        unlink_node(cache, index);
+        push_front(cache, index);
+    }
+
+    return cache->nodes[index].value;
+}
+
+int vsc_lru_cache_put(VscLruCache *cache, const void *key, void *value, size_t cost)
+{
+    VscLruCacheNode *node, old = {0};
+    vsc_hash_t       hash;
+    uint32_t         index;
+    int              replaced, r;
+
+    validate(cache);
+
+    if(cache->max_cost == 0)
+        cost = 0;
+    else if(cost > cache->max_cost)
+        return VSC_ERROR(ERANGE);
+
+    hash = vsc_hashmap_hash(&cache->map, key);
+
+    /* Take the existing node off the list, so it can't be evicted below. */
+    if((replaced = find_node(cache, key, hash, &index))) {
+        old = cache->nodes[index];
+        unlink_node(cache, index);
+        cache->cost -= old.cost;
+    }
+
+    while(cache->max_cost != 0 && cache->cost + cost > cache->max_cost)
+        evict_tail(cache);
+
+    if(!replaced) {
+        if(cache->size == cache->max_entries)
+            evict_tail(cache);
+
+        index            = cache->free_list;
+        cache->free_list = cache->nodes[index].next;
+        ++cache->size;
+    }
+
+    node        = cache->nodes + index;
+    node->hash  = hash;
+    node->key   = key;
+    node->value = value;
+    node->cost  = cost;
+    push_front(cache, index);
+    cache->cost += cost;
+
+    /* The index is pinned at its full size, so this can't fail. */
+    r = vsc_hashmap_insert_with_hash(&cache->map, key, hash, index_to_value(index));
+    vsc_assert(r == 0);
+    (void)r;
+
+    /* Only hand back what the cache let go of, it may still hold the key or the value. */
+    if(replaced && cache->evict_proc != NULL && !(old.key == key && old.value == value))
+        cache->evict_proc(old.key != key ? old.key : NULL, old.value != value ? old.value : NULL, cache->user);
+
+    return 0;
+}
+
+void *vsc_lru_cache_remove(VscLruCache *cache, const void *key)
+{
+    uint32_t index;
+
+    validate(cache);
+
+    if(!find_node(cache, key, vsc_hashmap_hash(&cache->map, key), &index))
+        return NULL;
+
+    release_node(cache, index);
+    return cache->nodes[index].value;
+}
+
+void vsc_lru_cache_clear(VscLruCache *cache)
+{
+    validate(cache);
+
+    /* Oldest first, same as if they'd been evicted. */
+    while(cache->tail != VSC_LRU_CACHE_NIL) {
+        uint32_t         index = cache->tail;
+        VscLruCacheNode *node  = cache->nodes + index;
+
+        release_node(cache, index);
+
+        if(cache->evict_proc != NULL)
+            cache->evict_proc(node->key, node->value, cache->user);
+    }
+}
+
+size_t vsc_lru_cache_size(const VscLruCache *cache)
+{
+    validate(cache);
+    return cache->size;
+}
+
+size_t vsc_lru_cache_cost(const VscLruCache *cache)
+{
+    validate(cache);
+    return cache->cost;
+}
+
+void vsc_lru_cache_stats(const VscLruCache *cache, VscLruCacheStats *stats)
+{
+    validate(cache);
+    vsc_assert(stats != NULL);
+
+    *stats = cache->stats;
+}
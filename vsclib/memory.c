@@ -196,17 +196,15 @@ int vsc_block_xalloc(const VscAllocator *a, void **ptr, const VscBlockAllocInfo
 
     for(size_t i = 1; i < nblocks; ++i) {
         const VscBlockAllocInfo *bai   = blockinfo + i;
-        void                    *p     = (void *)reqsize;
         size_t                   size  = bai->element_size * bai->count;
-        size_t                   space = ~(size_t)0;
         size_t                   align = bai->alignment == 0 ? a->alignment : bai->alignment;
-        size_t                   pad;
 
-        vsc_align(align, size, &p, &space);
-
-        pad = ~(size_t)0 - space;
-        size += pad;
-        reqsize += size;
+        /*
+         * The block itself is only guaranteed to be aligned to initial_align,
+         * so the padding can't be calculated from the offset alone. Always
+         * reserve enough for the worst case, pass 2 will pack them tightly.
+         */
+        reqsize += size + (align - 1);
     }
 
     if((r = vsc_xalloc_ex(a, &block, reqsize, flags, blockinfo[0].alignment)) < 0)
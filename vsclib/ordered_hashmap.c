@@ -0,0 +1,461 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/ordered_hashmap.h>
+
+#define VSC_ORDERED_HASHMAP_MIN_SLOTS 16
+
+/*
+ * A compact, insertion-ordered map, in the style of CPython's dict.
+ *
+ * - entries is a dense array of every element, in insertion order. Removed
+ *   elements are marked with VSC_INVALID_HASH, and squeezed out when the
+ *   array fills up.
+ * - index is an open-addressed table of (entry index + 1), 0 being empty,
+ *   linearly probed with backward-shift deletion just like VscHashMap.
+ *   Each slot is only as wide as needed to address every entry.
+ *
+ * Both are a single allocation, owned by entries.
+ */
+struct VscOrderedHashMap {
+    size_t size;
+    /* The number of entries used, including removed ones. */
+    size_t num_entries;
+    size_t entry_capacity;
+    /* Always a power-of-two. */
+    size_t num_slots;
+    size_t slot_width;
+
+    VscHashMapBucket *entries;
+    void             *index;
+
+    VscHashMapHashProc    hash_proc;
+    VscHashMapCompareProc compare_proc;
+    const VscAllocator   *allocator;
+};
+
+/* This should be optimised out in Release builds. */
+static inline void validate(const VscOrderedHashMap *om)
+{
+    (void)om;
+    vsc_assert(om != NULL);
+    vsc_assert(om->size <= om->num_entries);
+    vsc_assert(om->num_entries <= om->entry_capacity);
+    vsc_assert(om->entry_capacity < om->num_slots || om->num_slots == 0);
+    vsc_assert(om->hash_proc != NULL);
+    vsc_assert(om->compare_proc != NULL);
+    vsc_assert(om->allocator != NULL);
+}
+
+static inline size_t slot_get(const VscOrderedHashMap *om, size_t i)
+{
+    switch(om->slot_width) {
+        case 1:
+            return ((const uint8_t *)om->index)[i];
+        case 2:
+            return ((const uint16_t *)om->index)[i];
+        case 4:
+            return ((const uint32_t *)om->index)[i];
+        default:
+            return ((const size_t *)om->index)[i];
+    }
+}
+
+static inline void slot_set(VscOrderedHashMap *om, size_t i, size_t ix)
+{
+    switch(om->slot_width) {
+        case 1:
+            ((uint8_t *)om->index)[i] = (uint8_t)ix;
+            break;
+        case 2:
+            ((uint16_t *)om->index)[i] = (uint16_t)ix;
+            break;
+        case 4:
+            ((uint32_t *)om->index)[i] = (uint32_t)ix;
+            break;
+        default:
+            ((size_t *)om->index)[i] = ix;
+            break;
+    }
+}
+
+/*
+ * The number of entries a table of `num_slots` index slots can hold,
+ * keeping the load factor of the index table at or below 3/4.
+ */
+static inline size_t usable(size_t num_slots)
+{
+    return num_slots - num_slots / 4;
+}
+
+/*
+ * The smallest slot able to store (entry index + 1) for `capacity` entries.
+ */
+static inline size_t slot_width(size_t capacity)
+{
+    if(capacity <= UINT8_MAX)
+        return sizeof(uint8_t);
+
+    if(capacity <= UINT16_MAX)
+        return sizeof(uint16_t);
+
+#if VSC_SIZEOF_SIZE_T > 4
+    if(capacity <= UINT32_MAX)
+        return sizeof(uint32_t);
+#endif
+
+    return sizeof(size_t);
+}
+
+VscOrderedHashMap *vsc_ordered_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare,
+                                              const VscAllocator *a)
+{
+    VscOrderedHashMap *om;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(compare != NULL);
+    vsc_assert(a != NULL);
+
+    if((om = vsc_xalloc(a, sizeof(VscOrderedHashMap))) == NULL)
+        return NULL;
+
+    *om = (VscOrderedHashMap){
+        .size           = 0,
+        .num_entries    = 0,
+        .entry_capacity = 0,
+        .num_slots      = 0,
+        .slot_width     = 0,
+        .entries        = NULL,
+        .index          = NULL,
+        .hash_proc      = hash,
+        .compare_proc   = compare,
+        .allocator      = a,
+    };
+    return om;
+}
+
+VscOrderedHashMap *vsc_ordered_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare)
+{
+    return vsc_ordered_hashmap_alloca(hash, compare, vsclib_system_allocator);
+}
+
+void vsc_ordered_hashmap_free(VscOrderedHashMap *om)
+{
+    validate(om);
+
+    vsc_ordered_hashmap_reset(om);
+    vsc_xfree(om->allocator, om);
+}
+
+void vsc_ordered_hashmap_clear(VscOrderedHashMap *om)
+{
+    validate(om);
+
+    om->size        = 0;
+    om->num_entries = 0;
+
+    if(om->index != NULL)
+        memset(om->index, 0, om->num_slots * om->slot_width);
+}
+
+void vsc_ordered_hashmap_reset(VscOrderedHashMap *om)
+{
+    validate(om);
+
+    vsc_xfree(om->allocator, om->entries);
+    om->size           = 0;
+    om->num_entries    = 0;
+    om->entry_capacity = 0;
+    om->num_slots      = 0;
+    om->slot_width     = 0;
+    om->entries        = NULL;
+    om->index          = NULL;
+}
+
+/*
+ * Put entry `ix` in its first free index slot. It must not already be present.
+ */
+static inline void index_entry(VscOrderedHashMap *om, size_t ix)
+{
+    size_t mask = om->num_slots - 1;
+    size_t i;
+
+    for(i = om->entries[ix].hash & mask; slot_get(om, i) != 0; i = (i + 1) & mask)
+        ;
+
+    slot_set(om, i, ix + 1);
+}
+
+/*
+ * Move everything into a new block with `num_slots` index slots,
+ * squeezing out any removed entries.
+ */
+static int rebuild(VscOrderedHashMap *om, size_t num_slots)
+{
+    void             *ptrs[2];
+    VscHashMapBucket *entries;
+    size_t            capacity = usable(num_slots), width = slot_width(capacity), n = 0;
+    int               r;
+    VscBlockAllocInfo bai[2] = {
+        {capacity,  sizeof(VscHashMapBucket), VSC_ALIGNOF(VscHashMapBucket), NULL},
+        {num_slots, width,                    width,                         NULL},
+    };
+
+    vsc_assert(VSC_IS_POT(num_slots));
+    vsc_assert(capacity >= om->size);
+
+    if(num_slots >= SIZE_MAX / (sizeof(VscHashMapBucket) + sizeof(size_t)))
+        return VSC_ERROR(ERANGE);
+
+    if((r = vsc_block_xalloc(om->allocator, ptrs, bai, 2, VSC_ALLOC_ZERO)) < 0)
+        return r;
+
+    entries = ptrs[0];
+    for(size_t i = 0; i < om->num_entries; ++i) {
+        if(om->entries[i].hash != VSC_INVALID_HASH)
+            entries[n++] = om->entries[i];
+    }
+
+    vsc_xfree(om->allocator, om->entries);
+
+    om->num_entries    = n;
+    om->entry_capacity = capacity;
+    om->num_slots      = num_slots;
+    om->slot_width     = width;
+    om->entries        = entries;
+    om->index          = ptrs[1];
+
+    for(size_t i = 0; i < n; ++i)
+        index_entry(om, i);
+
+    return 0;
+}
+
+/*
+ * Get the number of index slots needed to hold `nelem` elements.
+ */
+static int slots_for(size_t nelem, size_t *num_slots)
+{
+    size_t n = VSC_ORDERED_HASHMAP_MIN_SLOTS;
+
+    while(usable(n) < nelem) {
+        if(n > SIZE_MAX / 2)
+            return VSC_ERROR(ERANGE);
+
+        n *= 2;
+    }
+
+    *num_slots = n;
+    return 0;
+}
+
+int vsc_ordered_hashmap_reserve(VscOrderedHashMap *om, size_t nelem)
+{
+    size_t num_slots;
+    int    r;
+
+    validate(om);
+
+    if(nelem <= om->size || nelem - om->size <= om->entry_capacity - om->num_entries)
+        return 0;
+
+    if((r = slots_for(nelem, &num_slots)) < 0)
+        return r;
+
+    return rebuild(om, num_slots);
+}
+
+/*
+ * Find the index slot pointing at `key`.
+ */
+static int find_slot(const VscOrderedHashMap *om, const void *key, vsc_hash_t hash, size_t *slot)
+{
+    size_t mask = om->num_slots - 1;
+
+    if(om->num_slots == 0)
+        return 0;
+
+    for(size_t i = hash & mask, ix; (ix = slot_get(om, i)) != 0; i = (i + 1) & mask) {
+        const VscHashMapBucket *e = om->entries + ix - 1;
+
+        if(e->hash == hash && om->compare_proc(key, e->key)) {
+            *slot = i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int vsc_ordered_hashmap_insert(VscOrderedHashMap *om, const void *key, void *value)
+{
+    vsc_hash_t        hash;
+    VscHashMapBucket *e;
+    size_t            slot;
+    int               r;
+
+    validate(om);
+
+    if((hash = om->hash_proc(key)) == VSC_INVALID_HASH)
+        return VSC_ERROR(ERANGE);
+
+    if(find_slot(om, key, hash, &slot)) {
+        e        = om->entries + slot_get(om, slot) - 1;
+        e->key   = key;
+        e->value = value;
+        return 0;
+    }
+
+    /*
+     * Out of entries. Size for half as many again as are live, so if
+     * plenty were removed this only compacts the array in place.
+     */
+    if(om->num_entries == om->entry_capacity) {
+        size_t num_slots;
+
+        if(om->size >= SIZE_MAX / 3)
+            return VSC_ERROR(ERANGE);
+
+        if((r = slots_for((om->size + 1) * 3 / 2, &num_slots)) < 0)
+            return r;
+
+        if((r = rebuild(om, num_slots)) < 0)
+            return r;
+    }
+
+    e = om->entries + om->num_entries;
+    *e = (VscHashMapBucket){
+        .hash  = hash,
+        .key   = key,
+        .value = value,
+    };
+
+    index_entry(om, om->num_entries);
+    ++om->num_entries;
+    ++om->size;
+    return 0;
+}
+
+void *vsc_ordered_hashmap_find(const VscOrderedHashMap *om, const void *key)
+{
+    vsc_hash_t hash;
+    size_t     slot;
+
+    validate(om);
+
+    if((hash = om->hash_proc(key)) == VSC_INVALID_HASH)
+        return NULL;
+
+    if(!find_slot(om, key, hash, &slot))
+        return NULL;
+
+    return om->entries[slot_get(om, slot) - 1].value;
+}
+
+void *vsc_ordered_hashmap_remove(VscOrderedHashMap *om, const void *key)
+{
+    vsc_hash_t        hash;
+    VscHashMapBucket *e;
+    void             *value;
+    size_t            slot, mask, ix;
+
+    validate(om);
+
+    if((hash = om->hash_proc(key)) == VSC_INVALID_HASH)
+        return NULL;
+
+    if(!find_slot(om, key, hash, &slot))
+        return NULL;
+
+    e     = om->entries + slot_get(om, slot) - 1;
+    value = e->value;
+    mask  = om->num_slots - 1;
+
+    /* Fill the gap in the index, the same as VscHashMap. */
+    slot_set(om, slot, 0);
+    for(size_t i = (slot + 1) & mask; (ix = slot_get(om, i)) != 0; i = (i + 1) & mask) {
+        size_t home = om->entries[ix - 1].hash & mask;
+
+        /* It can't move if its home slot lies (circularly) within (slot, i]. */
+        if(slot <= i ? (slot < home && home <= i) : (slot < home || home <= i))
+            continue;
+
+        slot_set(om, slot, ix);
+        slot_set(om, i, 0);
+        slot = i;
+    }
+
+    *e = (VscHashMapBucket){
+        .hash  = VSC_INVALID_HASH,
+        .key   = NULL,
+        .value = NULL,
+    };
+    --om->size;
+
+    /* Removed entries at the end can be reused straight away. */
+    while(om->num_entries > 0 && om->entries[om->num_entries - 1].hash == VSC_INVALID_HASH)
+        --om->num_entries;
+
+    return value;
+}
+
+size_t vsc_ordered_hashmap_size(const VscOrderedHashMap *om)
+{
+    validate(om);
+    return om->size;
+}
+
+size_t vsc_ordered_hashmap_capacity(const VscOrderedHashMap *om)
+{
+    validate(om);
+    return om->entry_capacity;
+}
+
+const VscHashMapBucket *vsc_ordered_hashmap_entries(const VscOrderedHashMap *om, size_t *count)
+{
+    validate(om);
+    vsc_assert(count != NULL);
+
+    *count = om->num_entries;
+    return om->num_entries > 0 ? om->entries : NULL;
+}
+
+int vsc_ordered_hashmap_enumerate(const VscOrderedHashMap *om, VscHashMapEnumProc proc, void *user)
+{
+    int r;
+
+    validate(om);
+    vsc_assert(proc != NULL);
+
+    for(size_t i = 0; i < om->num_entries; ++i) {
+        const VscHashMapBucket *e = om->entries + i;
+
+        if(e->hash == VSC_INVALID_HASH)
+            continue;
+
+        if((r = proc(e->key, e->value, e->hash, user)) != 0)
+            return r;
+    }
+
+    return 0;
+}
@@ -0,0 +1,383 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <errno.h>
+#include <string.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/hash.h>
+#include <vsclib/hashmap_typed.h>
+#include <vsclib/macros.h>
+#include <vsclib/mem.h>
+#include <vsclib/perfect_hash.h>
+
+/*
+ * Table layout:
+ *   [0] magic
+ *   [1] number of keys
+ *   [2] number of buckets
+ *   [3] global seed
+ *   [4] number of slots
+ *   [5] per-bucket seeds
+ *   [5 + buckets] slot remap, one per slot past the number of keys
+ *
+ * Keys are placed into slightly more slots than there are keys, which keeps
+ * the seed search for the last few buckets from degenerating as the table fills.
+ * Keys placed past the end are remapped onto the holes left at the front.
+ *
+ * The magic changed with the slot remap, so older tables are rejected.
+ */
+#define PH_MAGIC        VSC_FOURCC('V', 'S', 'P', '2')
+#define PH_HEADER_LEN   5
+#define PH_BUCKET_SIZE  4
+/* One extra slot per this many keys, i.e. a load factor of about 0.99. */
+#define PH_SLACK        100
+#define PH_MAX_ATTEMPTS 16
+/* Give up on a bucket after this many seeds, and restart with a new global seed. */
+#define PH_MAX_SEEDS    (1u << 20)
+
+static inline uint64_t ph_hash(const void *key, size_t key_size, uint32_t gseed)
+{
+    return vsc_hash64(key, key_size, gseed);
+}
+
+static inline uint32_t ph_bucket(uint64_t h, uint32_t num_buckets)
+{
+    return (uint32_t)((h >> 32) % num_buckets);
+}
+
+static inline uint32_t ph_slot(uint64_t h, uint32_t seed, uint32_t num_slots)
+{
+    return (uint32_t)(vsc_hashmap_mix64(h ^ (seed * UINT64_C(0x9E3779B97F4A7C15))) % num_slots);
+}
+
+typedef struct PHState {
+    uint32_t  nkeys;
+    uint32_t  num_buckets;
+    uint32_t  num_slots;
+    uint64_t *hashes;
+    uint32_t *offsets; /* bucket -> start index in members, num_buckets + 1 */
+    uint32_t *members; /* key indices, grouped by bucket */
+    uint32_t *order;   /* buckets, largest first */
+    uint32_t *slots;   /* scratch, one bucket's slots */
+    uint8_t  *taken;   /* num_slots */
+} PHState;
+
+/*
+ * Try to place all the keys with the given global seed.
+ * Returns 0 on success, 1 if a new seed should be tried.
+ */
+static int place_all(PHState *s, const void *const *keys, const size_t *key_sizes, uint32_t gseed, uint32_t *seeds)
+{
+    uint32_t max_size = 0;
+
+    memset(s->offsets, 0, (s->num_buckets + 1) * sizeof(uint32_t));
+    memset(s->taken, 0, s->num_slots);
+
+    /* Hash everything once, and count the bucket sizes. */
+    for(uint32_t i = 0; i < s->nkeys; ++i) {
+        s->hashes[i] = ph_hash(keys[i], key_sizes[i], gseed);
+        ++s->offsets[ph_bucket(s->hashes[i], s->num_buckets) + 1];
+    }
+
+    for(uint32_t b = 0; b < s->num_buckets; ++b) {
+        max_size = VSC_MAX(max_size, s->offsets[b + 1]);
+        s->offsets[b + 1] += s->offsets[b];
+    }
+
+    /* Group the keys by bucket. The order array is borrowed as a cursor. */
+    for(uint32_t b = 0; b < s->num_buckets; ++b)
+        s->order[b] = s->offsets[b];
+
+    for(uint32_t i = 0; i < s->nkeys; ++i)
+        s->members[s->order[ph_bucket(s->hashes[i], s->num_buckets)]++] = i;
+
+    /* Order the buckets largest-first, with a counting sort on their size. */
+    {
+        uint32_t n = 0;
+        for(uint32_t size = max_size; size > 0; --size) {
+            for(uint32_t b = 0; b < s->num_buckets; ++b) {
+                if(s->offsets[b + 1] - s->offsets[b] == size)
+                    s->order[n++] = b;
+            }
+        }
+
+        for(uint32_t b = 0; b < s->num_buckets; ++b) {
+            if(s->offsets[b + 1] == s->offsets[b]) {
+                seeds[b]      = 0;
+                s->order[n++] = b;
+            }
+        }
+    }
+
+    for(uint32_t o = 0; o < s->num_buckets; ++o) {
+        uint32_t b     = s->order[o];
+        uint32_t start = s->offsets[b];
+        uint32_t size  = s->offsets[b + 1] - start;
+        uint32_t seed;
+
+        if(size == 0)
+            break;
+
+        /* Identical hashes can never be separated. */
+        for(uint32_t i = 0; i < size; ++i) {
+            for(uint32_t j = i + 1; j < size; ++j) {
+                if(s->hashes[s->members[start + i]] == s->hashes[s->members[start + j]])
+                    return 1;
+            }
+        }
+
+        for(seed = 0; seed < PH_MAX_SEEDS; ++seed) {
+            uint32_t i;
+
+            for(i = 0; i < size; ++i) {
+                uint32_t slot = ph_slot(s->hashes[s->members[start + i]], seed, s->num_slots);
+
+                if(s->taken[slot])
+                    break;
+
+                /* Reserve it, so the bucket's own keys can't collide. */
+                s->taken[slot] = 1;
+                s->slots[i]    = slot;
+            }
+
+            if(i == size)
+                break;
+
+            while(i-- > 0)
+                s->taken[s->slots[i]] = 0;
+        }
+
+        if(seed == PH_MAX_SEEDS)
+            return 1;
+
+        seeds[b] = seed;
+    }
+
+    return 0;
+}
+
+/* Point each taken slot past the end at a free one before it. Unused entries are left at 0. */
+static void build_remap(const PHState *s, uint32_t *remap)
+{
+    uint32_t hole = 0;
+
+    for(uint32_t slot = s->nkeys; slot < s->num_slots; ++slot) {
+        remap[slot - s->nkeys] = 0;
+
+        if(!s->taken[slot])
+            continue;
+
+        while(s->taken[hole])
+            ++hole;
+
+        remap[slot - s->nkeys] = hole++;
+    }
+}
+
+/* Returns nonzero if there are duplicate keys. Only called if placement keeps failing. */
+static int has_duplicates(const PHState *s, const void *const *keys, const size_t *key_sizes)
+{
+    for(uint32_t b = 0; b < s->num_buckets; ++b) {
+        for(uint32_t i = s->offsets[b]; i < s->offsets[b + 1]; ++i) {
+            for(uint32_t j = i + 1; j < s->offsets[b + 1]; ++j) {
+                uint32_t x = s->members[i], y = s->members[j];
+
+                if(key_sizes[x] == key_sizes[y] && memcmp(keys[x], keys[y], key_sizes[x]) == 0)
+                    return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int vsc_perfect_hash_builda(uint32_t **table, size_t *table_len, const void *const *keys, const size_t *key_sizes,
+                            size_t nkeys, const VscAllocator *a)
+{
+    uint32_t *t;
+    size_t    len;
+    uint32_t  num_buckets;
+    uint32_t  num_slots;
+    PHState   s;
+    void     *ptrs[6];
+    int       r;
+
+    if(table == NULL || a == NULL || (nkeys > 0 && (keys == NULL || key_sizes == NULL)))
+        return VSC_ERROR(EINVAL);
+
+    if(nkeys >= UINT32_MAX - UINT32_MAX / PH_SLACK)
+        return VSC_ERROR(ERANGE);
+
+    num_buckets = (uint32_t)VSC_MAX((nkeys + PH_BUCKET_SIZE - 1) / PH_BUCKET_SIZE, 1);
+    num_slots   = (uint32_t)(nkeys + (nkeys + PH_SLACK - 1) / PH_SLACK);
+    len         = PH_HEADER_LEN + num_buckets + (num_slots - nkeys);
+
+    /* The table first, so the temporaries can be freed LIFO. */
+    if((t = vsc_xalloc(a, len * sizeof(uint32_t))) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    t[0] = PH_MAGIC;
+    t[1] = (uint32_t)nkeys;
+    t[2] = num_buckets;
+    t[3] = 0;
+    t[4] = num_slots;
+
+    if(nkeys == 0) {
+        t[PH_HEADER_LEN] = 0;
+        goto done;
+    }
+
+    VscBlockAllocInfo bai[6] = {
+        {nkeys,           sizeof(uint64_t), VSC_ALIGNOF(uint64_t), NULL},
+        {num_buckets + 1, sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {nkeys,           sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {num_buckets,     sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {nkeys,           sizeof(uint32_t), VSC_ALIGNOF(uint32_t), NULL},
+        {num_slots,       sizeof(uint8_t),  VSC_ALIGNOF(uint8_t),  NULL},
+    };
+
+    if((r = vsc_block_xalloc(a, ptrs, bai, 6, 0)) < 0) {
+        vsc_xfree(a, t);
+        return r;
+    }
+
+    s = (PHState){
+        .nkeys       = (uint32_t)nkeys,
+        .num_buckets = num_buckets,
+        .num_slots   = num_slots,
+        .hashes      = ptrs[0],
+        .offsets     = ptrs[1],
+        .members     = ptrs[2],
+        .order       = ptrs[3],
+        .slots       = ptrs[4],
+        .taken       = ptrs[5],
+    };
+
+    r = VSC_ERROR(ENOSPC);
+    for(uint32_t attempt = 0; attempt < PH_MAX_ATTEMPTS; ++attempt) {
+        if(place_all(&s, keys, key_sizes, attempt, t + PH_HEADER_LEN) == 0) {
+            build_remap(&s, t + PH_HEADER_LEN + num_buckets);
+            t[3] = attempt;
+            r    = 0;
+            break;
+        }
+
+        if(has_duplicates(&s, keys, key_sizes)) {
+            r = VSC_ERROR(EEXIST);
+            break;
+        }
+    }
+
+    vsc_xfree(a, ptrs[0]);
+
+    if(r < 0) {
+        vsc_xfree(a, t);
+        return r;
+    }
+
+done:
+    *table = t;
+    if(table_len != NULL)
+        *table_len = len;
+    return 0;
+}
+
+int vsc_perfect_hash_build(uint32_t **table, size_t *table_len, const void *const *keys, const size_t *key_sizes,
+                           size_t nkeys)
+{
+    return vsc_perfect_hash_builda(table, table_len, keys, key_sizes, nkeys, vsclib_system_allocator);
+}
+
+int vsc_perfect_hash_validate(const uint32_t *table, size_t table_len)
+{
+    if(table == NULL || table_len < PH_HEADER_LEN + 1)
+        return VSC_ERROR(EINVAL);
+
+    if(table[0] != PH_MAGIC || table[2] == 0 || table[4] < table[1])
+        return VSC_ERROR(EINVAL);
+
+    if(table_len != PH_HEADER_LEN + (size_t)table[2] + (table[4] - table[1]))
+        return VSC_ERROR(EINVAL);
+
+    /* A remapped slot must land within the keys, or lookups could index out of bounds. */
+    for(size_t i = PH_HEADER_LEN + table[2]; i < table_len; ++i) {
+        if(table[i] >= table[1])
+            return VSC_ERROR(EINVAL);
+    }
+
+    return 0;
+}
+
+size_t vsc_perfect_hash_count(const uint32_t *table)
+{
+    vsc_assert(table != NULL && table[0] == PH_MAGIC);
+    return table[1];
+}
+
+size_t vsc_perfect_hash_table_len(const uint32_t *table)
+{
+    vsc_assert(table != NULL && table[0] == PH_MAGIC);
+    return PH_HEADER_LEN + (size_t)table[2] + (table[4] - table[1]);
+}
+
+size_t vsc_perfect_hash_lookup(const uint32_t *table, const void *key, size_t key_size)
+{
+    uint64_t h;
+    uint32_t slot;
+
+    vsc_assert(table != NULL && table[0] == PH_MAGIC);
+
+    if(table[1] == 0)
+        return 0;
+
+    h    = ph_hash(key, key_size, table[3]);
+    slot = ph_slot(h, table[PH_HEADER_LEN + ph_bucket(h, table[2])], table[4]);
+
+    if(slot >= table[1])
+        slot = table[PH_HEADER_LEN + table[2] + (slot - table[1])];
+
+    return slot;
+}
+
+int vsc_perfect_hash_write_c(const uint32_t *table, FILE *f, const char *name)
+{
+    size_t len;
+
+    if(table == NULL || f == NULL || name == NULL)
+        return VSC_ERROR(EINVAL);
+
+    len = vsc_perfect_hash_table_len(table);
+
+    if(fprintf(f, "/* Generated by vsc_perfect_hash_write_c(), %zu keys. */\n", vsc_perfect_hash_count(table)) < 0)
+        return VSC_ERROR(EIO);
+
+    if(fprintf(f, "static const uint32_t %s[%zu] = {", name, len) < 0)
+        return VSC_ERROR(EIO);
+
+    for(size_t i = 0; i < len; ++i) {
+        if(fprintf(f, "%s0x%08X,", i % 8 == 0 ? "\n    " : " ", (unsigned int)table[i]) < 0)
+            return VSC_ERROR(EIO);
+    }
+
+    if(fprintf(f, "\n};\n") < 0)
+        return VSC_ERROR(EIO);
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vsclib_config.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <limits.h>
+#include <windows.h>
+#include <bcrypt.h>
+#elif VSC_HAVE_GETRANDOM
+#include <sys/random.h>
+#elif VSC_HAVE_ARC4RANDOM_BUF
+#include <stdlib.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <errno.h>
+#include <vsclib/error.h>
+#include <vsclib/hash.h>
+#include <vsclib/time.h>
+#include "atomic_internal.h"
+#include "random_internal.h"
+
+int vsci_getrandom(void *buf, size_t size)
+{
+#if defined(_WIN32)
+    if(size > ULONG_MAX)
+        return VSC_ERROR(ERANGE);
+
+    if(!BCRYPT_SUCCESS(BCryptGenRandom(NULL, buf, (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+        return VSC_ERROR(EIO);
+
+    return 0;
+#elif VSC_HAVE_GETRANDOM
+    for(unsigned char *p = buf; size > 0;) {
+        ssize_t r = getrandom(p, size, 0);
+
+        if(r < 0) {
+            if(errno == EINTR)
+                continue;
+
+            return VSC_ERROR(errno);
+        }
+
+        p += r;
+        size -= (size_t)r;
+    }
+
+    return 0;
+#elif VSC_HAVE_ARC4RANDOM_BUF
+    arc4random_buf(buf, size);
+    return 0;
+#else
+    FILE *f;
+    int   r = 0;
+
+    if((f = fopen("/dev/urandom", "rb")) == NULL)
+        return VSC_ERROR(errno);
+
+    if(fread(buf, size, 1, f) != 1)
+        r = VSC_ERROR(EIO);
+
+    (void)fclose(f);
+    return r;
+#endif
+}
+
+/*
+ * SipHash-2-4 of a single 64-bit word, i.e. its 8 little-endian bytes.
+ * It's a PRF, so seeds given out reveal nothing about the key, or each other.
+ */
+#define SIP_ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIP_ROUND(v0, v1, v2, v3) \
+    do {                          \
+        v0 += v1;                 \
+        v1 = SIP_ROTL(v1, 13);    \
+        v1 ^= v0;                 \
+        v0 = SIP_ROTL(v0, 32);    \
+        v2 += v3;                 \
+        v3 = SIP_ROTL(v3, 16);    \
+        v3 ^= v2;                 \
+        v0 += v3;                 \
+        v3 = SIP_ROTL(v3, 21);    \
+        v3 ^= v0;                 \
+        v2 += v1;                 \
+        v1 = SIP_ROTL(v1, 17);    \
+        v1 ^= v2;                 \
+        v2 = SIP_ROTL(v2, 32);    \
+    } while(0)
+
+static uint64_t siphash24_u64(const uint64_t key[2], uint64_t m)
+{
+    const uint64_t b  = UINT64_C(8) << 56;
+    uint64_t       v0 = key[0] ^ UINT64_C(0x736f6d6570736575);
+    uint64_t       v1 = key[1] ^ UINT64_C(0x646f72616e646f6d);
+    uint64_t       v2 = key[0] ^ UINT64_C(0x6c7967656e657261);
+    uint64_t       v3 = key[1] ^ UINT64_C(0x7465646279746573);
+
+    v3 ^= m;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= m;
+
+    v3 ^= b;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*
+ * The process key and the seed key are independent, so neither can be
+ * worked out from the other.
+ */
+typedef struct RandomKeys {
+    uint64_t process;
+    uint64_t seed[2];
+} RandomKeys;
+
+/*
+ * 0 = not initialised, 1 = initialising, 2 = ready.
+ */
+static volatile uint32_t key_state = 0;
+static RandomKeys        keys;
+static volatile size_t   seed_counter = 0;
+
+static const RandomKeys *get_keys(void)
+{
+    uint32_t expected = 0;
+
+    if(vsci_atomic_load_u32(&key_state) == 2)
+        return &keys;
+
+    if(vsci_atomic_cas_u32(&key_state, &expected, 1)) {
+        /*
+         * If the OS can't give us anything, fall back to something that at
+         * least varies between runs. It's not unpredictable, but it's better
+         * than the same key everywhere.
+         */
+        if(vsci_getrandom(&keys, sizeof(keys)) < 0) {
+            uintptr_t addr = (uintptr_t)&keys;
+            keys.process   = vsc_hash64(&addr, sizeof(addr), vsc_counter_ns());
+            keys.seed[0]   = vsc_hash64(&addr, sizeof(addr), keys.process);
+            keys.seed[1]   = vsc_hash64(&addr, sizeof(addr), vsc_counter_ns() ^ keys.seed[0]);
+        }
+
+        vsci_atomic_store_u32(&key_state, 2);
+        return &keys;
+    }
+
+    while(vsci_atomic_load_u32(&key_state) != 2)
+        vsci_cpu_relax();
+
+    return &keys;
+}
+
+uint64_t vsci_random_process_key(void)
+{
+    return get_keys()->process;
+}
+
+uint64_t vsci_random_seed(void)
+{
+    const RandomKeys *k = get_keys();
+    size_t            n = vsci_atomic_fetch_add_size(&seed_counter, 1);
+
+    return siphash24_u64(k->seed, (uint64_t)n);
+}
@@ -0,0 +1,46 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCLIB_RANDOM_INTERNAL_H
+#define _VSCLIB_RANDOM_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fill a buffer from the operating system's CSPRNG.
+ * Returns 0 on success, or a negative error value.
+ */
+int vsci_getrandom(void *buf, size_t size);
+
+/*
+ * Get a fresh, unpredictable 64-bit seed.
+ *
+ * The OS CSPRNG is only read once per process for a secret key. Each call then
+ * runs a counter through SipHash keyed with it, so this is cheap enough to call
+ * per-object, and one seed says nothing about any other.
+ */
+uint64_t vsci_random_seed(void);
+
+/*
+ * Get the process-wide random key, for hashes that can't carry their own seed.
+ */
+uint64_t vsci_random_process_key(void);
+
+#endif /* _VSCLIB_RANDOM_INTERNAL_H */
@@ -0,0 +1,523 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/rcu_hashmap.h>
+#include "lock_internal.h"
+
+#define VSC_RCU_HASHMAP_MIN_BUCKETS 16
+
+/*
+ * An immutable table. Once published, only the retirement fields are ever written.
+ */
+typedef struct VscRcuSnapshot {
+    size_t            size;
+    size_t            num_buckets;
+    VscHashMapBucket *buckets;
+
+    size_t                 retire_epoch;
+    struct VscRcuSnapshot *next;
+} VscRcuSnapshot;
+
+/*
+ * Each reader lives on its own cache line. The reader is the only one
+ * to write to epoch, writers only ever read it.
+ *
+ * An epoch of 0 means the reader isn't in a critical section.
+ */
+struct VscRcuHashMapReader {
+    volatile size_t      epoch;
+    VscRcuHashMap       *map;
+    VscRcuHashMapReader *next;
+    int                  in_use;
+};
+
+struct VscRcuHashMap {
+    /* Read by readers, only written by writers. */
+    VscRcuSnapshot *volatile current;
+    volatile size_t          epoch;
+
+    /* Everything below is protected by lock. */
+    VscLock              lock;
+    VscRcuHashMapReader *readers;
+    VscRcuSnapshot      *retired;
+
+    VscHashMapHashProc    hash_proc;
+    VscHashMapCompareProc compare_proc;
+    const VscAllocator   *allocator;
+};
+
+static inline void validate(const VscRcuHashMap *map)
+{
+    (void)map;
+    vsc_assert(map != NULL);
+    vsc_assert(map->hash_proc != NULL);
+    vsc_assert(map->compare_proc != NULL);
+    vsc_assert(map->allocator != NULL);
+}
+
+static inline vsc_hash_t hash_key(const VscRcuHashMap *map, const void *key)
+{
+    vsc_hash_t hash = map->hash_proc(key);
+    vsc_assert(hash != VSC_INVALID_HASH);
+    return hash;
+}
+
+static VscRcuSnapshot *snapshot_alloc(const VscRcuHashMap *map, size_t nelem)
+{
+    VscRcuSnapshot *snap;
+    void           *ptrs[2];
+    size_t          num_buckets;
+
+    /* Keep the load factor at or below 1/2, lookups are what matter here. */
+    if(nelem > SIZE_MAX / (2 * sizeof(VscHashMapBucket)))
+        return NULL;
+
+    num_buckets = VSC_MAX(nelem * 2, VSC_RCU_HASHMAP_MIN_BUCKETS);
+
+    VscBlockAllocInfo bai[2] = {
+        {1,           sizeof(VscRcuSnapshot),   VSC_ALIGNOF(VscRcuSnapshot),   NULL},
+        {num_buckets, sizeof(VscHashMapBucket), VSC_ALIGNOF(VscHashMapBucket), NULL},
+    };
+
+    if(vsc_block_xalloc(map->allocator, ptrs, bai, 2, 0) < 0)
+        return NULL;
+
+    snap  = ptrs[0];
+    *snap = (VscRcuSnapshot){
+        .size         = 0,
+        .num_buckets  = num_buckets,
+        .buckets      = ptrs[1],
+        .retire_epoch = 0,
+        .next         = NULL,
+    };
+
+    for(size_t i = 0; i < num_buckets; ++i)
+        snap->buckets[i] = (VscHashMapBucket){.hash = VSC_INVALID_HASH, .key = NULL, .value = NULL};
+
+    return snap;
+}
+
+static void snapshot_free(const VscRcuHashMap *map, VscRcuSnapshot *snap)
+{
+    vsc_xfree(map->allocator, snap);
+}
+
+static VscHashMapBucket *snapshot_lookup(const VscRcuHashMap *map, const VscRcuSnapshot *snap, const void *key,
+                                         vsc_hash_t hash)
+{
+    size_t start;
+
+    if(snap == NULL)
+        return NULL;
+
+    start = hash % snap->num_buckets;
+    for(size_t i = 0; i < snap->num_buckets; ++i) {
+        VscHashMapBucket *bkt = snap->buckets + ((start + i) % snap->num_buckets);
+
+        if(bkt->hash == VSC_INVALID_HASH)
+            return NULL;
+
+        if(bkt->hash == hash && map->compare_proc(key, bkt->key))
+            return bkt;
+    }
+
+    return NULL;
+}
+
+/*
+ * Add an entry to a snapshot that isn't published yet.
+ * The key must not already be present.
+ */
+static void snapshot_add(VscRcuSnapshot *snap, vsc_hash_t hash, const void *key, void *value)
+{
+    size_t start = hash % snap->num_buckets;
+
+    vsc_assert(snap->size < snap->num_buckets);
+
+    for(size_t i = 0; i < snap->num_buckets; ++i) {
+        VscHashMapBucket *bkt = snap->buckets + ((start + i) % snap->num_buckets);
+
+        if(bkt->hash != VSC_INVALID_HASH)
+            continue;
+
+        *bkt = (VscHashMapBucket){.hash = hash, .key = key, .value = value};
+        ++snap->size;
+        return;
+    }
+}
+
+/*
+ * Copy a snapshot into a new one with room for `extra` more elements,
+ * skipping `skip` (if not NULL).
+ */
+static VscRcuSnapshot *snapshot_copy(const VscRcuHashMap *map, const VscRcuSnapshot *old, size_t extra,
+                                     const VscHashMapBucket *skip)
+{
+    VscRcuSnapshot *snap;
+    size_t          size = old != NULL ? old->size : 0;
+
+    if(extra > SIZE_MAX - size)
+        return NULL;
+
+    if((snap = snapshot_alloc(map, size + extra)) == NULL)
+        return NULL;
+
+    if(old == NULL)
+        return snap;
+
+    for(size_t i = 0; i < old->num_buckets; ++i) {
+        const VscHashMapBucket *bkt = old->buckets + i;
+
+        if(bkt->hash == VSC_INVALID_HASH || bkt == skip)
+            continue;
+
+        snapshot_add(snap, bkt->hash, bkt->key, bkt->value);
+    }
+
+    return snap;
+}
+
+/*
+ * Free any retired snapshots older than the oldest active reader.
+ * The lock must be held.
+ */
+static void reclaim_locked(VscRcuHashMap *map)
+{
+    size_t           min_epoch = SIZE_MAX;
+    VscRcuSnapshot **prev;
+
+    /* Pairs with the fence in read_begin(). */
+    vsci_atomic_fence();
+
+    for(const VscRcuHashMapReader *r = map->readers; r != NULL; r = r->next) {
+        size_t e = vsci_atomic_load_size(&r->epoch);
+        if(e != 0 && e < min_epoch)
+            min_epoch = e;
+    }
+
+    prev = &map->retired;
+    while(*prev != NULL) {
+        VscRcuSnapshot *snap = *prev;
+
+        /*
+         * A reader that entered at the retirement epoch or before
+         * may have loaded this snapshot.
+         */
+        if(snap->retire_epoch >= min_epoch) {
+            prev = &snap->next;
+            continue;
+        }
+
+        *prev = snap->next;
+        snapshot_free(map, snap);
+    }
+}
+
+/*
+ * Publish a new snapshot, retiring the old one. The lock must be held.
+ */
+static void publish_locked(VscRcuHashMap *map, VscRcuSnapshot *snap)
+{
+    VscRcuSnapshot *old = vsci_atomic_xchg_ptr((void *volatile *)&map->current, snap);
+
+    if(old != NULL) {
+        old->retire_epoch = vsci_atomic_fetch_add_size(&map->epoch, 1);
+        old->next         = map->retired;
+        map->retired      = old;
+    }
+
+    reclaim_locked(map);
+}
+
+VscRcuHashMap *vsc_rcu_hashmap_alloca(VscHashMapHashProc hash, VscHashMapCompareProc compare, const VscAllocator *a)
+{
+    VscRcuHashMap *map;
+
+    vsc_assert(hash != NULL);
+    vsc_assert(compare != NULL);
+    vsc_assert(a != NULL);
+
+    if((map = vsc_xalloc(a, sizeof(VscRcuHashMap))) == NULL)
+        return NULL;
+
+    *map = (VscRcuHashMap){
+        .current      = NULL,
+        .epoch        = 1,
+        .lock         = VSC_LOCK_INIT,
+        .readers      = NULL,
+        .retired      = NULL,
+        .hash_proc    = hash,
+        .compare_proc = compare,
+        .allocator    = a,
+    };
+
+    return map;
+}
+
+VscRcuHashMap *vsc_rcu_hashmap_alloc(VscHashMapHashProc hash, VscHashMapCompareProc compare)
+{
+    return vsc_rcu_hashmap_alloca(hash, compare, vsclib_system_allocator);
+}
+
+void vsc_rcu_hashmap_free(VscRcuHashMap *map)
+{
+    if(map == NULL)
+        return;
+
+    validate(map);
+
+    while(map->readers != NULL) {
+        VscRcuHashMapReader *r = map->readers;
+        map->readers           = r->next;
+        vsc_xfree(map->allocator, r);
+    }
+
+    while(map->retired != NULL) {
+        VscRcuSnapshot *snap = map->retired;
+        map->retired         = snap->next;
+        snapshot_free(map, snap);
+    }
+
+    if(map->current != NULL)
+        snapshot_free(map, map->current);
+
+    vsc_xfree(map->allocator, map);
+}
+
+VscRcuHashMapReader *vsc_rcu_hashmap_register_reader(VscRcuHashMap *map)
+{
+    VscRcuHashMapReader *r;
+    void                *p;
+
+    validate(map);
+
+    vsci_lock_acquire(&map->lock);
+
+    /* Reuse an old reader if we can. */
+    for(r = map->readers; r != NULL; r = r->next) {
+        if(!r->in_use) {
+            r->in_use = 1;
+            vsci_lock_release(&map->lock);
+            return r;
+        }
+    }
+
+    p = NULL;
+    if(vsc_xalloc_ex(map->allocator, &p, VSC_MAX(sizeof(VscRcuHashMapReader), VSC_CACHE_LINE_SIZE), 0,
+                     VSC_CACHE_LINE_SIZE) < 0) {
+        vsci_lock_release(&map->lock);
+        return NULL;
+    }
+
+    r  = p;
+    *r = (VscRcuHashMapReader){
+        .epoch  = 0,
+        .map    = map,
+        .next   = map->readers,
+        .in_use = 1,
+    };
+    map->readers = r;
+
+    vsci_lock_release(&map->lock);
+    return r;
+}
+
+void vsc_rcu_hashmap_unregister_reader(VscRcuHashMapReader *reader)
+{
+    VscRcuHashMap *map;
+
+    if(reader == NULL)
+        return;
+
+    map = reader->map;
+    vsc_assert(reader->in_use);
+    vsc_assert(reader->epoch == 0);
+
+    vsci_lock_acquire(&map->lock);
+    reader->in_use = 0;
+    vsci_lock_release(&map->lock);
+}
+
+static inline void read_begin(VscRcuHashMapReader *reader)
+{
+    vsci_atomic_store_size(&reader->epoch, vsci_atomic_load_size(&reader->map->epoch));
+
+    /*
+     * The epoch must be visible before the snapshot pointer is loaded,
+     * otherwise a writer may free the snapshot out from under us.
+     */
+    vsci_atomic_fence();
+}
+
+static inline void read_end(VscRcuHashMapReader *reader)
+{
+    vsci_atomic_store_size(&reader->epoch, 0);
+}
+
+void *vsc_rcu_hashmap_find(VscRcuHashMapReader *reader, const void *key)
+{
+    VscRcuHashMap          *map;
+    const VscRcuSnapshot   *snap;
+    const VscHashMapBucket *bkt;
+    vsc_hash_t              hash;
+    void                   *value;
+
+    vsc_assert(reader != NULL);
+    vsc_assert(reader->in_use);
+    vsc_assert(reader->epoch == 0);
+
+    map = reader->map;
+    validate(map);
+
+    hash = hash_key(map, key);
+
+    read_begin(reader);
+
+    snap  = vsci_atomic_load_ptr((void *const volatile *)&map->current);
+    bkt   = snapshot_lookup(map, snap, key, hash);
+    value = bkt != NULL ? bkt->value : NULL;
+
+    read_end(reader);
+
+    return value;
+}
+
+int vsc_rcu_hashmap_insert(VscRcuHashMap *map, const void *key, void *value)
+{
+    VscRcuSnapshot   *snap;
+    VscHashMapBucket *bkt;
+    vsc_hash_t        hash;
+
+    validate(map);
+
+    hash = hash_key(map, key);
+
+    vsci_lock_acquire(&map->lock);
+
+    bkt = snapshot_lookup(map, map->current, key, hash);
+
+    /* If replacing, copy everything but the old entry. */
+    if((snap = snapshot_copy(map, map->current, bkt == NULL, bkt)) == NULL) {
+        vsci_lock_release(&map->lock);
+        return VSC_ERROR(ENOMEM);
+    }
+
+    snapshot_add(snap, hash, key, value);
+    publish_locked(map, snap);
+
+    vsci_lock_release(&map->lock);
+    return 0;
+}
+
+int vsc_rcu_hashmap_update(VscRcuHashMap *map, const void *key, void *value)
+{
+    VscRcuSnapshot   *snap;
+    VscHashMapBucket *bkt;
+    vsc_hash_t        hash;
+
+    validate(map);
+
+    hash = hash_key(map, key);
+
+    vsci_lock_acquire(&map->lock);
+
+    if((bkt = snapshot_lookup(map, map->current, key, hash)) == NULL) {
+        vsci_lock_release(&map->lock);
+        return 1;
+    }
+
+    if((snap = snapshot_copy(map, map->current, 0, bkt)) == NULL) {
+        vsci_lock_release(&map->lock);
+        return VSC_ERROR(ENOMEM);
+    }
+
+    /* Keep the original key, as vsc_hashmap_update() does. */
+    snapshot_add(snap, hash, bkt->key, value);
+    publish_locked(map, snap);
+
+    vsci_lock_release(&map->lock);
+    return 0;
+}
+
+int vsc_rcu_hashmap_remove(VscRcuHashMap *map, const void *key, void **value)
+{
+    VscRcuSnapshot   *snap;
+    VscHashMapBucket *bkt;
+    vsc_hash_t        hash;
+
+    validate(map);
+
+    hash = hash_key(map, key);
+
+    vsci_lock_acquire(&map->lock);
+
+    if((bkt = snapshot_lookup(map, map->current, key, hash)) == NULL) {
+        vsci_lock_release(&map->lock);
+        return 1;
+    }
+
+    if((snap = snapshot_copy(map, map->current, 0, bkt)) == NULL) {
+        vsci_lock_release(&map->lock);
+        return VSC_ERROR(ENOMEM);
+    }
+
+    if(value != NULL)
+        *value = bkt->value;
+
+    publish_locked(map, snap);
+
+    vsci_lock_release(&map->lock);
+    return 0;
+}
+
+void vsc_rcu_hashmap_clear(VscRcuHashMap *map)
+{
+    validate(map);
+
+    vsci_lock_acquire(&map->lock);
+    if(map->current != NULL)
+        publish_locked(map, NULL);
+    vsci_lock_release(&map->lock);
+}
+
+size_t vsc_rcu_hashmap_size(VscRcuHashMap *map)
+{
+    size_t size;
+
+    validate(map);
+
+    vsci_lock_acquire(&map->lock);
+    size = map->current != NULL ? map->current->size : 0;
+    vsci_lock_release(&map->lock);
+
+    return size;
+}
+
+void vsc_rcu_hashmap_reclaim(VscRcuHashMap *map)
+{
+    validate(map);
+
+    vsci_lock_acquire(&map->lock);
+    reclaim_locked(map);
+    vsci_lock_release(&map->lock);
+}
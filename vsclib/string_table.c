@@ -0,0 +1,482 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stddef.h>
+#include <string.h>
+#include <vsclib/assert.h>
+#include <vsclib/error.h>
+#include <vsclib/mem.h>
+#include <vsclib/macros.h>
+#include <vsclib/hash.h>
+#include <vsclib/hashmap.h>
+#include <vsclib/string_table.h>
+#include "hashmap_internal.h"
+#include "lock_internal.h"
+
+/* The minimum arena chunk size. Bigger strings get a chunk to themselves. */
+#define VSC_STRING_TABLE_CHUNK_SIZE 65536
+
+#define VSC_STRING_TABLE_MIN_ATOMS 64
+
+/* Same as VSC_HASHMAP_BATCH_SIZE. */
+#define VSC_STRING_TABLE_BATCH_SIZE 16
+
+typedef struct StringKey {
+    const char *data;
+    size_t      length;
+} StringKey;
+
+/*
+ * An interned string. `key` points at `data`, and is what's used as the map key,
+ * so lookups can pass a StringKey over the caller's buffer without copying it.
+ */
+typedef struct VscStringTableEntry {
+    StringKey key;
+    uint32_t  atom;
+    char      data[];
+} VscStringTableEntry;
+
+typedef struct VscStringTableChunk {
+    struct VscStringTableChunk *next;
+    size_t                      used;
+    size_t                      size;
+} VscStringTableChunk;
+
+struct VscStringTable {
+    /* Maps StringKey to VscStringTableEntry. */
+    VscHashMap map;
+
+    VscStringTableEntry **atoms;
+    uint32_t              num_atoms;
+    uint32_t              atom_capacity;
+
+    /* Newest first. */
+    VscStringTableChunk *chunks;
+
+    uint32_t            flags;
+    VscLock             lock;
+    const VscAllocator *allocator;
+};
+
+static inline void validate(const VscStringTable *st)
+{
+    (void)st;
+    vsc_assert(st != NULL);
+    vsc_assert(st->allocator != NULL);
+}
+
+static vsc_hash_t key_hash(const void *k, uint64_t seed)
+{
+    const StringKey *key = k;
+    return vsc_hash_seeded(key->data, key->length, seed);
+}
+
+static int key_compare(const void *a, const void *b)
+{
+    const StringKey *ka = a, *kb = b;
+
+    if(ka->length != kb->length)
+        return 0;
+
+    return ka->length == 0 || memcmp(ka->data, kb->data, ka->length) == 0;
+}
+
+static inline void lock(VscStringTable *st)
+{
+    if(st->flags & VSC_STRING_TABLE_CONCURRENT)
+        vsci_lock_acquire(&st->lock);
+}
+
+static inline void unlock(VscStringTable *st)
+{
+    if(st->flags & VSC_STRING_TABLE_CONCURRENT)
+        vsci_lock_release(&st->lock);
+}
+
+static inline const VscStringTableEntry *get_entry(const char *str)
+{
+    return (const VscStringTableEntry *)(str - offsetof(VscStringTableEntry, data));
+}
+
+static inline size_t entry_size(size_t len)
+{
+    const size_t align = VSC_ALIGNOF(VscStringTableEntry);
+    size_t       size  = offsetof(VscStringTableEntry, data) + len + 1;
+
+    return (size + align - 1) & ~(align - 1);
+}
+
+static inline int make_key(StringKey *key, const char *s, size_t len)
+{
+    if(s == NULL && len != 0)
+        return VSC_ERROR(EINVAL);
+
+    /* Leave room for the NUL, and for entry_size() not to overflow. */
+    if(len >= UINT32_MAX)
+        return VSC_ERROR(ERANGE);
+
+    key->data   = s;
+    key->length = len;
+    return 0;
+}
+
+/*
+ * Make sure the newest chunk has at least `size` bytes free.
+ * Whatever was left in the previous one is wasted.
+ */
+static int arena_reserve(VscStringTable *st, size_t size)
+{
+    VscStringTableChunk *c = st->chunks;
+    size_t               n;
+
+    if(c != NULL && c->size - c->used >= size)
+        return 0;
+
+    n = VSC_MAX(size, VSC_STRING_TABLE_CHUNK_SIZE);
+    if(n > SIZE_MAX - sizeof(VscStringTableChunk))
+        return VSC_ERROR(ERANGE);
+
+    if((c = vsc_xalloc(st->allocator, sizeof(VscStringTableChunk) + n)) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    c->next    = st->chunks;
+    c->used    = 0;
+    c->size    = n;
+    st->chunks = c;
+    return 0;
+}
+
+static int reserve_atoms(VscStringTable *st, size_t n)
+{
+    VscStringTableEntry **atoms;
+    size_t                cap;
+
+    if(n <= st->atom_capacity)
+        return 0;
+
+    if(n >= VSC_STRING_TABLE_INVALID_ATOM)
+        return VSC_ERROR(ERANGE);
+
+    cap = VSC_MAX(VSC_MAX((size_t)st->atom_capacity * 2, n), VSC_STRING_TABLE_MIN_ATOMS);
+    cap = VSC_MIN(cap, (size_t)VSC_STRING_TABLE_INVALID_ATOM);
+
+    if((atoms = vsc_xrealloc(st->allocator, st->atoms, cap * sizeof(VscStringTableEntry *))) == NULL)
+        return VSC_ERROR(ENOMEM);
+
+    st->atoms         = atoms;
+    st->atom_capacity = (uint32_t)cap;
+    return 0;
+}
+
+/* Must be called with the lock held. */
+static VscStringTableEntry *find_locked(const VscStringTable *st, const StringKey *key, vsc_hash_t hash)
+{
+    return vsc_hashmap_find_with_hash(&st->map, key, hash);
+}
+
+/* Must be called with the lock held. The key must not already be interned. */
+static int insert_locked(VscStringTable *st, const StringKey *key, vsc_hash_t hash, VscStringTableEntry **out)
+{
+    VscStringTableEntry *e;
+    VscStringTableChunk *c;
+    size_t               size = entry_size(key->length);
+    int                  r;
+
+    if((r = reserve_atoms(st, (size_t)st->num_atoms + 1)) < 0)
+        return r;
+
+    if((r = arena_reserve(st, size)) < 0)
+        return r;
+
+    c = st->chunks;
+    e = (VscStringTableEntry *)((char *)(c + 1) + c->used);
+
+    if(key->length > 0)
+        memcpy(e->data, key->data, key->length);
+    e->data[key->length] = '\0';
+    e->key.data          = e->data;
+    e->key.length        = key->length;
+    e->atom              = st->num_atoms;
+
+    if((r = vsc_hashmap_insert_with_hash(&st->map, &e->key, hash, e)) < 0)
+        return r;
+
+    /* Only commit once nothing else can fail. */
+    c->used += size;
+    st->atoms[st->num_atoms++] = e;
+
+    *out = e;
+    return 0;
+}
+
+static void return_entry(const VscStringTableEntry *e, const char **str, uint32_t *atom)
+{
+    if(str != NULL)
+        *str = e->data;
+
+    if(atom != NULL)
+        *atom = e->atom;
+}
+
+VscStringTable *vsc_string_table_alloca(uint32_t flags, const VscAllocator *a)
+{
+    VscStringTable *st;
+
+    vsc_assert(a != NULL);
+
+    if((st = vsc_xalloc(a, sizeof(VscStringTable))) == NULL)
+        return NULL;
+
+    *st = (VscStringTable){
+        .atoms         = NULL,
+        .num_atoms     = 0,
+        .atom_capacity = 0,
+        .chunks        = NULL,
+        .flags         = flags,
+        .lock          = VSC_LOCK_INIT,
+        .allocator     = a,
+    };
+
+    vsci_hashmap_init(&st->map, NULL, key_compare, VSC_HASHMAP_LAYOUT_BUCKETS, a);
+    vsci_hashmap_init_seeded(&st->map, key_hash);
+
+    return st;
+}
+
+VscStringTable *vsc_string_table_alloc(uint32_t flags)
+{
+    return vsc_string_table_alloca(flags, vsclib_system_allocator);
+}
+
+void vsc_string_table_free(VscStringTable *st)
+{
+    VscStringTableChunk *c, *next;
+
+    if(st == NULL)
+        return;
+
+    validate(st);
+
+    /* Newest first, to be nice to linear allocators. */
+    for(c = st->chunks; c != NULL; c = next) {
+        next = c->next;
+        vsc_xfree(st->allocator, c);
+    }
+
+    vsc_xfree(st->allocator, st->atoms);
+    vsc_hashmap_reset(&st->map);
+    vsc_xfree(st->allocator, st);
+}
+
+int vsc_string_table_intern(VscStringTable *st, const char *s, size_t len, const char **str, uint32_t *atom)
+{
+    VscStringTableEntry *e;
+    StringKey            key;
+    vsc_hash_t           hash;
+    int                  r;
+
+    validate(st);
+
+    if((r = make_key(&key, s, len)) < 0)
+        return r;
+
+    /* The seed never changes, so this is safe without the lock. */
+    hash = vsc_hashmap_hash(&st->map, &key);
+
+    lock(st);
+    if((e = find_locked(st, &key, hash)) == NULL)
+        r = insert_locked(st, &key, hash, &e);
+    unlock(st);
+
+    if(r < 0)
+        return r;
+
+    return_entry(e, str, atom);
+    return 0;
+}
+
+int vsc_string_table_intern_cstr(VscStringTable *st, const char *s, const char **str, uint32_t *atom)
+{
+    if(s == NULL)
+        return VSC_ERROR(EINVAL);
+
+    return vsc_string_table_intern(st, s, strlen(s), str, atom);
+}
+
+/* Must be called with the lock held. */
+static int intern_batch_locked(VscStringTable *st, const StringKey *keys, const vsc_hash_t *hashes, size_t n,
+                               const char **strs, uint32_t *atoms)
+{
+    const void *kptrs[VSC_STRING_TABLE_BATCH_SIZE];
+    void       *found[VSC_STRING_TABLE_BATCH_SIZE];
+    size_t      misses = 0, bytes = 0;
+    int         r;
+
+    vsc_assert(n <= VSC_STRING_TABLE_BATCH_SIZE);
+
+    for(size_t i = 0; i < n; ++i)
+        kptrs[i] = keys + i;
+
+    (void)vsc_hashmap_find_batch_with_hash(&st->map, kptrs, hashes, n, found);
+
+    for(size_t i = 0; i < n; ++i) {
+        if(found[i] != NULL)
+            continue;
+
+        ++misses;
+        bytes += entry_size(keys[i].length);
+    }
+
+    /* Grow everything once for the whole batch. Duplicates within it may over-reserve a little. */
+    if(misses > 0) {
+        if((r = reserve_atoms(st, (size_t)st->num_atoms + misses)) < 0)
+            return r;
+
+        if((r = vsci_hashmap_reserve(&st->map, vsc_hashmap_size(&st->map) + misses)) < 0)
+            return r;
+
+        if((r = arena_reserve(st, bytes)) < 0)
+            return r;
+    }
+
+    for(size_t i = 0; i < n; ++i) {
+        VscStringTableEntry *e = found[i];
+
+        /* Check again, it may have been a duplicate of an earlier miss. */
+        if(e == NULL && (e = find_locked(st, keys + i, hashes[i])) == NULL) {
+            if((r = insert_locked(st, keys + i, hashes[i], &e)) < 0)
+                return r;
+        }
+
+        return_entry(e, strs != NULL ? strs + i : NULL, atoms != NULL ? atoms + i : NULL);
+    }
+
+    return 0;
+}
+
+int vsc_string_table_intern_bulk(VscStringTable *st, const char *const *s, const size_t *lens, size_t n,
+                                 const char **strs, uint32_t *atoms)
+{
+    StringKey  keys[VSC_STRING_TABLE_BATCH_SIZE];
+    vsc_hash_t hashes[VSC_STRING_TABLE_BATCH_SIZE];
+    int        r = 0;
+
+    validate(st);
+
+    lock(st);
+
+    for(size_t i = 0; i < n; i += VSC_STRING_TABLE_BATCH_SIZE) {
+        size_t count = VSC_MIN(n - i, VSC_STRING_TABLE_BATCH_SIZE);
+
+        for(size_t j = 0; j < count; ++j) {
+            const char *str = s[i + j];
+
+            if(lens == NULL && str == NULL) {
+                r = VSC_ERROR(EINVAL);
+                goto done;
+            }
+
+            if((r = make_key(keys + j, str, lens != NULL ? lens[i + j] : strlen(str))) < 0)
+                goto done;
+
+            hashes[j] = vsc_hashmap_hash(&st->map, keys + j);
+        }
+
+        r = intern_batch_locked(st, keys, hashes, count, strs != NULL ? strs + i : NULL,
+                                atoms != NULL ? atoms + i : NULL);
+        if(r < 0)
+            goto done;
+    }
+
+done:
+    unlock(st);
+    return r;
+}
+
+const char *vsc_string_table_find(VscStringTable *st, const char *s, size_t len, uint32_t *atom)
+{
+    const VscStringTableEntry *e;
+    StringKey                  key;
+    vsc_hash_t                 hash;
+
+    validate(st);
+
+    if(make_key(&key, s, len) < 0)
+        return NULL;
+
+    hash = vsc_hashmap_hash(&st->map, &key);
+
+    lock(st);
+    e = find_locked(st, &key, hash);
+    unlock(st);
+
+    if(e == NULL)
+        return NULL;
+
+    if(atom != NULL)
+        *atom = e->atom;
+
+    return e->data;
+}
+
+const char *vsc_string_table_string(VscStringTable *st, uint32_t atom, size_t *len)
+{
+    const VscStringTableEntry *e = NULL;
+
+    validate(st);
+
+    /* The atom array may be reallocated by a concurrent insertion. */
+    lock(st);
+    if(atom < st->num_atoms)
+        e = st->atoms[atom];
+    unlock(st);
+
+    if(e == NULL)
+        return NULL;
+
+    if(len != NULL)
+        *len = e->key.length;
+
+    return e->data;
+}
+
+uint32_t vsc_string_table_atom(const char *str)
+{
+    vsc_assert(str != NULL);
+    return get_entry(str)->atom;
+}
+
+size_t vsc_string_table_length(const char *str)
+{
+    vsc_assert(str != NULL);
+    return get_entry(str)->key.length;
+}
+
+size_t vsc_string_table_size(VscStringTable *st)
+{
+    size_t size;
+
+    validate(st);
+
+    lock(st);
+    size = st->num_atoms;
+    unlock(st);
+
+    return size;
+}
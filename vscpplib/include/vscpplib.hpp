@@ -28,6 +28,7 @@
 #include <memory>
 
 #include <vsclib.h>
+#include "vscpplib/hash_map.hpp"
 
 namespace vsc
 {
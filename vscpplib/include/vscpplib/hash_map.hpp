@@ -0,0 +1,449 @@
+/*
+ * vsclib
+ * https://{github.com,codeberg.org}/vs49688/vsclib
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2026 Zane van Iperen (zane@zanevaniperen.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _VSCPPLIB_HASH_MAP_HPP
+#define _VSCPPLIB_HASH_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <vsclib.h>
+
+namespace vsc
+{
+
+/*
+ * Default hash functor. Strings go through vsc_hash() (XXH3 on 64-bit),
+ * integers and enums are mixed with vsc_hashmap_mix64().
+ */
+template <typename K, typename = void>
+struct hash;
+
+template <typename K>
+struct hash<K, std::enable_if_t<std::is_integral_v<K> || std::is_enum_v<K>>> {
+    vsc_hash_t operator()(K key) const noexcept
+    {
+        return vsc_hashmap_mix64(static_cast<uint64_t>(key));
+    }
+};
+
+template <typename T>
+struct hash<T *> {
+    vsc_hash_t operator()(const T *key) const noexcept
+    {
+        return vsc_hashmap_mix64(reinterpret_cast<uintptr_t>(key));
+    }
+};
+
+/* Transparent, so a std::string-keyed map can be queried with a std::string_view or C string. */
+struct string_hash {
+    using is_transparent = void;
+
+    vsc_hash_t operator()(std::string_view s) const noexcept
+    {
+        return vsc_hash(s.data(), s.size());
+    }
+};
+
+template <>
+struct hash<std::string> : string_hash {
+};
+
+template <>
+struct hash<std::string_view> : string_hash {
+};
+
+/**
+ * @brief An open-addressing hash map storing keys and values inline.
+ *
+ * Uses the same scheme as #VscHashMap: linear probing with #VSC_INVALID_HASH marking
+ * an empty bucket, and backward-shift deletion. The bucket count is always a power-of-two.
+ *
+ * As with the C API, errors are returned, not thrown. Pointers returned by find() are
+ * invalidated by insert() and erase().
+ *
+ * If both Hash and Eq define `is_transparent`, lookups accept any type they can handle,
+ * e.g. a `std::string_view` for a `std::string` key.
+ */
+template <typename K, typename V, typename Hash = vsc::hash<K>, typename Eq = std::equal_to<>>
+class hash_map
+{
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using hasher      = Hash;
+    using key_equal   = Eq;
+    using size_type   = size_t;
+
+    static constexpr size_type min_buckets = 16;
+
+    /* Rehashing and backward-shift deletion relocate elements, with no way to undo a half-done move. */
+    static_assert(std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>,
+                  "keys and values must be nothrow move-constructible");
+
+private:
+    struct slot {
+        vsc_hash_t hash;
+        union {
+            K key;
+        };
+        union {
+            V value;
+        };
+
+        slot() noexcept : hash(VSC_INVALID_HASH) {}
+        ~slot() {}
+    };
+
+    template <typename Q, typename H, typename E>
+    using enable_transparent = std::enable_if_t<!std::is_same_v<std::decay_t<Q>, K>,
+                                                std::void_t<typename H::is_transparent, typename E::is_transparent>>;
+
+public:
+    explicit hash_map(const VscAllocator *a = vsclib_system_allocator, Hash hash = Hash(), Eq eq = Eq()) noexcept
+        : size_(0), num_buckets_(0), slots_(nullptr), allocator_(a), hash_(std::move(hash)), eq_(std::move(eq))
+    {
+    }
+
+    hash_map(const hash_map&)            = delete;
+    hash_map& operator=(const hash_map&) = delete;
+
+    hash_map(hash_map&& other) noexcept
+        : size_(other.size_), num_buckets_(other.num_buckets_), slots_(other.slots_), allocator_(other.allocator_),
+          hash_(std::move(other.hash_)), eq_(std::move(other.eq_))
+    {
+        other.size_        = 0;
+        other.num_buckets_ = 0;
+        other.slots_       = nullptr;
+    }
+
+    hash_map& operator=(hash_map&& other) noexcept
+    {
+        if(this == &other)
+            return *this;
+
+        reset();
+        size_        = std::exchange(other.size_, 0);
+        num_buckets_ = std::exchange(other.num_buckets_, 0);
+        slots_       = std::exchange(other.slots_, nullptr);
+        allocator_   = other.allocator_;
+        hash_        = std::move(other.hash_);
+        eq_          = std::move(other.eq_);
+        return *this;
+    }
+
+    ~hash_map()
+    {
+        reset();
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type bucket_count() const noexcept
+    {
+        return num_buckets_;
+    }
+
+    /* Remove all elements, keeping the buckets. */
+    void clear() noexcept
+    {
+        for(size_type i = 0; i < num_buckets_; ++i)
+            destroy(slots_[i]);
+        size_ = 0;
+    }
+
+    /* Remove all elements and release the buckets. */
+    void reset() noexcept
+    {
+        clear();
+        free_slots(slots_, num_buckets_);
+        slots_       = nullptr;
+        num_buckets_ = 0;
+    }
+
+    /* Make room for n elements without rehashing. Returns 0 or a negative error value. */
+    int reserve(size_type n) noexcept
+    {
+        size_type num_buckets = min_buckets;
+
+        while(num_buckets - num_buckets / 4 < n) {
+            if(num_buckets > SIZE_MAX / 2 / sizeof(slot))
+                return VSC_ERROR(ERANGE);
+            num_buckets *= 2;
+        }
+
+        if(num_buckets <= num_buckets_)
+            return 0;
+
+        return rehash(num_buckets);
+    }
+
+    /* Insert a key, or replace its value if it exists. Returns 0 or a negative error value. */
+    template <typename KK, typename VV>
+    int insert(KK&& key, VV&& value)
+    {
+        vsc_hash_t hash = hash_key(key);
+        size_type  i    = lookup(key, hash);
+        int        r;
+
+        if(i < num_buckets_) {
+            slots_[i].value = std::forward<VV>(value);
+            return 0;
+        }
+
+        if(size_ + 1 > num_buckets_ - num_buckets_ / 4) {
+            if((r = reserve(size_ + 1)) < 0)
+                return r;
+        }
+
+        slot& s = free_slot(slots_, num_buckets_, hash);
+        construct(s, hash, std::forward<KK>(key), std::forward<VV>(value));
+        ++size_;
+        return 0;
+    }
+
+    V *find(const K& key) noexcept
+    {
+        return find_impl(key);
+    }
+
+    const V *find(const K& key) const noexcept
+    {
+        return const_cast<hash_map *>(this)->find_impl(key);
+    }
+
+    template <typename Q, typename H = Hash, typename E = Eq, typename = enable_transparent<Q, H, E>>
+    V *find(const Q& key) noexcept
+    {
+        return find_impl(key);
+    }
+
+    template <typename Q, typename H = Hash, typename E = Eq, typename = enable_transparent<Q, H, E>>
+    const V *find(const Q& key) const noexcept
+    {
+        return const_cast<hash_map *>(this)->find_impl(key);
+    }
+
+    bool contains(const K& key) const noexcept
+    {
+        return find(key) != nullptr;
+    }
+
+    template <typename Q, typename H = Hash, typename E = Eq, typename = enable_transparent<Q, H, E>>
+    bool contains(const Q& key) const noexcept
+    {
+        return find(key) != nullptr;
+    }
+
+    /* Returns true if the key was removed. */
+    bool erase(const K& key) noexcept
+    {
+        return erase_impl(key);
+    }
+
+    template <typename Q, typename H = Hash, typename E = Eq, typename = enable_transparent<Q, H, E>>
+    bool erase(const Q& key) noexcept
+    {
+        return erase_impl(key);
+    }
+
+    /* Invoke proc(const K&, V&) on each element. Stops early if proc returns false. */
+    template <typename F>
+    bool for_each(F&& proc)
+    {
+        for(size_type i = 0; i < num_buckets_; ++i) {
+            slot& s = slots_[i];
+
+            if(s.hash == VSC_INVALID_HASH)
+                continue;
+
+            if constexpr(std::is_same_v<std::invoke_result_t<F, const K&, V&>, void>)
+                proc(static_cast<const K&>(s.key), s.value);
+            else if(!proc(static_cast<const K&>(s.key), s.value))
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+    template <typename Q>
+    vsc_hash_t hash_key(const Q& key) const noexcept
+    {
+        vsc_hash_t h = hash_(key);
+        return h == VSC_INVALID_HASH ? h - 1 : h;
+    }
+
+    /* Returns the index of the key, or num_buckets_ if not found. */
+    template <typename Q>
+    size_type lookup(const Q& key, vsc_hash_t hash) const noexcept
+    {
+        size_type mask;
+
+        if(num_buckets_ == 0)
+            return 0;
+
+        mask = num_buckets_ - 1;
+        for(size_type i = hash & mask;; i = (i + 1) & mask) {
+            const slot& s = slots_[i];
+
+            if(s.hash == VSC_INVALID_HASH)
+                return num_buckets_;
+
+            if(s.hash == hash && eq_(s.key, key))
+                return i;
+        }
+    }
+
+    template <typename Q>
+    V *find_impl(const Q& key) noexcept
+    {
+        size_type i = lookup(key, hash_key(key));
+        return i < num_buckets_ ? &slots_[i].value : nullptr;
+    }
+
+    template <typename Q>
+    bool erase_impl(const Q& key) noexcept
+    {
+        size_type i = lookup(key, hash_key(key)), mask;
+
+        if(i >= num_buckets_)
+            return false;
+
+        destroy(slots_[i]);
+
+        /* Backward-shift deletion, no tombstones. */
+        mask = num_buckets_ - 1;
+        for(size_type j = (i + 1) & mask; slots_[j].hash != VSC_INVALID_HASH; j = (j + 1) & mask) {
+            size_type home = slots_[j].hash & mask;
+
+            /* Leave it if its home is cyclically within (i, j]. */
+            if(i <= j ? (i < home && home <= j) : (i < home || home <= j))
+                continue;
+
+            construct(slots_[i], slots_[j].hash, std::move(slots_[j].key), std::move(slots_[j].value));
+            destroy(slots_[j]);
+            i = j;
+        }
+
+        --size_;
+        return true;
+    }
+
+    template <typename KK, typename VV>
+    static void construct(slot& s, vsc_hash_t hash, KK&& key, VV&& value)
+    {
+        ::new(static_cast<void *>(&s.key)) K(std::forward<KK>(key));
+
+        /* The slot isn't marked occupied yet, so destroy() won't clean up the key. */
+        try {
+            ::new(static_cast<void *>(&s.value)) V(std::forward<VV>(value));
+        } catch(...) {
+            s.key.~K();
+            throw;
+        }
+
+        s.hash = hash;
+    }
+
+    static void destroy(slot& s) noexcept
+    {
+        if(s.hash == VSC_INVALID_HASH)
+            return;
+
+        s.key.~K();
+        s.value.~V();
+        s.hash = VSC_INVALID_HASH;
+    }
+
+    static slot& free_slot(slot *slots, size_type num_buckets, vsc_hash_t hash) noexcept
+    {
+        size_type mask = num_buckets - 1, i;
+
+        for(i = hash & mask; slots[i].hash != VSC_INVALID_HASH; i = (i + 1) & mask)
+            ;
+
+        return slots[i];
+    }
+
+    void free_slots(slot *slots, size_type n) noexcept
+    {
+        if(slots == nullptr)
+            return;
+
+        for(size_type i = 0; i < n; ++i)
+            slots[i].~slot();
+
+        vsc_xfree(allocator_, slots);
+    }
+
+    int rehash(size_type num_buckets) noexcept
+    {
+        void *p = nullptr;
+        slot *slots;
+        int   r;
+
+        if((r = vsc_xalloc_ex(allocator_, &p, num_buckets * sizeof(slot), 0, alignof(slot))) < 0)
+            return r;
+
+        slots = static_cast<slot *>(p);
+        for(size_type i = 0; i < num_buckets; ++i)
+            ::new(static_cast<void *>(slots + i)) slot();
+
+        for(size_type i = 0; i < num_buckets_; ++i) {
+            slot& s = slots_[i];
+
+            if(s.hash == VSC_INVALID_HASH)
+                continue;
+
+            construct(free_slot(slots, num_buckets, s.hash), s.hash, std::move(s.key), std::move(s.value));
+            destroy(s);
+        }
+
+        free_slots(slots_, num_buckets_);
+        slots_       = slots;
+        num_buckets_ = num_buckets;
+        return 0;
+    }
+
+    size_type           size_;
+    size_type           num_buckets_;
+    slot               *slots_;
+    const VscAllocator *allocator_;
+    Hash                hash_;
+    Eq                  eq_;
+};
+
+} // namespace vsc
+
+#endif /* _VSCPPLIB_HASH_MAP_HPP */